@@ -221,6 +221,70 @@ AC_DEFUN([X11_EXT_SHAPE],
 ])
 
 
+# X11_EXT_SHM()
+#
+# Check for the presence of the "MIT-SHM" X Window System extension.
+# Defines "XSHM", sets the $(XSHM) variable to "yes", and sets the $(LIBS)
+# appropriately if the extension is present.
+AC_DEFUN([X11_EXT_SHM],
+[
+  AC_REQUIRE([X11_DEVEL])
+
+  AC_ARG_ENABLE([xshm],
+  AC_HELP_STRING(
+  [--disable-xshm],
+  [build without support for the MIT-SHM extension [default=enabled]]),
+  [USE=$enableval], [USE="yes"])
+
+  if test "$USE" = "yes"; then
+    # Store these
+    OLDLIBS=$LIBS
+    OLDCPPFLAGS=$CPPFLAGS
+
+    CPPFLAGS="$CPPFLAGS $X_CFLAGS"
+    LIBS="$LIBS $X_LIBS"
+
+    AC_CHECK_LIB([Xext], [XShmAttach],
+      AC_MSG_CHECKING([for X11/extensions/XShm.h])
+      AC_TRY_LINK(
+      [
+        #include <X11/Xlib.h>
+        #include <X11/Xutil.h>
+        #include <sys/ipc.h>
+        #include <sys/shm.h>
+        #include <X11/extensions/XShm.h>
+      ],
+      [
+        XShmSegmentInfo foo;
+      ],
+      [
+        AC_MSG_RESULT([yes])
+        XSHM="yes"
+        AC_DEFINE([XSHM], [1], [Found the MIT-SHM extension])
+
+        XSHM_CFLAGS=""
+        XSHM_LIBS="-lXext"
+        AC_SUBST(XSHM_CFLAGS)
+        AC_SUBST(XSHM_LIBS)
+      ],
+      [
+        AC_MSG_RESULT([no])
+        XSHM="no"
+      ])
+    )
+
+    LIBS=$OLDLIBS
+    CPPFLAGS=$OLDCPPFLAGS
+  fi
+
+  AC_MSG_CHECKING([for the MIT-SHM extension])
+  if test "$XSHM" = "yes"; then
+    AC_MSG_RESULT([yes])
+  else
+    AC_MSG_RESULT([no])
+  fi
+])
+
 # X11_EXT_XINERAMA()
 #
 # Check for the presence of the "Xinerama" X Window System extension.
@@ -122,6 +122,14 @@ void RrColorFree(RrColor *c)
     }
 }
 
+gboolean RrDefaultFormat(const RrInstance *inst, const XImage *im)
+{
+    return (im->bits_per_pixel == 32 &&
+            RrRedOffset(inst) == RrDefaultRedOffset &&
+            RrGreenOffset(inst) == RrDefaultGreenOffset &&
+            RrBlueOffset(inst) == RrDefaultBlueOffset);
+}
+
 void RrReduceDepth(const RrInstance *inst, RrPixel32 *data, XImage *im)
 {
     gint r, g, b;
@@ -137,9 +145,7 @@ void RrReduceDepth(const RrInstance *inst, RrPixel32 *data, XImage *im)
     RrPixel8  *p8  = (RrPixel8 *)  im->data;
     switch (im->bits_per_pixel) {
     case 32:
-        if ((ro != RrDefaultRedOffset) ||
-            (bo != RrDefaultBlueOffset) ||
-            (go != RrDefaultGreenOffset)) {
+        if (!RrDefaultFormat(inst, im)) {
             for (y = 0; y < im->height; y++) {
                 for (x = 0; x < im->width; x++) {
                     r = (data[x] >> RrDefaultRedOffset) & 0xFF;
@@ -150,6 +156,16 @@ void RrReduceDepth(const RrInstance *inst, RrPixel32 *data, XImage *im)
                 data += im->width;
                 p32 += im->width;
             }
+        } else if (im->data) {
+            /* same format, just copy it into the image */
+            if (im->bytes_per_line == im->width * 4)
+                memcpy(im->data, data, im->width * im->height * 4);
+            else
+                for (y = 0; y < im->height; y++) {
+                    memcpy(p32, data, im->width * 4);
+                    data += im->width;
+                    p32 += im->bytes_per_line/4;
+                }
         } else im->data = (gchar*) data;
         break;
     case 24:
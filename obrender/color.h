@@ -45,7 +45,12 @@ struct _RrColor {
 
 void RrColorAllocateGC(RrColor *in);
 XColor *RrPickColor(const RrInstance *inst, gint r, gint g, gint b);
+/*! Converts @data into the X server's format, into the buffer at im->data.
+  If the formats are the same and im->data is NULL, im->data is pointed at
+  @data instead */
 void RrReduceDepth(const RrInstance *inst, RrPixel32 *data, XImage *im);
+/*! Returns TRUE if the image uses the same format as RrPixel32 data */
+gboolean RrDefaultFormat(const RrInstance *inst, const XImage *im);
 void RrIncreaseDepth(const RrInstance *inst, RrPixel32 *data, XImage *im);
 
 #endif /* __color_h */
@@ -24,6 +24,7 @@
 #include "theme.h"
 #include "geom.h"
 #include "instance.h"
+#include "paintcache.h"
 #include "gettext.h"
 
 #include <glib.h>
@@ -131,6 +132,8 @@ void RrFontClose(RrFont *f)
 {
     if (f) {
         if (--f->ref < 1) {
+            /* a new font could be opened at the same address */
+            RrPaintCacheClear(RrInstancePaintCache(f->inst));
             g_object_unref(f->layout);
             pango_font_description_free(f->font_desc);
             g_slice_free(RrFont, f);
@@ -215,32 +218,20 @@ static inline int font_calculate_baseline(RrFont *f, gint height)
         / PANGO_SCALE; /* back to pixels */
 }
 
-void RrFontDraw(XftDraw *d, RrTextureText *t, RrRect *area)
+/*! Sets up the font's layout to draw the text in an area of the given width
+  @return The width which the text is fit into
+*/
+static gint font_layout(RrTextureText *t, gint width)
 {
-    gint x,y,w;
-    XftColor c;
-    gint mw;
-    PangoRectangle rect;
-    PangoAttrList *attrlist;
+    gint w;
     PangoEllipsizeMode ell;
 
     g_assert(!t->flow || t->maxwidth > 0);
 
-    y = area->y;
-    if (!t->flow)
-        /* center the text vertically
-           We do this centering based on the 'baseline' since different fonts
-           have different top edges. It looks bad when the whole string is
-           moved when 1 character from a non-default language is included in
-           the string */
-        y += font_calculate_baseline(t->font, area->height);
-
-    /* the +2 and -4 leave a small blank edge on the sides */
-    x = area->x + 2;
-    w = area->width;
+    /* the -4 leaves a small blank edge on the sides */
+    w = width;
     if (t->flow) w = MAX(w, t->maxwidth);
     w -= 4;
-    /* h = area->height; */
 
     if (t->flow)
         ell = PANGO_ELLIPSIZE_NONE;
@@ -267,8 +258,29 @@ void RrFontDraw(XftDraw *d, RrTextureText *t, RrRect *area)
     pango_layout_set_width(t->font->layout, w * PANGO_SCALE);
     pango_layout_set_ellipsize(t->font->layout, ell);
     pango_layout_set_single_paragraph_mode(t->font->layout, !t->flow);
+    return w;
+}
+
+void RrFontDraw(XftDraw *d, RrTextureText *t, RrRect *area)
+{
+    gint x,y,w;
+    XftColor c;
+    gint mw;
+    PangoRectangle rect;
+    PangoAttrList *attrlist;
+
+    y = area->y;
+    if (!t->flow)
+        /* center the text vertically
+           We do this centering based on the 'baseline' since different fonts
+           have different top edges. It looks bad when the whole string is
+           moved when 1 character from a non-default language is included in
+           the string */
+        y += font_calculate_baseline(t->font, area->height);
 
-    /* * * end of setting up the layout * * */
+    /* the +2 leaves a small blank edge on the left */
+    x = area->x + 2;
+    w = font_layout(t, area->width);
 
     pango_layout_get_pixel_extents(t->font->layout, NULL, &rect);
     mw = rect.width;
@@ -380,3 +392,37 @@ void RrFontDraw(XftDraw *d, RrTextureText *t, RrRect *area)
         pango_attr_list_unref(attrlist);
     }
 }
+
+void RrFontLook(GString *look, RrTextureText *t, RrRect *area)
+{
+    PangoLayoutIter *it;
+
+    font_layout(t, area->width);
+
+    /* the glyphs, and the fonts they come from, are everything that is drawn
+       for the text.  when the text doesn't fit, the ellipsis is a glyph in
+       place of the ones that were cut out */
+    it = pango_layout_get_iter(t->font->layout);
+    do {
+        PangoLayoutRun *run = pango_layout_iter_get_run(it);
+
+        if (run) {
+            gint i;
+
+            g_string_append_len(look, (gchar*)&run->item->analysis.font,
+                                sizeof(run->item->analysis.font));
+            for (i = 0; i < run->glyphs->num_glyphs; ++i) {
+                const PangoGlyphInfo *g = &run->glyphs->glyphs[i];
+
+                g_string_append_len(look, (gchar*)&g->glyph,
+                                    sizeof(g->glyph));
+                g_string_append_len(look, (gchar*)&g->geometry,
+                                    sizeof(g->geometry));
+            }
+        }
+        else
+            /* the end of a line */
+            g_string_append_c(look, '\n');
+    } while (pango_layout_iter_next_run(it));
+    pango_layout_iter_free(it);
+}
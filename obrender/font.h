@@ -34,6 +34,9 @@ struct _RrFont {
 };
 
 void RrFontDraw(XftDraw *d, RrTextureText *t, RrRect *position);
+/*! Appends what RrFontDraw would draw for the text in the area to the look,
+  see RrTextLook */
+void RrFontLook(GString *look, RrTextureText *t, RrRect *position);
 
 /*! Increment the references for this font, RrFontClose will decrement until 0
   and then really close it */
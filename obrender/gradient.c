@@ -21,6 +21,7 @@
 #include "render.h"
 #include "gradient.h"
 #include "color.h"
+#include "simd.h"
 #include <glib.h>
 #include <string.h>
 
@@ -35,6 +36,22 @@ static void gradient_mirrorhorizontal(RrSurface *sf, gint w, gint h);
 static void gradient_diagonal(RrSurface *sf, gint w, gint h);
 static void gradient_crossdiagonal(RrSurface *sf, gint w, gint h);
 static void gradient_pyramid(RrSurface *sf, gint inw, gint inh);
+static void gradient_row_plain(RrPixel32 *data, gint len,
+                               const RrColor *from, const RrColor *to);
+static inline void repeat_pixel(RrPixel32 *start, gint w);
+
+/*! Fills in a row of a gradient, with the fastest kernel available */
+static RrGradientRowFunc gradient_row = NULL;
+
+gboolean RrGradientSimd(gboolean enable)
+{
+    RrGradientRowFunc row = gradient_row_plain;
+    gboolean ok;
+
+    ok = RrSimdGradientRow(&row);
+    gradient_row = enable ? row : gradient_row_plain;
+    return ok;
+}
 
 void RrRender(RrAppearance *a, gint w, gint h)
 {
@@ -43,6 +60,9 @@ void RrRender(RrAppearance *a, gint w, gint h)
     guint r,g,b;
     register gint off, x;
 
+    if (!gradient_row)
+        RrGradientSimd(TRUE);
+
     switch (a->surface.grad) {
     case RR_SURFACE_PARENTREL:
         gradient_parentrelative(a, w, h);
@@ -87,9 +107,10 @@ void RrRender(RrAppearance *a, gint w, gint h)
             + (g << RrDefaultGreenOffset)
             + (b << RrDefaultBlueOffset);
         p = data;
-        for (i = 0; i < h; i += 2, p += w)
-            for (x = 0; x < w; ++x, ++p)
-                *p = current;
+        for (i = 0; i < h; i += 2, p += w * 2) {
+            *p = current;
+            repeat_pixel(p, w);
+        }
     }
 
     if (a->surface.relief == RR_RELIEF_FLAT && a->surface.border) {
@@ -491,6 +512,21 @@ static void gradient_solid(RrAppearance *l, gint w, gint h)
     }                                                     \
 }
 
+static void gradient_row_plain(RrPixel32 *data, gint len,
+                               const RrColor *from, const RrColor *to)
+{
+    register gint x;
+
+    VARS(x);
+    SETUP(x, from, to, len);
+
+    for (x = len - 1; x > 0; --x) {  /* 0 -> len - 1 */
+        *(data++) = COLOR(x);
+        NEXT(x);
+    }
+    *data = COLOR(x);
+}
+
 static void gradient_splitvertical(RrAppearance *a, gint w, gint h)
 {
     register gint y1, y2, y3;
@@ -562,25 +598,15 @@ static void gradient_splitvertical(RrAppearance *a, gint w, gint h)
 
 static void gradient_horizontal(RrSurface *sf, gint w, gint h)
 {
-    register gint x, y, cpbytes;
-    RrPixel32 *data = sf->pixel_data, *datav;
+    register gint y, cpbytes;
+    RrPixel32 *data = sf->pixel_data;
     gchar *datac;
 
-    VARS(x);
-    SETUP(x, sf->primary, sf->secondary, w);
-
     /* set the color values for the first row */
-    datav = data;
-    for (x = w - 1; x > 0; --x) {  /* 0 -> w - 1 */
-        *datav = COLOR(x);
-        ++datav;
-        NEXT(x);
-    }
-    *datav = COLOR(x);
-    ++datav;
+    gradient_row(data, w, sf->primary, sf->secondary);
 
     /* copy the first row to the rest in O(logn) copies */
-    datac = (gchar*)datav;
+    datac = (gchar*)(data + w);
     cpbytes = 1 * w * sizeof(RrPixel32);
     for (y = (h - 1) * w * sizeof(RrPixel32); y > 0;) {
         memcpy(datac, data, cpbytes);
@@ -594,40 +620,20 @@ static void gradient_horizontal(RrSurface *sf, gint w, gint h)
 
 static void gradient_mirrorhorizontal(RrSurface *sf, gint w, gint h)
 {
-    register gint x, y, half1, half2, cpbytes;
-    RrPixel32 *data = sf->pixel_data, *datav;
+    register gint y, half1, half2, cpbytes;
+    RrPixel32 *data = sf->pixel_data;
     gchar *datac;
 
-    VARS(x);
-
     half1 = (w + 1) / 2;
     half2 = w / 2;
 
     /* set the color values for the first row */
-
-    SETUP(x, sf->primary, sf->secondary, half1);
-    datav = data;
-    for (x = half1 - 1; x > 0; --x) {  /* 0 -> half1 - 1 */
-        *datav = COLOR(x);
-        ++datav;
-        NEXT(x);
-    }
-    *datav = COLOR(x);
-    ++datav;
-
-    if (half2 > 0) {
-        SETUP(x, sf->secondary, sf->primary, half2);
-        for (x = half2 - 1; x > 0; --x) {  /* 0 -> half2 - 1 */
-            *datav = COLOR(x);
-            ++datav;
-            NEXT(x);
-        }
-        *datav = COLOR(x);
-        ++datav;
-    }
+    gradient_row(data, half1, sf->primary, sf->secondary);
+    if (half2 > 0)
+        gradient_row(data + half1, half2, sf->secondary, sf->primary);
 
     /* copy the first row to the rest in O(logn) copies */
-    datac = (gchar*)datav;
+    datac = (gchar*)(data + w);
     cpbytes = 1 * w * sizeof(RrPixel32);
     for (y = (h - 1) * w * sizeof(RrPixel32); y > 0;) {
         memcpy(datac, data, cpbytes);
@@ -667,14 +673,13 @@ static void gradient_vertical(RrSurface *sf, gint w, gint h)
 
 static void gradient_diagonal(RrSurface *sf, gint w, gint h)
 {
-    register gint x, y;
+    register gint y;
     RrPixel32 *data = sf->pixel_data;
     RrColor left, right;
     RrColor extracorner;
 
     VARS(lefty);
     VARS(righty);
-    VARS(x);
 
     extracorner.r = (sf->primary->r + sf->secondary->r) / 2;
     extracorner.g = (sf->primary->g + sf->secondary->g) / 2;
@@ -687,14 +692,8 @@ static void gradient_diagonal(RrSurface *sf, gint w, gint h)
         COLOR_RR(lefty, (&left));
         COLOR_RR(righty, (&right));
 
-        SETUP(x, (&left), (&right), w);
-
-        for (x = w - 1; x > 0; --x) {  /* 0 -> w-1 */
-            *(data++) = COLOR(x);
-
-            NEXT(x);
-        }
-        *(data++) = COLOR(x);
+        gradient_row(data, w, &left, &right);
+        data += w;
 
         NEXT(lefty);
         NEXT(righty);
@@ -702,26 +701,18 @@ static void gradient_diagonal(RrSurface *sf, gint w, gint h)
     COLOR_RR(lefty, (&left));
     COLOR_RR(righty, (&right));
 
-    SETUP(x, (&left), (&right), w);
-
-    for (x = w - 1; x > 0; --x) {  /* 0 -> w-1 */
-        *(data++) = COLOR(x);
-
-        NEXT(x);
-    }
-    *data = COLOR(x);
+    gradient_row(data, w, &left, &right);
 }
 
 static void gradient_crossdiagonal(RrSurface *sf, gint w, gint h)
 {
-    register gint x, y;
+    register gint y;
     RrPixel32 *data = sf->pixel_data;
     RrColor left, right;
     RrColor extracorner;
 
     VARS(lefty);
     VARS(righty);
-    VARS(x);
 
     extracorner.r = (sf->primary->r + sf->secondary->r) / 2;
     extracorner.g = (sf->primary->g + sf->secondary->g) / 2;
@@ -734,14 +725,8 @@ static void gradient_crossdiagonal(RrSurface *sf, gint w, gint h)
         COLOR_RR(lefty, (&left));
         COLOR_RR(righty, (&right));
 
-        SETUP(x, (&left), (&right), w);
-
-        for (x = w - 1; x > 0; --x) {  /* 0 -> w-1 */
-            *(data++) = COLOR(x);
-
-            NEXT(x);
-        }
-        *(data++) = COLOR(x);
+        gradient_row(data, w, &left, &right);
+        data += w;
 
         NEXT(lefty);
         NEXT(righty);
@@ -749,14 +734,7 @@ static void gradient_crossdiagonal(RrSurface *sf, gint w, gint h)
     COLOR_RR(lefty, (&left));
     COLOR_RR(righty, (&right));
 
-    SETUP(x, (&left), (&right), w);
-
-    for (x = w - 1; x > 0; --x) {  /* 0 -> w-1 */
-        *(data++) = COLOR(x);
-
-        NEXT(x);
-    }
-    *data = COLOR(x);
+    gradient_row(data, w, &left, &right);
 }
 
 static void gradient_pyramid(RrSurface *sf, gint w, gint h)
@@ -769,7 +747,6 @@ static void gradient_pyramid(RrSurface *sf, gint w, gint h)
 
     VARS(lefty);
     VARS(righty);
-    VARS(x);
 
     extracorner.r = (sf->primary->r + sf->secondary->r) / 2;
     extracorner.g = (sf->primary->g + sf->secondary->g) / 2;
@@ -783,32 +760,21 @@ static void gradient_pyramid(RrSurface *sf, gint w, gint h)
     SETUP(lefty, sf->primary, (&extracorner), halfh + midy);
     SETUP(righty, (&extracorner), sf->secondary, halfh + midy);
 
-    /* draw the top half
-
-       it is faster to draw both top quarters together than to draw one and
-       then copy it over to the other side.
-    */
+    /* draw the top half, one quarter at a time */
 
     ldata = sf->pixel_data;
     rdata = ldata + w - 1;
     for (y = halfh + midy; y > 0; --y) {  /* 0 -> (h+1)/2 */
-        RrPixel32 c;
-
         COLOR_RR(lefty, (&left));
         COLOR_RR(righty, (&right));
 
-        SETUP(x, (&left), (&right), halfw + midx);
-
-        for (x = halfw + midx - 1; x > 0; --x) {  /* 0 -> (w+1)/2 */
-            c = COLOR(x);
-            *(ldata++) = *(rdata--) = c;
-
-            NEXT(x);
-        }
-        c = COLOR(x);
-        *ldata = *rdata = c;
-        ldata += halfw + 1;
-        rdata += halfw - 1 + midx + w;
+        /* the left quarter, 0 -> (w+1)/2 */
+        gradient_row(ldata, halfw + midx, &left, &right);
+        /* and mirror it into the right quarter */
+        for (x = 0; x < halfw; ++x)
+            *(rdata - x) = *(ldata + x);
+        ldata += w;
+        rdata += w;
 
         NEXT(lefty);
         NEXT(righty);
@@ -24,4 +24,11 @@
 
 void RrRender(RrAppearance *a, gint w, gint h);
 
+/*! Chooses between the SIMD and the portable code for rendering gradients.
+  They give the same pixels, this is for testing that.
+  @return FALSE if the CPU is not able to run any SIMD code, in which case
+    the portable code is always used.
+*/
+gboolean RrGradientSimd(gboolean enable);
+
 #endif /* __gradient_h */
@@ -21,6 +21,7 @@
 #include "image.h"
 #include "color.h"
 #include "imagecache.h"
+#include "simd.h"
 #ifdef USE_IMLIB2
 #include <Imlib2.h>
 #endif
@@ -695,54 +696,244 @@ RrImage* RrImageNewFromName(RrImageCache *cache, const gchar *name)
  Image drawing and resizing operations.
 **************************************************************************/
 
-/*! Given a picture in RGBA format, of a specified size, resize it to the new
-  requested size (but keep its aspect ratio).  If the image does not need to
-  be resized (it is already the right size) then this returns NULL.  Otherwise
-  it returns a newly allocated RrImagePic with the resized picture inside it
-  @return Returns a newly allocated RrImagePic object with a new version of the
-    image in the requested size (keeping aspect ratio).
-*/
-static RrImagePic* ResizeImage(RrPixel32 *src,
-                               gulong srcW, gulong srcH,
-                               gulong dstW, gulong dstH)
+/*! Works out which source pixels are averaged into each destination pixel
+  along one side of an image, and how much of each source pixel is covered by
+  the destination pixel. */
+static void resize_taps_init(RrResizeTaps *taps, gulong srcW, gulong dstW)
+{
+    gulong ratio, src, src1, src2, portion, sum;
+    gulong dst;
+    gint n, first;
+
+    ratio = (srcW << FRACTION) / dstW;
+
+    /* each destination pixel covers at most ratio+2 source pixels, counting
+       the partial ones at each end */
+    taps->first = g_new(gint, dstW);
+    taps->count = g_new(gint, dstW);
+    n = dstW * (ratio / (1UL << FRACTION) + 2);
+    taps->weight = g_new(gfloat, n);
+    taps->portion = g_new(gulong, n);
+
+    n = 0;
+    src2 = 0;
+    for (dst = 0; dst < dstW; ++dst) {
+        src1 = src2;
+        src2 += ratio;
+
+        first = n;
+        sum = 0;
+        for (src = src1; src < src2; src += (1UL << FRACTION)) {
+            if (src == src1) {
+                src = FLOOR(src);
+                portion = (1UL << FRACTION) - (src1 - src);
+                if (portion > src2 - src1)
+                    portion = src2 - src1;
+                taps->first[dst] = src >> FRACTION;
+            }
+            else if (src == FLOOR(src2))
+                portion = src2 - src;
+            else
+                portion = (1UL << FRACTION);
+
+            taps->portion[n] = portion;
+            taps->weight[n++] = portion;
+            sum += portion;
+        }
+        taps->count[dst] = n - first;
+
+        g_assert(sum != 0);
+        for (; first < n; ++first)
+            taps->weight[first] /= sum;
+    }
+}
+
+static void resize_taps_free(RrResizeTaps *taps)
+{
+    g_free(taps->first);
+    g_free(taps->count);
+    g_free(taps->weight);
+    g_free(taps->portion);
+}
+
+static void resize_row_plain(const RrPixel32 *src, gfloat *dst, gint dst_w,
+                             const RrResizeTaps *taps)
+{
+    const gfloat *weight = taps->weight;
+    gint x, i, c;
+
+    for (x = 0; x < dst_w; ++x, dst += 4) {
+        const RrPixel32 *s = src + taps->first[x];
+
+        dst[0] = dst[1] = dst[2] = dst[3] = 0;
+        for (i = taps->count[x]; i > 0; --i, ++s, ++weight)
+            for (c = 0; c < 4; ++c)
+                dst[c] += ((*s >> (c * 8)) & 0xFF) * *weight;
+    }
+}
+
+static void resize_column_plain(const gfloat *rows, gint dst_w, gint count,
+                                const gfloat *weight, RrPixel32 *dst)
+{
+    gint x, i, c;
+
+    for (x = 0; x < dst_w; ++x) {
+        const gfloat *r = rows + x * 4;
+        gfloat sum[4] = { RR_RESIZE_BIAS, RR_RESIZE_BIAS,
+                          RR_RESIZE_BIAS, RR_RESIZE_BIAS };
+
+        for (i = 0; i < count; ++i, r += dst_w * 4)
+            for (c = 0; c < 4; ++c)
+                sum[c] += r[c] * weight[i];
+
+        *(dst++) = ((RrPixel32)MIN(sum[0], 255) << 0) |
+                   ((RrPixel32)MIN(sum[1], 255) << 8) |
+                   ((RrPixel32)MIN(sum[2], 255) << 16) |
+                   ((RrPixel32)MIN(sum[3], 255) << 24);
+    }
+}
+
+/*! Resizes a picture when it is getting bigger along either side.  Each
+  destination pixel covers at most 2x2 source pixels then, and it is built
+  from all of them at once, as the small weights are rounded the same way as
+  the original two dimensional filter always did.  Splitting it into two passes
+  would move some pixels by more than 1. */
+static void resize_up_plain(const RrPixel32 *src, gint srcW,
+                            RrPixel32 *dst, gint dstW, gint dstH,
+                            const RrResizeTaps *tapsX,
+                            const RrResizeTaps *tapsY)
+{
+    const gulong *portionX, *portionY = tapsY->portion;
+    gint x, y;
+    gint i, j, c;
+
+    for (y = 0; y < dstH; ++y) {
+        portionX = tapsX->portion;
+        for (x = 0; x < dstW; ++x) {
+            gulong sum[4] = { 0, 0, 0, 0 };
+            gulong portionXY, sumXY = 0;
+
+            for (j = 0; j < tapsY->count[y]; ++j) {
+                const RrPixel32 *s = src + (tapsY->first[y] + j) * srcW
+                    + tapsX->first[x];
+
+                for (i = 0; i < tapsX->count[x]; ++i, ++s) {
+                    portionXY = (portionX[i] * portionY[j]) >> FRACTION;
+                    sumXY += portionXY;
+                    for (c = 0; c < 4; ++c)
+                        sum[c] += ((*s >> (c * 8)) & 0xFF) * portionXY;
+                }
+            }
+            portionX += tapsX->count[x];
+
+            g_assert(sumXY != 0);
+            *(dst++) = ((sum[0] / sumXY) << 0) |
+                       ((sum[1] / sumXY) << 8) |
+                       ((sum[2] / sumXY) << 16) |
+                       ((sum[3] / sumXY) << 24);
+        }
+        portionY += tapsY->count[y];
+    }
+}
+
+/*! The resizing kernels, the fastest which the CPU can run unless
+  RrImageResizeSimd() says otherwise */
+static RrResizeRowFunc resize_row = NULL;
+static RrResizeColumnFunc resize_column = NULL;
+static RrResizeUpFunc resize_up = NULL;
+
+gboolean RrImageResizeSimd(gboolean enable)
+{
+    RrResizeRowFunc row = resize_row_plain;
+    RrResizeColumnFunc column = resize_column_plain;
+    RrResizeUpFunc up = resize_up_plain;
+    gboolean ok;
+
+    ok = RrSimdResize(&row, &column, &up);
+    resize_row = enable ? row : resize_row_plain;
+    resize_column = enable ? column : resize_column_plain;
+    resize_up = enable ? up : resize_up_plain;
+    return ok;
+}
+
+/*! Each destination pixel is the average of the source pixels under it,
+  weighted by how much of them it covers.  When shrinking, this is done in two
+  passes, first across each source row and then down the columns, which is a
+  lot less work than visiting every source pixel under every destination
+  pixel. */
+RrPixel32* RrImageResize(const RrPixel32 *src, gint srcW, gint srcH,
+                         gint dstW, gint dstH)
+{
+    RrPixel32 *dst;
+    RrResizeTaps tapsX, tapsY;
+    gfloat *rows, *weight;
+    gint y;
+
+    g_assert(srcW > 0);
+    g_assert(srcH > 0);
+    g_assert(dstW > 0);
+    g_assert(dstH > 0);
+
+    if (!resize_row)
+        RrImageResizeSimd(TRUE);
+
+    resize_taps_init(&tapsX, srcW, dstW);
+    resize_taps_init(&tapsY, srcH, dstH);
+
+    dst = g_new(RrPixel32, dstW * dstH);
+
+    if (dstW > srcW || dstH > srcH)
+        resize_up(src, srcW, dst, dstW, dstH, &tapsX, &tapsY);
+    else {
+        /* squash every source row down to the destination width */
+        rows = g_new(gfloat, srcH * dstW * 4);
+        for (y = 0; y < srcH; ++y)
+            resize_row(src + y * srcW, rows + y * dstW * 4, dstW, &tapsX);
+
+        /* then squash the rows down to the destination height */
+        weight = tapsY.weight;
+        for (y = 0; y < dstH; ++y) {
+            resize_column(rows + tapsY.first[y] * dstW * 4, dstW,
+                          tapsY.count[y], weight, dst + y * dstW);
+            weight += tapsY.count[y];
+        }
+        g_free(rows);
+    }
+
+    resize_taps_free(&tapsX);
+    resize_taps_free(&tapsY);
+
+    return dst;
+}
+
+/*! This is the original scaler, which visits every source pixel under every
+  destination pixel.  RrImageResize() replaced it, and it is kept only to
+  test that against. */
+RrPixel32* RrImageResizeReference(const RrPixel32 *src, gint srcW, gint srcH,
+                                  gint dstW, gint dstH)
 {
     RrPixel32 *dst, *dststart;
-    RrImagePic *pic;
     gulong dstX, dstY, srcX, srcY;
     gulong srcX1, srcX2, srcY1, srcY2;
     gulong ratioX, ratioY;
-    gulong aspectW, aspectH;
 
     g_assert(srcW > 0);
     g_assert(srcH > 0);
     g_assert(dstW > 0);
     g_assert(dstH > 0);
 
-    /* keep the aspect ratio */
-    aspectW = dstW;
-    aspectH = (gint)(dstW * ((gdouble)srcH / srcW));
-    if (aspectH > dstH) {
-        aspectH = dstH;
-        aspectW = (gint)(dstH * ((gdouble)srcW / srcH));
-    }
-    dstW = aspectW ? aspectW : 1;
-    dstH = aspectH ? aspectH : 1;
-
-    if (srcW == dstW && srcH == dstH)
-        return NULL; /* no scaling needed! */
-
     dststart = dst = g_new(RrPixel32, dstW * dstH);
 
-    ratioX = (srcW << FRACTION) / dstW;
-    ratioY = (srcH << FRACTION) / dstH;
+    ratioX = ((gulong)srcW << FRACTION) / dstW;
+    ratioY = ((gulong)srcH << FRACTION) / dstH;
 
     srcY2 = 0;
-    for (dstY = 0; dstY < dstH; dstY++) {
+    for (dstY = 0; dstY < (gulong)dstH; dstY++) {
         srcY1 = srcY2;
         srcY2 += ratioY;
 
         srcX2 = 0;
-        for (dstX = 0; dstX < dstW; dstX++) {
+        for (dstX = 0; dstX < (gulong)dstW; dstX++) {
             gulong red = 0, green = 0, blue = 0, alpha = 0;
             gulong portionX, portionY, portionXY, sumXY = 0;
             RrPixel32 pixel;
@@ -803,8 +994,44 @@ static RrImagePic* ResizeImage(RrPixel32 *src,
         }
     }
 
+    return dststart;
+}
+
+/*! Given a picture in RGBA format, of a specified size, resize it to the new
+  requested size (but keep its aspect ratio).  If the image does not need to
+  be resized (it is already the right size) then this returns NULL.  Otherwise
+  it returns a newly allocated RrImagePic with the resized picture inside it.
+  @return Returns a newly allocated RrImagePic object with a new version of the
+    image in the requested size (keeping aspect ratio).
+*/
+static RrImagePic* ResizeImage(RrPixel32 *src,
+                               gulong srcW, gulong srcH,
+                               gulong dstW, gulong dstH)
+{
+    RrImagePic *pic;
+    gulong aspectW, aspectH;
+
+    g_assert(srcW > 0);
+    g_assert(srcH > 0);
+    g_assert(dstW > 0);
+    g_assert(dstH > 0);
+
+    /* keep the aspect ratio */
+    aspectW = dstW;
+    aspectH = (gint)(dstW * ((gdouble)srcH / srcW));
+    if (aspectH > dstH) {
+        aspectH = dstH;
+        aspectW = (gint)(dstH * ((gdouble)srcW / srcH));
+    }
+    dstW = aspectW ? aspectW : 1;
+    dstH = aspectH ? aspectH : 1;
+
+    if (srcW == dstW && srcH == dstH)
+        return NULL; /* no scaling needed! */
+
     pic = g_slice_new(RrImagePic);
-    RrImagePicInit(pic, dstW, dstH, dststart);
+    RrImagePicInit(pic, dstW, dstH,
+                   RrImageResize(src, srcW, srcH, dstW, dstH));
 
     return pic;
 }
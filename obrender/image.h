@@ -29,4 +29,21 @@ void RrImageDrawRGBA(RrPixel32 *target, RrTextureRGBA *rgba,
                      gint target_w, gint target_h,
                      RrRect *area);
 
+/*! Resizes a picture to exactly the given size, averaging the source pixels
+  under each destination pixel.
+  @return A newly allocated buffer of @dstW x @dstH pixels
+*/
+RrPixel32* RrImageResize(const RrPixel32 *src, gint srcW, gint srcH,
+                         gint dstW, gint dstH);
+/*! Resizes a picture like RrImageResize() with the original, much slower,
+  scaler.  RrImageResize() should give the same pixels to within 1 in each
+  channel, and this is for testing that. */
+RrPixel32* RrImageResizeReference(const RrPixel32 *src, gint srcW, gint srcH,
+                                  gint dstW, gint dstH);
+/*! Chooses between the SIMD and the portable code for resizing pictures.
+  @return FALSE if the CPU is not able to run any SIMD code, in which case
+    the portable code is always used.
+*/
+gboolean RrImageResizeSimd(gboolean enable);
+
 #endif
@@ -19,11 +19,15 @@
 
 #include "render.h"
 #include "instance.h"
+#include "paintcache.h"
 
 static RrInstance *definst = NULL;
 
 static void RrTrueColorSetup (RrInstance *inst);
 static void RrPseudoColorSetup (RrInstance *inst);
+#ifdef XSHM
+static void RrShmRelease (RrInstance *inst, RrShmSegment *seg);
+#endif
 
 #ifdef DEBUG
 #include "color.h"
@@ -57,6 +61,10 @@ void print_refs(gint id)
 
 RrInstance* RrInstanceNew (Display *display, gint screen)
 {
+#ifdef XSHM
+    gint i;
+#endif
+
     definst = g_slice_new(RrInstance);
     definst->display = display;
     definst->screen = screen;
@@ -70,6 +78,18 @@ RrInstance* RrInstanceNew (Display *display, gint screen)
 
     definst->color_hash = g_hash_table_new_full(g_int_hash, g_int_equal,
                                                 NULL, dest);
+    definst->paint_cache = RrPaintCacheNew();
+
+#ifdef XSHM
+    /* only used for 32bpp TrueColor, which is checked for in RrShmImage */
+    definst->shm = (definst->visual->class == TrueColor &&
+                    XShmQueryExtension(display));
+    for (i = 0; i < RR_SHM_SEGMENTS; ++i) {
+        definst->shm_segs[i].size = 0;
+        definst->shm_segs[i].busy = FALSE;
+    }
+    definst->shm_next = 0;
+#endif
 
     switch (definst->visual->class) {
     case TrueColor:
@@ -207,8 +227,17 @@ static void RrPseudoColorSetup (RrInstance *inst)
 
 void RrInstanceFree (RrInstance *inst)
 {
+#ifdef XSHM
+    gint i;
+#endif
+
     if (inst) {
         if (inst == definst) definst = NULL;
+        RrPaintCacheFree(inst->paint_cache);
+#ifdef XSHM
+        for (i = 0; i < RR_SHM_SEGMENTS; ++i)
+            RrShmRelease(inst, &inst->shm_segs[i]);
+#endif
         g_free(inst->pseudo_colors);
         g_hash_table_destroy(inst->color_hash);
         g_object_unref(inst->pango);
@@ -216,6 +245,134 @@ void RrInstanceFree (RrInstance *inst)
     }
 }
 
+#ifdef XSHM
+static gboolean shm_error;
+
+static gint shm_error_handler(Display *d, XErrorEvent *e)
+{
+    shm_error = TRUE;
+    return 0;
+}
+
+/*! Is request serial a <= b, for serials which may wrap around */
+#define SERIAL_LE(a, b) ((glong)((b) - (a)) >= 0)
+
+static void RrShmRelease(RrInstance *inst, RrShmSegment *seg)
+{
+    if (seg->size) {
+        XShmDetach(inst->display, &seg->info);
+        /* don't remove the memory while the server is still using it */
+        XSync(inst->display, FALSE);
+        shmdt(seg->info.shmaddr);
+        seg->size = 0;
+        seg->busy = FALSE;
+    }
+}
+
+/*! Makes the shared segment at least @size bytes big */
+static gboolean RrShmGrow(RrInstance *inst, RrShmSegment *seg, gsize size)
+{
+    XErrorHandler old;
+
+    RrShmRelease(inst, seg);
+
+    seg->info.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (seg->info.shmid < 0)
+        return FALSE;
+    seg->info.shmaddr = shmat(seg->info.shmid, NULL, 0);
+    if (seg->info.shmaddr == (gchar*)-1) {
+        shmctl(seg->info.shmid, IPC_RMID, NULL);
+        return FALSE;
+    }
+    seg->info.readOnly = True;
+
+    /* attaching fails when the server is on another machine, even though the
+       extension is there, so catch the error */
+    XSync(inst->display, FALSE);
+    shm_error = FALSE;
+    old = XSetErrorHandler(shm_error_handler);
+    XShmAttach(inst->display, &seg->info);
+    XSync(inst->display, FALSE);
+    XSetErrorHandler(old);
+
+    /* the segment goes away once both of us have detached from it, even if
+       we crash */
+    shmctl(seg->info.shmid, IPC_RMID, NULL);
+
+    if (shm_error) {
+        shmdt(seg->info.shmaddr);
+        return FALSE;
+    }
+    seg->size = size;
+    return TRUE;
+}
+#endif
+
+XImage* RrShmImage(const RrInstance *cinst, gint w, gint h)
+{
+#ifdef XSHM
+    /* the shared memory is a cache that the instance keeps for its users */
+    RrInstance *inst = (RrInstance*)cinst;
+    RrShmSegment *seg;
+    XImage *im;
+    gsize size;
+
+    if (!inst->shm)
+        return NULL;
+
+    seg = &inst->shm_segs[inst->shm_next];
+    inst->shm_next = (inst->shm_next + 1) % RR_SHM_SEGMENTS;
+
+    im = XShmCreateImage(inst->display, inst->visual, inst->depth, ZPixmap,
+                         NULL, &seg->info, w, h);
+    if (!im || im->bits_per_pixel != 32) {
+        /* only 32bpp is worth it, see pixel_data_to_pixmap */
+        if (im) XDestroyImage(im);
+        inst->shm = FALSE;
+        return NULL;
+    }
+
+    size = (gsize)im->bytes_per_line * im->height;
+    if (size > seg->size) {
+        if (!RrShmGrow(inst, seg, size)) {
+            XDestroyImage(im);
+            inst->shm = FALSE;
+            return NULL;
+        }
+    }
+    else if (seg->busy &&
+             !SERIAL_LE(seg->serial, LastKnownRequestProcessed(inst->display)))
+        /* the server may still be reading the last upload from this segment,
+           so wait for it before writing over it.  this only happens when
+           every segment has been used since the server last replied */
+        XSync(inst->display, FALSE);
+
+    im->data = seg->info.shmaddr;
+    return im;
+#else
+    return NULL;
+#endif
+}
+
+void RrShmImageFree(const RrInstance *cinst, XImage *im)
+{
+#ifdef XSHM
+    RrInstance *inst = (RrInstance*)cinst;
+    gint i;
+
+    /* the upload was the last request sent */
+    for (i = 0; i < RR_SHM_SEGMENTS; ++i)
+        if (im->obdata == (XPointer)&inst->shm_segs[i].info) {
+            inst->shm_segs[i].busy = TRUE;
+            inst->shm_segs[i].serial = NextRequest(inst->display) - 1;
+        }
+
+    /* the data belongs to the instance */
+    im->data = NULL;
+    XDestroyImage(im);
+#endif
+}
+
 Display* RrDisplay (const RrInstance *inst)
 {
     return (inst ? inst : definst)->display;
@@ -305,3 +462,8 @@ GHashTable* RrColorHash (const RrInstance *inst)
 {
     return (inst ? inst : definst)->color_hash;
 }
+
+RrPaintCache* RrInstancePaintCache (const RrInstance *inst)
+{
+    return (inst ? inst : definst)->paint_cache;
+}
@@ -23,6 +23,31 @@
 #include <glib.h>
 #include <pango/pangoxft.h>
 
+struct _RrPaintCache;
+
+#ifdef XSHM
+#  include <sys/ipc.h>
+#  include <sys/shm.h>
+#  include <X11/extensions/XShm.h>
+
+/*! The number of shared segments which are used in turn for uploads, so
+  that one can be filled while the server may still be reading another */
+#define RR_SHM_SEGMENTS 4
+
+typedef struct _RrShmSegment RrShmSegment;
+
+struct _RrShmSegment {
+    XShmSegmentInfo info;
+    /*! The size of the segment, 0 if there is none yet */
+    gsize size;
+    /*! An upload from the segment has been sent */
+    gboolean busy;
+    /*! The serial of the last upload from the segment.  The server may still
+      be reading it until it has processed this request */
+    gulong serial;
+};
+#endif
+
 struct _RrInstance {
     Display *display;
     gint screen;
@@ -48,10 +73,33 @@ struct _RrInstance {
     XColor *pseudo_colors;
 
     GHashTable *color_hash;
+    struct _RrPaintCache *paint_cache;
+
+#ifdef XSHM
+    /*! FALSE once MIT-SHM is found to be unusable with this display */
+    gboolean shm;
+    /*! Segments shared with the server, used in turn for uploads */
+    RrShmSegment shm_segs[RR_SHM_SEGMENTS];
+    /*! The segment to use for the next upload */
+    guint shm_next;
+#endif
 };
 
 guint       RrPseudoBPC    (const RrInstance *inst);
 XColor*     RrPseudoColors (const RrInstance *inst);
 GHashTable* RrColorHash    (const RrInstance *inst);
+struct _RrPaintCache* RrInstancePaintCache(const RrInstance *inst);
+
+/*! Returns an image of the given size whose data lives in memory shared with
+  the X server, for uploading with XShmPutImage.  The memory is reused by
+  later calls, so it should be filled and uploaded right away.  Free the image
+  with RrShmImageFree right after uploading it.
+  @return NULL if MIT-SHM can't be used, and XPutImage should be used
+    instead.
+*/
+XImage*     RrShmImage     (const RrInstance *inst, gint w, gint h);
+/*! Frees an image from RrShmImage, but not its shared memory, and notes that
+  the server may be reading the memory until it handles the upload */
+void        RrShmImageFree (const RrInstance *inst, XImage *im);
 
 #endif
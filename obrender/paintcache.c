@@ -0,0 +1,265 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   paintcache.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "render.h"
+#include "paintcache.h"
+#include "color.h"
+#include "mask.h"
+
+#include <string.h>
+
+static void entry_free(RrPaintCacheEntry *e);
+static void drop(RrPaintCache *self, RrPaintCacheEntry *e);
+static void trim(RrPaintCache *self);
+
+RrPaintCache* RrPaintCacheNew(void)
+{
+    RrPaintCache *self;
+
+    self = g_slice_new(RrPaintCache);
+    self->table = g_hash_table_new((GHashFunc)g_string_hash,
+                                   (GEqualFunc)g_string_equal);
+    g_queue_init(&self->lru);
+    self->pixels = 0;
+    return self;
+}
+
+void RrPaintCacheFree(RrPaintCache *self)
+{
+    if (self) {
+        RrPaintCacheEntry *e;
+
+        /* everything should be done using the cache by now */
+        while ((e = g_queue_pop_head(&self->lru)))
+            entry_free(e);
+        g_hash_table_destroy(self->table);
+        g_slice_free(RrPaintCache, self);
+    }
+}
+
+void RrPaintCacheClear(RrPaintCache *self)
+{
+    while (self->lru.head)
+        drop(self, self->lru.head->data);
+}
+
+static void entry_free(RrPaintCacheEntry *e)
+{
+    XFreePixmap(RrDisplay(e->inst), e->pixmap);
+    g_string_free(e->key, TRUE);
+    g_free(e->pixel_data);
+    g_slice_free(RrPaintCacheEntry, e);
+}
+
+/*! Takes the entry out of the cache.  It is freed when nothing is using it */
+static void drop(RrPaintCache *self, RrPaintCacheEntry *e)
+{
+    g_hash_table_remove(self->table, e->key);
+    g_queue_delete_link(&self->lru, e->link);
+    e->link = NULL;
+    self->pixels -= e->w * e->h;
+
+    if (e->ref == 0)
+        entry_free(e);
+}
+
+/*! Frees the least recently used entries which nothing is using, until the
+  cache fits in its budget again */
+static void trim(RrPaintCache *self)
+{
+    GList *it, *prev;
+
+    for (it = self->lru.tail; it && self->pixels > RR_PAINT_CACHE_PIXELS;
+         it = prev)
+    {
+        RrPaintCacheEntry *e = it->data;
+
+        prev = it->prev;
+        if (e->ref == 0)
+            drop(self, e);
+    }
+}
+
+static void key_int(GString *key, gint i)
+{
+    g_string_append_len(key, (gchar*)&i, sizeof(i));
+}
+
+static void key_color(GString *key, const RrColor *c)
+{
+    if (c) {
+        key_int(key, RrColorRed(c));
+        key_int(key, RrColorGreen(c));
+        key_int(key, RrColorBlue(c));
+    }
+    else
+        key_int(key, -1);
+}
+
+static void key_string(GString *key, const gchar *s)
+{
+    if (s) {
+        key_int(key, strlen(s));
+        g_string_append(key, s);
+    }
+    else
+        key_int(key, -1);
+}
+
+GString* RrPaintCacheKey(const RrAppearance *a, gint w, gint h)
+{
+    const RrSurface *s = &a->surface;
+    GString *key;
+    gint i;
+
+    /* this copies from the parent, which could be anything */
+    if (s->grad == RR_SURFACE_PARENTREL)
+        return NULL;
+    for (i = 0; i < a->textures; ++i)
+        /* these are drawn from client data which can change under the same
+           pointer */
+        if (a->texture[i].type == RR_TEXTURE_RGBA ||
+            a->texture[i].type == RR_TEXTURE_IMAGE)
+            return NULL;
+
+    key = g_string_sized_new(128);
+    key_int(key, w);
+    key_int(key, h);
+
+    key_int(key, s->grad);
+    key_int(key, s->relief);
+    key_int(key, s->bevel);
+    key_color(key, s->primary);
+    key_color(key, s->secondary);
+    key_color(key, s->border_color);
+    /* bevel_dark and bevel_light are made from these when it is painted */
+    key_color(key, s->interlace_color);
+    key_int(key, s->interlaced);
+    key_int(key, s->border);
+    key_int(key, s->bevel_dark_adjust);
+    key_int(key, s->bevel_light_adjust);
+    key_color(key, s->split_primary);
+    key_color(key, s->split_secondary);
+
+    key_int(key, a->textures);
+    for (i = 0; i < a->textures; ++i) {
+        const RrTextureData *d = &a->texture[i].data;
+
+        key_int(key, a->texture[i].type);
+        switch (a->texture[i].type) {
+        case RR_TEXTURE_NONE:
+            break;
+        case RR_TEXTURE_TEXT:
+            /* fonts can't change, and the cache is cleared when one is
+               closed */
+            g_string_append_len(key, (gchar*)&d->text.font,
+                                sizeof(d->text.font));
+            key_int(key, d->text.justify);
+            key_color(key, d->text.color);
+            key_string(key, d->text.string);
+            key_int(key, d->text.shadow_offset_x);
+            key_int(key, d->text.shadow_offset_y);
+            key_color(key, d->text.shadow_color);
+            key_int(key, d->text.shortcut);
+            key_int(key, d->text.shortcut_pos);
+            key_int(key, d->text.ellipsize);
+            key_int(key, d->text.flow);
+            key_int(key, d->text.maxwidth);
+            key_int(key, d->text.shadow_alpha);
+            break;
+        case RR_TEXTURE_LINE_ART:
+            key_color(key, d->lineart.color);
+            key_int(key, d->lineart.x1);
+            key_int(key, d->lineart.y1);
+            key_int(key, d->lineart.x2);
+            key_int(key, d->lineart.y2);
+            break;
+        case RR_TEXTURE_MASK:
+            key_color(key, d->mask.color);
+            if (d->mask.mask) {
+                const RrPixmapMask *m = d->mask.mask;
+
+                key_int(key, m->width);
+                key_int(key, m->height);
+                g_string_append_len(key, m->data,
+                                    (m->width + 7) / 8 * m->height);
+            }
+            else
+                key_int(key, -1);
+            break;
+        case RR_TEXTURE_RGBA:
+        case RR_TEXTURE_IMAGE:
+        case RR_TEXTURE_NUM_TYPES:
+            g_assert_not_reached();
+        }
+    }
+    return key;
+}
+
+RrPaintCacheEntry* RrPaintCacheFind(RrPaintCache *self, const GString *key)
+{
+    RrPaintCacheEntry *e;
+
+    e = g_hash_table_lookup(self->table, key);
+    if (e) {
+        ++e->ref;
+        /* move it to the front of the lru list */
+        g_queue_unlink(&self->lru, e->link);
+        g_queue_push_head_link(&self->lru, e->link);
+    }
+    return e;
+}
+
+RrPaintCacheEntry* RrPaintCacheAdd(RrPaintCache *self, GString *key,
+                                   const RrInstance *inst, Pixmap pixmap,
+                                   gint w, gint h,
+                                   const RrPixel32 *pixel_data)
+{
+    RrPaintCacheEntry *e;
+
+    if ((e = g_hash_table_lookup(self->table, key)))
+        drop(self, e);
+
+    e = g_slice_new(RrPaintCacheEntry);
+    e->inst = inst;
+    e->ref = 1;
+    e->key = key;
+    e->pixmap = pixmap;
+    e->w = w;
+    e->h = h;
+    e->pixel_data = g_memdup2(pixel_data, w * h * sizeof(RrPixel32));
+
+    g_queue_push_head(&self->lru, e);
+    e->link = self->lru.head;
+    g_hash_table_insert(self->table, e->key, e);
+    self->pixels += w * h;
+
+    trim(self);
+    return e;
+}
+
+void RrPaintCacheEntryUnref(RrPaintCache *self, RrPaintCacheEntry *e)
+{
+    if (e && --e->ref == 0) {
+        if (!e->link)
+            /* it was dropped from the cache while it was being used */
+            entry_free(e);
+        else
+            trim(self);
+    }
+}
@@ -0,0 +1,99 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   paintcache.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __paintcache_h
+#define __paintcache_h
+
+#include "render.h"
+
+#include <X11/Xlib.h>
+#include <glib.h>
+
+typedef struct _RrPaintCache      RrPaintCache;
+typedef struct _RrPaintCacheEntry RrPaintCacheEntry;
+
+/*! The most pixels of painted pixmaps which are kept around when no
+  appearance is using them.  The pixel data for them is kept in the client as
+  well, for the appearances which are parent relative to them. */
+#define RR_PAINT_CACHE_PIXELS (1024 * 1024)
+
+/*! A cache of painted pixmaps, so that appearances which look exactly the
+  same and are painted at the same size can share one pixmap instead of each
+  rendering and uploading their own.  For eg, the titlebars of all the
+  unfocused windows which are the same width.
+
+  The entries are found by their contents, which is everything about the
+  appearance that changes how it is painted.  The least recently used ones
+  are freed once there are too many pixels in the cache.
+*/
+struct _RrPaintCache {
+    /*! The entries, with their key as the key */
+    GHashTable *table;
+    /*! The entries in the table, most recently used first */
+    GQueue lru;
+    /*! The number of pixels in all the entries in the table */
+    gulong pixels;
+};
+
+struct _RrPaintCacheEntry {
+    const RrInstance *inst;
+    gint ref;
+    /*! Describes the painted appearance, see RrPaintCacheKey */
+    GString *key;
+    /*! This entry's link in the cache's lru list, NULL if it has been
+      dropped from the cache and is only waiting for its last user to let it
+      go */
+    GList *link;
+
+    Pixmap pixmap;
+    gint w, h;
+    /*! The appearance's surface.pixel_data after it was painted */
+    RrPixel32 *pixel_data;
+};
+
+RrPaintCache* RrPaintCacheNew(void);
+void RrPaintCacheFree(RrPaintCache *self);
+
+/*! Drops every entry from the cache.  This is needed when something that the
+  keys point to goes away, as a new one could show up at the same address. */
+void RrPaintCacheClear(RrPaintCache *self);
+
+/*! Describes everything that changes how the appearance looks when it is
+  painted at the given size.
+  @return NULL if the appearance can't be cached, because it depends on
+    something other than its own settings, such as a parent's pixel data or
+    image data which may change.
+*/
+GString* RrPaintCacheKey(const RrAppearance *a, gint w, gint h);
+
+/*! Finds a painted pixmap for the given key, and adds a reference to it.
+  The key is not freed. */
+RrPaintCacheEntry* RrPaintCacheFind(RrPaintCache *self, const GString *key);
+
+/*! Adds a painted pixmap to the cache.  The cache takes ownership of the
+  pixmap and the key, and copies the pixel data.
+  @return The new entry, with a reference held for the caller.
+*/
+RrPaintCacheEntry* RrPaintCacheAdd(RrPaintCache *self, GString *key,
+                                   const RrInstance *inst, Pixmap pixmap,
+                                   gint w, gint h,
+                                   const RrPixel32 *pixel_data);
+
+void RrPaintCacheEntryUnref(RrPaintCache *self, RrPaintCacheEntry *e);
+
+#endif
@@ -25,6 +25,8 @@
 #include "color.h"
 #include "image.h"
 #include "theme.h"
+#include "instance.h"
+#include "paintcache.h"
 
 #include <glib.h>
 #include <X11/Xlib.h>
@@ -34,16 +36,41 @@
 #ifdef HAVE_STDLIB_H
 #  include <stdlib.h>
 #endif
+#include <string.h>
+
+/*! Images with fewer pixels than this are uploaded with XPutImage, as
+  waiting for the server to be done with the shared memory costs more than
+  sending them */
+#define RR_SHM_MIN_PIXELS 4096
 
 static void pixel_data_to_pixmap(RrAppearance *l,
                                  gint x, gint y, gint w, gint h);
 
+/*! Lets go of the appearance's pixmap.  If it belongs to the appearance, it is
+  returned, and the caller should free it.  If it is shared through the paint
+  cache then None is returned. */
+static Pixmap release_pixmap(RrAppearance *a)
+{
+    Pixmap p = a->pixmap;
+
+    if (a->cache) {
+        RrPaintCacheEntryUnref(RrInstancePaintCache(a->inst), a->cache);
+        a->cache = NULL;
+        p = None;
+    }
+    a->pixmap = None;
+    return p;
+}
+
 Pixmap RrPaintPixmap(RrAppearance *a, gint w, gint h)
 {
     gint i, transferred = 0, force_transfer = 0;
     Pixmap oldp = None;
     RrRect tarea; /* area in which to draw textures */
     gboolean resized;
+    RrPaintCache *cache;
+    RrPaintCacheEntry *e;
+    GString *key;
 
     if (w <= 0 || h <= 0) return None;
 
@@ -61,7 +88,36 @@ Pixmap RrPaintPixmap(RrAppearance *a, gint w, gint h)
 
     resized = (a->w != w || a->h != h);
 
-    oldp = a->pixmap; /* save to free after changing the visible pixmap */
+    /* see if something that looks just the same was painted already */
+    cache = RrInstancePaintCache(a->inst);
+    key = RrPaintCacheKey(a, w, h);
+    if (key && (e = RrPaintCacheFind(cache, key))) {
+        g_string_free(key, TRUE);
+
+        oldp = release_pixmap(a);
+        a->pixmap = e->pixmap;
+        a->cache = e;
+        a->w = w;
+        a->h = h;
+
+        /* nothing gets drawn in the shared pixmap */
+        if (a->xftdraw != NULL) {
+            XftDrawDestroy(a->xftdraw);
+            a->xftdraw = NULL;
+        }
+
+        /* children which are parent relative copy from this */
+        if (resized) {
+            g_free(a->surface.pixel_data);
+            a->surface.pixel_data = g_new(RrPixel32, w * h);
+        }
+        memcpy(a->surface.pixel_data, e->pixel_data,
+               w * h * sizeof(RrPixel32));
+        return oldp;
+    }
+
+    /* save to free after changing the visible pixmap */
+    oldp = release_pixmap(a);
     a->pixmap = XCreatePixmap(RrDisplay(a->inst),
                               RrRootWindow(a->inst),
                               w, h, RrDepth(a->inst));
@@ -184,6 +240,10 @@ Pixmap RrPaintPixmap(RrAppearance *a, gint w, gint h)
         }
     }
 
+    if (key)
+        a->cache = RrPaintCacheAdd(cache, key, a->inst, a->pixmap, w, h,
+                                   a->surface.pixel_data);
+
     return oldp;
 }
 
@@ -315,6 +375,7 @@ RrAppearance *RrAppearanceCopy(RrAppearance *orig)
     copy->pixmap = None;
     copy->xftdraw = NULL;
     copy->w = copy->h = 0;
+    copy->cache = NULL;
     return copy;
 }
 
@@ -323,7 +384,8 @@ void RrAppearanceFree(RrAppearance *a)
 {
     if (a) {
         RrSurface *p;
-        if (a->pixmap != None) XFreePixmap(RrDisplay(a->inst), a->pixmap);
+        Pixmap pixmap = release_pixmap(a);
+        if (pixmap != None) XFreePixmap(RrDisplay(a->inst), pixmap);
         if (a->xftdraw != NULL) XftDrawDestroy(a->xftdraw);
         if (a->textures)
             g_free(a->texture);
@@ -345,25 +407,39 @@ void RrAppearanceFree(RrAppearance *a)
 static void pixel_data_to_pixmap(RrAppearance *l,
                                  gint x, gint y, gint w, gint h)
 {
-    RrPixel32 *in, *scratch;
+    RrPixel32 *in, *scratch = NULL;
     Pixmap out;
     XImage *im = NULL;
-    im = XCreateImage(RrDisplay(l->inst), RrVisual(l->inst), RrDepth(l->inst),
-                      ZPixmap, 0, NULL, w, h, 32, 0);
-    g_assert(im != NULL);
+    GC gc;
 
     in = l->surface.pixel_data;
     out = l->pixmap;
+    gc = DefaultGC(RrDisplay(l->inst), RrScreen(l->inst));
 
-/* this malloc is a complete waste of time on normal 32bpp
-   as reduce_depth just sets im->data = data and returns
-*/
-    scratch = g_new(RrPixel32, im->width * im->height);
-    im->data = (gchar*) scratch;
+#ifdef XSHM
+    /* small images go through the X socket just as fast */
+    if (w * h >= RR_SHM_MIN_PIXELS &&
+        (im = RrShmImage(l->inst, w, h)))
+    {
+        RrReduceDepth(l->inst, in, im);
+        XShmPutImage(RrDisplay(l->inst), out, gc, im, 0, 0, x, y, w, h,
+                     FALSE);
+        RrShmImageFree(l->inst, im);
+        return;
+    }
+#endif
+
+    im = XCreateImage(RrDisplay(l->inst), RrVisual(l->inst), RrDepth(l->inst),
+                      ZPixmap, 0, NULL, w, h, 32, 0);
+    g_assert(im != NULL);
+
+    /* on normal 32bpp, reduce_depth just sets im->data = data */
+    if (!RrDefaultFormat(l->inst, im)) {
+        scratch = g_new(RrPixel32, im->width * im->height);
+        im->data = (gchar*) scratch;
+    }
     RrReduceDepth(l->inst, in, im);
-    XPutImage(RrDisplay(l->inst), out,
-              DefaultGC(RrDisplay(l->inst), RrScreen(l->inst)),
-              im, 0, 0, x, y, w, h);
+    XPutImage(RrDisplay(l->inst), out, gc, im, 0, 0, x, y, w, h);
     im->data = NULL;
     XDestroyImage(im);
     g_free(scratch);
@@ -391,6 +467,22 @@ void RrMargins (RrAppearance *a, gint *l, gint *t, gint *r, gint *b)
     }
 }
 
+GString* RrTextLook(RrAppearance *a, gint w, gint h)
+{
+    GString *look;
+    RrRect tarea;
+    gint i, l, t, r, b;
+
+    RrMargins(a, &l, &t, &r, &b);
+    RECT_SET(tarea, l, t, w - l - r, h - t - b);
+
+    look = g_string_new(NULL);
+    for (i = 0; i < a->textures; ++i)
+        if (a->texture[i].type == RR_TEXTURE_TEXT)
+            RrFontLook(look, &a->texture[i].data.text, &tarea);
+    return look;
+}
+
 void RrMinSize(RrAppearance *a, gint *w, gint *h)
 {
     *w = RrMinWidth(a);
@@ -231,6 +231,8 @@ struct _RrAppearance {
 
     /* cached for internal use */
     gint w, h;
+    /* set when the pixmap is shared through the paint cache */
+    struct _RrPaintCacheEntry *cache;
 };
 
 /*! Holds a RGBA image picture */
@@ -409,6 +411,11 @@ gint   RrMinWidth    (RrAppearance *a);
    calling this, otherwise it doesn't need to be */
 gint   RrMinHeight   (RrAppearance *a);
 void   RrMargins     (RrAppearance *a, gint *l, gint *t, gint *r, gint *b);
+/*! Describes the text textures exactly as they are drawn when the appearance
+  is painted at the given size, after they are ellipsized to fit.  If the
+  text in the appearance changes, but its look doesn't, then painting it
+  again would not change anything.  Free it with g_string_free(). */
+GString* RrTextLook  (RrAppearance *a, gint w, gint h);
 
 gboolean RrPixmapToRGBA(const RrInstance *inst,
                         Pixmap pmap, Pixmap mask,
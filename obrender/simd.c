@@ -0,0 +1,351 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   simd.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "render.h"
+#include "simd.h"
+#include "color.h"
+#include <glib.h>
+#include <string.h>
+
+/* the kernels are built with the target attribute so that they can be chosen
+   at runtime, without building all of obrender for a newer CPU */
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || \
+     (defined(__GNUC__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#  define RR_SIMD_X86
+#  include <immintrin.h>
+#endif
+
+#ifdef RR_SIMD_X86
+
+/*! How one color channel changes across a gradient row, for a group of pixels
+  which are computed together.
+
+  Stepping through the gradient one pixel at a time (see NEXT() in
+  gradient.c) puts the channel at from + inc * floor((a * n + b) / m) for
+  pixel n.  Each lane keeps the quotient and remainder of that division for
+  its own pixel, and all of them move forward by one group at a time, which
+  needs a single compare to carry the remainder.
+*/
+typedef struct _RowChannel
+{
+    gint from;
+    gint inc;
+    gint m;      /*!< The divisor */
+    gint q;      /*!< How much the quotient grows for each group */
+    gint r;      /*!< How much the remainder grows for each group */
+    gint k[8];   /*!< The quotient for each lane's first pixel */
+    gint rem[8]; /*!< The remainder for each lane's first pixel */
+} RowChannel;
+
+static void row_channel_setup(RowChannel *c, gint from, gint to, gint len,
+                              gint lanes)
+{
+    gint d, a, b, i;
+
+    c->from = from;
+    c->inc = to < from ? -1 : 1;
+    d = ABS(to - from);
+
+    a = 2 * d;
+    c->m = 2 * len;
+    if (d <= len)
+        /* the color changes by at most one per pixel */
+        b = len;
+    else
+        /* the color changes by more than one per pixel.  this is not right
+           for pixel 0, which the caller has to fix */
+        b = 2 * len - 1 - d;
+
+    c->q = a * lanes / c->m;
+    c->r = a * lanes % c->m;
+    for (i = 0; i < lanes; ++i) {
+        gint n = a * i + b;
+
+        /* round down, even when n is negative */
+        c->k[i] = n >= 0 ? n / c->m : -((c->m - 1 - n) / c->m);
+        c->rem[i] = n - c->k[i] * c->m;
+    }
+}
+
+#define ROW_PIXEL(from)                             \
+    (((from)->r << RrDefaultRedOffset) +            \
+     ((from)->g << RrDefaultGreenOffset) +          \
+     ((from)->b << RrDefaultBlueOffset))
+
+/*! Puts together the color channels of a group of pixels */
+__attribute__((target("sse2")))
+static inline __m128i pixels_sse2(const __m128i *base, const __m128i *k,
+                                  const __m128i *neg)
+{
+    __m128i c[3];
+    gint i;
+
+    /* base + k, or base - k when the channel is getting darker */
+    for (i = 0; i < 3; ++i)
+        c[i] = _mm_add_epi32(base[i],
+                             _mm_sub_epi32(_mm_xor_si128(k[i], neg[i]),
+                                           neg[i]));
+    return _mm_or_si128(_mm_or_si128(
+                            _mm_slli_epi32(c[0], RrDefaultRedOffset),
+                            _mm_slli_epi32(c[1], RrDefaultGreenOffset)),
+                        _mm_slli_epi32(c[2], RrDefaultBlueOffset));
+}
+
+__attribute__((target("sse2")))
+static void gradient_row_sse2(RrPixel32 *data, gint len,
+                              const RrColor *from, const RrColor *to)
+{
+    RowChannel ch[3];
+    __m128i k[3], rem[3], q[3], r[3], m[3], mlast[3], base[3], neg[3];
+    __m128i pixels;
+    gint i, n;
+
+    row_channel_setup(&ch[0], from->r, to->r, len, 4);
+    row_channel_setup(&ch[1], from->g, to->g, len, 4);
+    row_channel_setup(&ch[2], from->b, to->b, len, 4);
+    for (i = 0; i < 3; ++i) {
+        k[i] = _mm_loadu_si128((const __m128i*)ch[i].k);
+        rem[i] = _mm_loadu_si128((const __m128i*)ch[i].rem);
+        q[i] = _mm_set1_epi32(ch[i].q);
+        r[i] = _mm_set1_epi32(ch[i].r);
+        m[i] = _mm_set1_epi32(ch[i].m);
+        mlast[i] = _mm_set1_epi32(ch[i].m - 1);
+        base[i] = _mm_set1_epi32(ch[i].from);
+        neg[i] = _mm_set1_epi32(ch[i].inc < 0 ? -1 : 0);
+    }
+
+    for (n = 0; n + 4 <= len; n += 4) {
+        pixels = pixels_sse2(base, k, neg);
+        _mm_storeu_si128((__m128i*)(data + n), pixels);
+
+        for (i = 0; i < 3; ++i) {
+            __m128i carry;
+
+            rem[i] = _mm_add_epi32(rem[i], r[i]);
+            k[i] = _mm_add_epi32(k[i], q[i]);
+            carry = _mm_cmpgt_epi32(rem[i], mlast[i]);
+            rem[i] = _mm_sub_epi32(rem[i], _mm_and_si128(carry, m[i]));
+            k[i] = _mm_sub_epi32(k[i], carry); /* carry is -1 */
+        }
+    }
+    if (n < len) {
+        RrPixel32 tail[4];
+
+        pixels = pixels_sse2(base, k, neg);
+        _mm_storeu_si128((__m128i*)tail, pixels);
+        memcpy(data + n, tail, (len - n) * sizeof(RrPixel32));
+    }
+
+    /* the first pixel is always the starting color */
+    data[0] = ROW_PIXEL(from);
+}
+
+/*! Puts together the color channels of a group of pixels */
+__attribute__((target("avx2")))
+static inline __m256i pixels_avx2(const __m256i *base, const __m256i *k,
+                                  const __m256i *neg)
+{
+    __m256i c[3];
+    gint i;
+
+    /* base + k, or base - k when the channel is getting darker */
+    for (i = 0; i < 3; ++i)
+        c[i] = _mm256_add_epi32(
+            base[i], _mm256_sub_epi32(_mm256_xor_si256(k[i], neg[i]), neg[i]));
+    return _mm256_or_si256(_mm256_or_si256(
+                               _mm256_slli_epi32(c[0], RrDefaultRedOffset),
+                               _mm256_slli_epi32(c[1], RrDefaultGreenOffset)),
+                           _mm256_slli_epi32(c[2], RrDefaultBlueOffset));
+}
+
+__attribute__((target("avx2")))
+static void gradient_row_avx2(RrPixel32 *data, gint len,
+                              const RrColor *from, const RrColor *to)
+{
+    RowChannel ch[3];
+    __m256i k[3], rem[3], q[3], r[3], m[3], mlast[3], base[3], neg[3];
+    __m256i pixels;
+    gint i, n;
+
+    row_channel_setup(&ch[0], from->r, to->r, len, 8);
+    row_channel_setup(&ch[1], from->g, to->g, len, 8);
+    row_channel_setup(&ch[2], from->b, to->b, len, 8);
+    for (i = 0; i < 3; ++i) {
+        k[i] = _mm256_loadu_si256((const __m256i*)ch[i].k);
+        rem[i] = _mm256_loadu_si256((const __m256i*)ch[i].rem);
+        q[i] = _mm256_set1_epi32(ch[i].q);
+        r[i] = _mm256_set1_epi32(ch[i].r);
+        m[i] = _mm256_set1_epi32(ch[i].m);
+        mlast[i] = _mm256_set1_epi32(ch[i].m - 1);
+        base[i] = _mm256_set1_epi32(ch[i].from);
+        neg[i] = _mm256_set1_epi32(ch[i].inc < 0 ? -1 : 0);
+    }
+
+    for (n = 0; n + 8 <= len; n += 8) {
+        pixels = pixels_avx2(base, k, neg);
+        _mm256_storeu_si256((__m256i*)(data + n), pixels);
+
+        for (i = 0; i < 3; ++i) {
+            __m256i carry;
+
+            rem[i] = _mm256_add_epi32(rem[i], r[i]);
+            k[i] = _mm256_add_epi32(k[i], q[i]);
+            carry = _mm256_cmpgt_epi32(rem[i], mlast[i]);
+            rem[i] = _mm256_sub_epi32(rem[i], _mm256_and_si256(carry, m[i]));
+            k[i] = _mm256_sub_epi32(k[i], carry); /* carry is -1 */
+        }
+    }
+    if (n < len) {
+        RrPixel32 tail[8];
+
+        pixels = pixels_avx2(base, k, neg);
+        _mm256_storeu_si256((__m256i*)tail, pixels);
+        memcpy(data + n, tail, (len - n) * sizeof(RrPixel32));
+    }
+
+    /* the first pixel is always the starting color */
+    data[0] = ROW_PIXEL(from);
+}
+
+__attribute__((target("sse2")))
+static void resize_row_sse2(const RrPixel32 *src, gfloat *dst, gint dst_w,
+                            const RrResizeTaps *taps)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const gfloat *weight = taps->weight;
+    gint x, i;
+
+    for (x = 0; x < dst_w; ++x) {
+        const RrPixel32 *s = src + taps->first[x];
+        __m128 acc = _mm_setzero_ps();
+
+        for (i = taps->count[x]; i > 0; --i) {
+            /* spread the pixel's 4 channels out into 4 lanes */
+            __m128i p = _mm_cvtsi32_si128(*(s++));
+            p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(p),
+                                             _mm_set1_ps(*(weight++))));
+        }
+        _mm_storeu_ps(dst + x * 4, acc);
+    }
+}
+
+__attribute__((target("sse2")))
+static void resize_column_sse2(const gfloat *rows, gint dst_w, gint count,
+                               const gfloat *weight, RrPixel32 *dst)
+{
+    const __m128 bias = _mm_set1_ps(RR_RESIZE_BIAS);
+    gint x, i;
+
+    for (x = 0; x < dst_w; ++x) {
+        const gfloat *r = rows + x * 4;
+        __m128 acc = bias;
+        __m128i p;
+
+        for (i = 0; i < count; ++i, r += dst_w * 4)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(r),
+                                             _mm_set1_ps(weight[i])));
+
+        /* put the 4 lanes back together into one pixel */
+        p = _mm_cvttps_epi32(acc);
+        p = _mm_packs_epi32(p, p);
+        p = _mm_packus_epi16(p, p);
+        *(dst++) = _mm_cvtsi128_si32(p);
+    }
+}
+
+/* the weights are (portionX * portionY) >> 12 as integers, like in the plain
+   version.  the aspect ratio is kept, so one side can't be shrinking by much
+   while the other grows, and every product and sum stays below 2^24.  so they
+   are exact in floats, and so is the division once it is truncated */
+__attribute__((target("sse2")))
+static void resize_up_sse2(const RrPixel32 *src, gint src_w,
+                           RrPixel32 *dst, gint dst_w, gint dst_h,
+                           const RrResizeTaps *taps_x,
+                           const RrResizeTaps *taps_y)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const gulong *portion_x, *portion_y = taps_y->portion;
+    gint x, y, i, j;
+
+    for (y = 0; y < dst_h; ++y) {
+        portion_x = taps_x->portion;
+        for (x = 0; x < dst_w; ++x) {
+            __m128 acc = _mm_setzero_ps();
+            gulong sum = 0;
+            __m128i p;
+
+            for (j = 0; j < taps_y->count[y]; ++j) {
+                const RrPixel32 *s = src + (taps_y->first[y] + j) * src_w
+                    + taps_x->first[x];
+
+                for (i = 0; i < taps_x->count[x]; ++i) {
+                    gulong w = (portion_x[i] * portion_y[j]) >> 12;
+
+                    p = _mm_cvtsi32_si128(*(s++));
+                    p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero);
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(p),
+                                                     _mm_set1_ps(w)));
+                    sum += w;
+                }
+            }
+            portion_x += taps_x->count[x];
+
+            p = _mm_cvttps_epi32(_mm_div_ps(acc, _mm_set1_ps(sum)));
+            p = _mm_packs_epi32(p, p);
+            p = _mm_packus_epi16(p, p);
+            *(dst++) = _mm_cvtsi128_si32(p);
+        }
+        portion_y += taps_y->count[y];
+    }
+}
+
+#endif /* RR_SIMD_X86 */
+
+gboolean RrSimdGradientRow(RrGradientRowFunc *row)
+{
+#ifdef RR_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *row = gradient_row_avx2;
+        return TRUE;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *row = gradient_row_sse2;
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
+
+gboolean RrSimdResize(RrResizeRowFunc *row, RrResizeColumnFunc *column,
+                      RrResizeUpFunc *up)
+{
+#ifdef RR_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        *row = resize_row_sse2;
+        *column = resize_column_sse2;
+        *up = resize_up_sse2;
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
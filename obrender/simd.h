@@ -0,0 +1,80 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   simd.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __simd_h
+#define __simd_h
+
+#include "render.h"
+
+/*! Fills @len pixels with a gradient going from the @from color to the @to
+  color, pixel exact with stepping through it one pixel at a time */
+typedef void (*RrGradientRowFunc)(RrPixel32 *data, gint len,
+                                  const RrColor *from, const RrColor *to);
+
+/*! Finds the fastest SIMD version of the gradient kernel which the CPU is
+  able to run.
+  @return FALSE if there is none, and @row is left alone.
+*/
+gboolean RrSimdGradientRow(RrGradientRowFunc *row);
+
+/*! Added to each channel of a resized pixel before it is truncated, so that
+  rounding errors in the weights don't turn a 255 into a 254 */
+#define RR_RESIZE_BIAS (1.0f / 256.0f)
+
+/*! The source pixels which are averaged into each destination pixel, along one
+  side of an image being resized */
+typedef struct _RrResizeTaps RrResizeTaps;
+
+struct _RrResizeTaps
+{
+    /*! The first source pixel for each destination pixel */
+    gint *first;
+    /*! The number of source pixels for each destination pixel */
+    gint *count;
+    /*! How much each source pixel counts, in the same order.  They add up to
+      1 for each destination pixel */
+    gfloat *weight;
+    /*! How much of each source pixel is covered, in fixed point */
+    gulong *portion;
+};
+
+/*! Averages a row of source pixels horizontally, giving the 4 channels of
+  each destination pixel in @dst.  The channels are in the order of the bits
+  in an RrPixel32, from least significant to most */
+typedef void (*RrResizeRowFunc)(const RrPixel32 *src, gfloat *dst, gint dst_w,
+                                const RrResizeTaps *taps);
+/*! Averages @count rows made by an RrResizeRowFunc vertically, giving a row
+  of destination pixels in @dst */
+typedef void (*RrResizeColumnFunc)(const gfloat *rows, gint dst_w, gint count,
+                                   const gfloat *weight, RrPixel32 *dst);
+
+/*! Resizes a picture which is getting bigger along either side, averaging
+  the source pixels under each destination pixel all at once */
+typedef void (*RrResizeUpFunc)(const RrPixel32 *src, gint src_w,
+                               RrPixel32 *dst, gint dst_w, gint dst_h,
+                               const RrResizeTaps *taps_x,
+                               const RrResizeTaps *taps_y);
+
+/*! Finds the fastest SIMD versions of the image resizing kernels which the
+  CPU is able to run.
+  @return FALSE if there are none, and @row, @column and @up are left alone.
+*/
+gboolean RrSimdResize(RrResizeRowFunc *row, RrResizeColumnFunc *column,
+                      RrResizeUpFunc *up);
+
+#endif /* __simd_h */
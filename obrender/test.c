@@ -25,6 +25,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include "render.h"
+#include "gradient.h"
+#include "image.h"
 #include <glib.h>
 
 static gint x_error_handler(Display * disp, XErrorEvent * error)
@@ -39,7 +41,264 @@ Display *ob_display;
 gint ob_screen;
 Window ob_root;
 
-gint main()
+/*! Renders every gradient type at many sizes with both the SIMD and the
+  portable code, and reports any pixels that are different.
+  @return The number of gradients that were not the same.
+*/
+static gint compare_gradients(RrInstance *inst)
+{
+    static const RrSurfaceColorType grads[] = {
+        RR_SURFACE_SPLIT_VERTICAL,
+        RR_SURFACE_HORIZONTAL,
+        RR_SURFACE_MIRROR_HORIZONTAL,
+        RR_SURFACE_VERTICAL,
+        RR_SURFACE_DIAGONAL,
+        RR_SURFACE_CROSS_DIAGONAL,
+        RR_SURFACE_PYRAMID
+    };
+    static const gint widths[] = {
+        1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33, 100, 255, 256, 257, 1000, 3840
+    };
+    static const gint heights[] = {
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 17, 24, 100, 300
+    };
+    /* primary and secondary colors, including the steepest and flattest
+       slopes in each direction */
+    static const gint colors[][6] = {
+        {   0,   0,   0, 255, 255, 255 },
+        { 255, 255, 255,   0,   0,   0 },
+        { 255,   0,   0,   0,   0, 255 },
+        {  12, 200,   7, 250,   3, 128 },
+        {  40,  40,  40,  40,  40,  40 },
+        {   1,   2,   3, 254, 100,   0 }
+    };
+    guint g, c, wi, hi;
+    gint interlaced, bad = 0, total = 0;
+
+    if (!RrGradientSimd(TRUE)) {
+        printf("no SIMD gradient code for this CPU, nothing to compare\n");
+        return 0;
+    }
+
+    for (g = 0; g < G_N_ELEMENTS(grads); ++g)
+    for (c = 0; c < G_N_ELEMENTS(colors); ++c)
+    for (wi = 0; wi < G_N_ELEMENTS(widths); ++wi)
+    for (hi = 0; hi < G_N_ELEMENTS(heights); ++hi)
+    for (interlaced = 0; interlaced < 2; ++interlaced) {
+        RrAppearance *a;
+        RrPixel32 *plain;
+        gint w = widths[wi], h = heights[hi];
+
+        a = RrAppearanceNew(inst, 0);
+        a->surface.grad = grads[g];
+        a->surface.relief = RR_RELIEF_FLAT;
+        a->surface.primary = RrColorNew(inst, colors[c][0], colors[c][1],
+                                        colors[c][2]);
+        a->surface.secondary = RrColorNew(inst, colors[c][3], colors[c][4],
+                                          colors[c][5]);
+        a->surface.split_primary = RrColorNew(inst, colors[c][5],
+                                              colors[c][3], colors[c][4]);
+        a->surface.split_secondary = RrColorNew(inst, 9, 99, 199);
+        a->surface.interlaced = interlaced;
+        a->surface.interlace_color = RrColorNew(inst, 7, 7, 7);
+
+        plain = g_new(RrPixel32, w * h);
+        a->surface.pixel_data = plain;
+        RrGradientSimd(FALSE);
+        RrRender(a, w, h);
+
+        a->surface.pixel_data = g_new(RrPixel32, w * h);
+        RrGradientSimd(TRUE);
+        RrRender(a, w, h);
+
+        if (memcmp(plain, a->surface.pixel_data, w * h * sizeof(RrPixel32))) {
+            printf("gradient %d colors %u size %dx%d%s is different\n",
+                   grads[g], c, w, h, interlaced ? " interlaced" : "");
+            ++bad;
+        }
+        ++total;
+
+        g_free(plain);
+        RrAppearanceFree(a);
+    }
+
+    printf("%d of %d gradients were different\n", bad, total);
+    return bad;
+}
+
+/*! Makes a picture to resize, with noise in every channel so that every
+  source pixel makes a difference */
+static RrPixel32* resize_source(GRand *rand, gint w, gint h)
+{
+    RrPixel32 *p = g_new(RrPixel32, w * h);
+    gint i;
+
+    for (i = 0; i < w * h; ++i)
+        p[i] = g_rand_int(rand);
+    return p;
+}
+
+/*! Returns the largest difference between any channel of two pictures, and
+  counts the channels which are different at all */
+static gint resize_diff(const RrPixel32 *a, const RrPixel32 *b, gint n,
+                        gulong *channels)
+{
+    gint i, c, d, max = 0;
+
+    for (i = 0; i < n; ++i)
+        for (c = 0; c < 32; c += 8) {
+            d = ABS((gint)((a[i] >> c) & 0xFF) - (gint)((b[i] >> c) & 0xFF));
+            if (d) ++*channels;
+            max = MAX(max, d);
+        }
+    return max;
+}
+
+/*! Returns the smallest that the largest part of a source pixel under a
+  destination pixel can be, along one side, in 1/4096ths of a pixel */
+static gulong resize_min_portion(gint src, gint dst)
+{
+    const gulong ratio = ((gulong)src << 12) / dst;
+
+    /* when growing, a destination pixel covers at most 2 source pixels.
+       otherwise it covers at most 3, or a whole one */
+    return ratio < 4096 ? ratio / 2 : MIN(ratio / 3, 4096);
+}
+
+/*! Both scalers weigh each source pixel by (portionX * portionY) / 4096,
+  rounded down.  When growing a lot in both directions, these can all round
+  to 0, leaving nothing to average, and the scalers fail an assertion.
+  Returns FALSE for sizes where that could happen. */
+static gboolean resize_defined(gint sw, gint sh, gint dw, gint dh)
+{
+    return (resize_min_portion(sw, dw) * resize_min_portion(sh, dh)) >> 12;
+}
+
+/*! Resizes pictures between many sizes, both growing and shrinking, with
+  the SIMD and the portable code, and checks them against the original
+  scaler.  Each channel must be within 1 of what the original gave.  Sizes
+  which neither scaler can do (see resize_defined()) are skipped.
+  @return The number of resizes which were further off than that.
+*/
+static gint compare_resize(void)
+{
+    static const gint widths[] = {
+        1, 2, 3, 7, 16, 17, 48, 64, 100, 128, 255, 512
+    };
+    static const gint heights[] = {
+        1, 3, 16, 48, 129
+    };
+    GRand *rand = g_rand_new_with_seed(1);
+    gint simd, bad = 0, total = 0, skipped = 0, max = 0;
+    gulong channels = 0, off = 0;
+    guint swi, shi, dwi, dhi;
+
+    simd = RrImageResizeSimd(TRUE);
+    if (!simd)
+        printf("no SIMD resize code for this CPU, checking the portable "
+               "code only\n");
+
+    for (swi = 0; swi < G_N_ELEMENTS(widths); ++swi)
+    for (shi = 0; shi < G_N_ELEMENTS(heights); ++shi) {
+        const gint sw = widths[swi], sh = heights[shi];
+        RrPixel32 *src = resize_source(rand, sw, sh);
+
+        for (dwi = 0; dwi < G_N_ELEMENTS(widths); ++dwi)
+        for (dhi = 0; dhi < G_N_ELEMENTS(heights); ++dhi) {
+            const gint dw = widths[dwi], dh = heights[dhi];
+            RrPixel32 *ref, *out;
+            gint use_simd, d;
+
+            if (!resize_defined(sw, sh, dw, dh)) {
+                ++skipped;
+                continue;
+            }
+
+            ref = RrImageResizeReference(src, sw, sh, dw, dh);
+            for (use_simd = 0; use_simd <= simd; ++use_simd) {
+                RrImageResizeSimd(use_simd);
+                out = RrImageResize(src, sw, sh, dw, dh);
+                d = resize_diff(ref, out, dw * dh, &off);
+                if (d > 1) {
+                    printf("%dx%d -> %dx%d%s is off by %d\n", sw, sh, dw, dh,
+                           use_simd ? " (SIMD)" : "", d);
+                    ++bad;
+                }
+                max = MAX(max, d);
+                channels += dw * dh * 4;
+                ++total;
+                g_free(out);
+            }
+            g_free(ref);
+        }
+        g_free(src);
+    }
+    RrImageResizeSimd(TRUE);
+    g_rand_free(rand);
+
+    printf("%d of %d resizes were off by more than 1, %d sizes skipped\n",
+           bad, total, skipped);
+    printf("max difference %d, in %lu of %lu channels\n",
+           max, off, channels);
+    return bad;
+}
+
+/*! Times the original scaler and the new one, with and without SIMD, for
+  some common icon sizes */
+static void bench_resize(void)
+{
+    static const gint sizes[][4] = {
+        {  16,  16, 256, 256 },
+        { 256, 256,  16,  16 },
+        {  48,  48,  96,  96 },
+        { 128, 128,  48,  48 }
+    };
+    GRand *rand = g_rand_new_with_seed(1);
+    gboolean simd;
+    guint i;
+
+    simd = RrImageResizeSimd(TRUE);
+    printf("size,reference_us,portable_us%s\n", simd ? ",simd_us" : "");
+    for (i = 0; i < G_N_ELEMENTS(sizes); ++i) {
+        const gint sw = sizes[i][0], sh = sizes[i][1];
+        const gint dw = sizes[i][2], dh = sizes[i][3];
+        RrPixel32 *src = resize_source(rand, sw, sh);
+        gint64 start, ref, plain, vec = 0;
+        gint n;
+        /* enough runs to get past timer noise */
+        const gint runs = 200;
+
+        start = g_get_monotonic_time();
+        for (n = 0; n < runs; ++n)
+            g_free(RrImageResizeReference(src, sw, sh, dw, dh));
+        ref = g_get_monotonic_time() - start;
+
+        RrImageResizeSimd(FALSE);
+        start = g_get_monotonic_time();
+        for (n = 0; n < runs; ++n)
+            g_free(RrImageResize(src, sw, sh, dw, dh));
+        plain = g_get_monotonic_time() - start;
+
+        if (simd) {
+            RrImageResizeSimd(TRUE);
+            start = g_get_monotonic_time();
+            for (n = 0; n < runs; ++n)
+                g_free(RrImageResize(src, sw, sh, dw, dh));
+            vec = g_get_monotonic_time() - start;
+        }
+
+        printf("%dx%d->%dx%d,%.1f,%.1f", sw, sh, dw, dh,
+               (gdouble)ref / runs, (gdouble)plain / runs);
+        if (simd)
+            printf(",%.1f", (gdouble)vec / runs);
+        printf("\n");
+        g_free(src);
+    }
+    RrImageResizeSimd(TRUE);
+    g_rand_free(rand);
+}
+
+gint main(gint argc, gchar **argv)
 {
     Window win;
     RrInstance *inst;
@@ -49,10 +308,25 @@ gint main()
     XEvent report;
     gint h = 500, w = 500;
 
+    /* these don't need the X server */
+    if (argc > 1 && !strcmp(argv[1], "--compare-resize"))
+        return compare_resize() ? 1 : 0;
+    if (argc > 1 && !strcmp(argv[1], "--bench-resize")) {
+        bench_resize();
+        return 0;
+    }
+
     ob_display = XOpenDisplay(NULL);
     XSetErrorHandler(x_error_handler);
     ob_screen = DefaultScreen(ob_display);
     ob_root = RootWindow(ob_display, ob_screen);
+
+    if (argc > 1 && !strcmp(argv[1], "--compare")) {
+        inst = RrInstanceNew(ob_display, ob_screen);
+        done = compare_gradients(inst);
+        RrInstanceFree(inst);
+        return done ? 1 : 0;
+    }
     win =
         XCreateWindow(ob_display, RootWindow(ob_display, 0),
                       10, 10, w, h, 10,
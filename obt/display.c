@@ -22,9 +22,17 @@
 #include "obt/keyboard.h"
 #include "obt/xqueue.h"
 
+#ifdef USE_XCB
+#  include <X11/Xlib-xcb.h>
+#  include <xcb/xcb.h>
+#endif
+
 #ifdef HAVE_STRING_H
 #  include <string.h>
 #endif
+#ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+#endif
 #ifdef HAVE_FCNTL_H
 #  include <fcntl.h>
 #endif
@@ -39,6 +47,7 @@ extern void xqueue_destroy(void);
 Display* obt_display = NULL;
 
 gboolean obt_display_error_occured = FALSE;
+gulong   obt_display_round_trips = 0;
 
 gboolean obt_display_extension_xkb       = FALSE;
 gint     obt_display_extension_xkb_basep;
@@ -55,6 +64,24 @@ static gint xerror_handler(Display *d, XErrorEvent *e);
 
 static gboolean xerror_ignore = FALSE;
 
+struct _ObtXErrorTrap {
+    /*! The serial of the first request in the trap */
+    gulong first;
+    /*! The serial of the last request in the trap, if it has ended */
+    gulong last;
+    gboolean ended;
+    /*! The trap has ended and nothing wants to know if it failed, so it is
+      freed once the server has finished its requests */
+    gboolean forgotten;
+    gboolean failed;
+};
+
+/*! The traps that errors may still arrive for, oldest first */
+static GQueue traps = G_QUEUE_INIT;
+
+/*! Is a <= b, for request serials which may wrap around */
+#define SERIAL_LE(a, b) ((glong)((b) - (a)) >= 0)
+
 gboolean obt_display_open(const char *display_name)
 {
     gchar *n;
@@ -130,19 +157,45 @@ gboolean obt_display_open(const char *display_name)
 void obt_display_close(void)
 {
     obt_keyboard_shutdown();
+    obt_prop_shutdown();
     if (obt_display) {
         xqueue_destroy();
         XCloseDisplay(obt_display);
     }
+    while (traps.head)
+        g_slice_free(ObtXErrorTrap, g_queue_pop_head(&traps));
+}
+
+/*! Finds the traps, which are still waiting for errors, that hold the
+  request
+  @return TRUE if there were any
+*/
+static gboolean trap_request(gulong serial)
+{
+    GList *it;
+    gboolean found = FALSE;
+
+    for (it = traps.head; it; it = g_list_next(it)) {
+        ObtXErrorTrap *t = it->data;
+
+        if (SERIAL_LE(t->first, serial) &&
+            (!t->ended || SERIAL_LE(serial, t->last)))
+        {
+            t->failed = TRUE;
+            found = TRUE;
+        }
+    }
+    return found;
 }
 
 static gint xerror_handler(Display *d, XErrorEvent *e)
 {
+    const gboolean trapped = trap_request(e->serial);
 #ifdef DEBUG
     gchar errtxt[128];
 
     XGetErrorText(d, e->error_code, errtxt, 127);
-    if (!xerror_ignore) {
+    if (!xerror_ignore && !trapped) {
         if (e->error_code == BadWindow)
             /*g_debug(_("X Error: %s\n"), errtxt)*/;
         else
@@ -150,16 +203,128 @@ static gint xerror_handler(Display *d, XErrorEvent *e)
     } else
         g_debug("Ignoring XError code %d '%s'", e->error_code, errtxt);
 #else
-    (void)d; (void)e;
+    (void)d; (void)e; (void)trapped;
 #endif
 
     obt_display_error_occured = TRUE;
     return 0;
 }
 
-void obt_display_ignore_errors(gboolean ignore)
+void obt_display_sync(void)
 {
+    ++obt_display_round_trips;
     XSync(obt_display, FALSE);
+}
+
+void obt_display_get_map_states(const Window *wins, guint num,
+                                gint *map_states)
+{
+#ifdef USE_XCB
+    xcb_connection_t *c = XGetXCBConnection(obt_display);
+    xcb_get_window_attributes_cookie_t *cookies;
+    guint i;
+
+    /* send all of the requests before waiting for any of the replies */
+    cookies = g_new(xcb_get_window_attributes_cookie_t, num);
+    for (i = 0; i < num; ++i)
+        cookies[i] = xcb_get_window_attributes(c, wins[i]);
+    if (num) ++obt_display_round_trips;
+
+    for (i = 0; i < num; ++i) {
+        xcb_get_window_attributes_reply_t *r;
+        xcb_generic_error_t *e = NULL;
+
+        /* the xcb map states are the same as Xlib's */
+        if ((r = xcb_get_window_attributes_reply(c, cookies[i], &e))) {
+            map_states[i] = r->map_state;
+            free(r);
+        }
+        else
+            /* the window was destroyed */
+            map_states[i] = IsUnmapped;
+        free(e);
+    }
+    g_free(cookies);
+#else
+    XWindowAttributes attrib;
+    guint i;
+
+    for (i = 0; i < num; ++i) {
+        ++obt_display_round_trips;
+        if (XGetWindowAttributes(obt_display, wins[i], &attrib))
+            map_states[i] = attrib.map_state;
+        else
+            map_states[i] = IsUnmapped;
+    }
+#endif
+}
+
+void obt_display_ignore_errors(gboolean ignore)
+{
+    obt_display_sync();
     xerror_ignore = ignore;
     if (ignore) obt_display_error_occured = FALSE;
 }
+
+/*! Frees the forgotten traps whose requests the server has finished, so no
+  more errors can arrive for them */
+static void trap_prune(void)
+{
+    const gulong done = LastKnownRequestProcessed(obt_display);
+    GList *it, *next;
+
+    for (it = traps.head; it; it = next) {
+        ObtXErrorTrap *t = it->data;
+
+        next = g_list_next(it);
+        if (t->forgotten && SERIAL_LE(t->last, done)) {
+            g_slice_free(ObtXErrorTrap, t);
+            g_queue_delete_link(&traps, it);
+        }
+    }
+}
+
+ObtXErrorTrap* obt_display_trap_begin(void)
+{
+    ObtXErrorTrap *t;
+
+    trap_prune();
+
+    t = g_slice_new0(ObtXErrorTrap);
+    t->first = NextRequest(obt_display);
+    g_queue_push_tail(&traps, t);
+    return t;
+}
+
+static void trap_end(ObtXErrorTrap *t)
+{
+    g_assert(!t->ended);
+
+    /* if no requests were made, this is one before the first, and the trap
+       holds nothing */
+    t->last = NextRequest(obt_display) - 1;
+    t->ended = TRUE;
+}
+
+void obt_display_trap_end(ObtXErrorTrap *t)
+{
+    trap_end(t);
+    t->forgotten = TRUE;
+    trap_prune();
+}
+
+gboolean obt_display_trap_check(ObtXErrorTrap *t)
+{
+    gboolean failed;
+
+    trap_end(t);
+    /* wait for the server to get through the requests, if it hasn't yet.
+       errors for them will be handled before this returns */
+    if (!SERIAL_LE(t->last, LastKnownRequestProcessed(obt_display)))
+        obt_display_sync();
+
+    failed = t->failed;
+    g_queue_remove(&traps, t);
+    g_slice_free(ObtXErrorTrap, t);
+    return failed;
+}
@@ -42,6 +42,8 @@
 G_BEGIN_DECLS
 
 extern gboolean obt_display_error_occured;
+/*! The number of times that obt has waited for the server to reply */
+extern gulong   obt_display_round_trips;
 
 extern gboolean obt_display_extension_xkb;
 extern gint     obt_display_extension_xkb_basep;
@@ -63,6 +65,39 @@ void     obt_display_close(void);
 
 void     obt_display_ignore_errors(gboolean ignore);
 
+/*! Waits for the server to handle all the requests made so far, and reads
+  all of the events it has sent */
+void     obt_display_sync(void);
+
+/*! Finds the map state of a number of windows at once.  With XCB support
+  all of the requests are sent before waiting for any of the replies,
+  otherwise each window is asked about in turn.
+  @param map_states Set to the map_state which XGetWindowAttributes() would
+    give for each window, or IsUnmapped if the window does not exist.
+*/
+void     obt_display_get_map_states(const Window *wins, guint num,
+                                    gint *map_states);
+
+/*! A list of requests, in a row, which may cause X errors.  Errors from them
+  are not reported, and are recorded in the trap, so that it can be found
+  later if the requests failed. */
+typedef struct _ObtXErrorTrap ObtXErrorTrap;
+
+/*! Starts a trap for the requests made until it is ended.  Unlike
+  obt_display_ignore_errors(), this does not wait for the server to finish
+  the requests which came before. */
+ObtXErrorTrap* obt_display_trap_begin(void);
+/*! Ends the trap when it does not matter if its requests failed.  This does
+  not wait for the server, errors from the requests will be ignored whenever
+  they arrive. */
+void obt_display_trap_end(ObtXErrorTrap *trap);
+/*! Ends the trap and finds if any of its requests failed.  This only waits
+  for the server if it has not finished the requests yet, so no round trip
+  is made when the last request was one that had a reply.
+  @return TRUE if an error occured for any of the requests in the trap
+*/
+gboolean obt_display_trap_check(ObtXErrorTrap *trap);
+
 #define  obt_root(screen) (RootWindow(obt_display, screen))
 
 G_END_DECLS
@@ -21,6 +21,7 @@
 #define __obt_internal_h
 
 void obt_prop_startup(void);
+void obt_prop_shutdown(void);
 
 void obt_keyboard_shutdown(void);
 
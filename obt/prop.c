@@ -24,17 +24,58 @@
 #ifdef HAVE_STRING_H
 #  include <string.h>
 #endif
+#ifdef HAVE_STDLIB_H
+#  include <stdlib.h>
+#endif
+#ifdef USE_XCB
+#  include <X11/Xlib-xcb.h>
+#  include <xcb/xcb.h>
+#endif
+
+/* these are the sizes of the WM_HINTS and WM_NORMAL_HINTS properties, from
+   Xlib's Xatomtype.h */
+#define NUM_PROP_WM_HINTS_ELEMENTS 9
+#define NUM_PROP_SIZE_ELEMENTS 18
+#define OLD_NUM_PROP_SIZE_ELEMENTS 15
+
+/*! A property value read from a window by obt_prop_prefetch() */
+typedef struct _PrefetchProp {
+    Atom type; /*!< None if the property is not set on the window */
+    gint format;
+    gulong nitems;
+    /*! The value in the same layout as XGetWindowProperty() returns it */
+    guchar *data;
+} PrefetchProp;
+
+/*! The properties read from a window by obt_prop_prefetch() */
+typedef struct _PrefetchWindow {
+    Window win;
+    GHashTable *props; /*!< Maps the property's Atom to a PrefetchProp */
+} PrefetchWindow;
 
 Atom prop_atoms[OBT_PROP_NUM_ATOMS];
 gboolean prop_started = FALSE;
 
-#define CREATE_NAME(var, name) (prop_atoms[OBT_PROP_##var] = \
-                                XInternAtom((obt_display), (name), FALSE))
+/*! Maps a Window* to the PrefetchWindow for it */
+static GHashTable *prefetch_windows = NULL;
+
+static guint window_hash(Window *w) { return *w; }
+static gboolean window_comp(Window *w1, Window *w2) { return *w1 == *w2; }
+
+/* the atoms are all interned together at the end of obt_prop_startup, so
+   that it waits for the server once instead of once for each atom */
+#define CREATE_NAME(var, name) (names[num] = (name), \
+                                which[num++] = OBT_PROP_##var)
 #define CREATE(var) CREATE_NAME(var, #var)
 #define CREATE_(var) CREATE_NAME(var, "_" #var)
 
 void obt_prop_startup(void)
 {
+    gchar *names[OBT_PROP_NUM_ATOMS];
+    ObtPropAtom which[OBT_PROP_NUM_ATOMS];
+    Atom atoms[OBT_PROP_NUM_ATOMS];
+    gint num = 0, i;
+
     if (prop_started) return;
     prop_started = TRUE;
 
@@ -64,6 +105,9 @@ void obt_prop_startup(void)
     CREATE(WM_COMMAND);
     CREATE(WM_CLIENT_LEADER);
     CREATE(WM_TRANSIENT_FOR);
+    CREATE(WM_HINTS);
+    CREATE(WM_NORMAL_HINTS);
+    CREATE(WM_SIZE_HINTS);
     CREATE_(MOTIF_WM_HINTS);
     CREATE_(MOTIF_WM_INFO);
 
@@ -200,6 +244,31 @@ void obt_prop_startup(void)
     CREATE_(OB_APP_GROUP_NAME);
     CREATE_(OB_APP_GROUP_CLASS);
     CREATE_(OB_APP_TYPE);
+
+    g_assert(num <= OBT_PROP_NUM_ATOMS);
+    XInternAtoms(obt_display, names, num, FALSE, atoms);
+    for (i = 0; i < num; ++i)
+        prop_atoms[which[i]] = atoms[i];
+}
+
+static void prefetch_prop_free(PrefetchProp *p)
+{
+    free(p->data);
+    g_slice_free(PrefetchProp, p);
+}
+
+static void prefetch_window_free(PrefetchWindow *pw)
+{
+    g_hash_table_destroy(pw->props);
+    g_slice_free(PrefetchWindow, pw);
+}
+
+void obt_prop_shutdown(void)
+{
+    if (prefetch_windows) {
+        g_hash_table_destroy(prefetch_windows);
+        prefetch_windows = NULL;
+    }
 }
 
 Atom obt_prop_atom(ObtPropAtom a)
@@ -209,6 +278,185 @@ Atom obt_prop_atom(ObtPropAtom a)
     return prop_atoms[a];
 }
 
+#ifdef USE_XCB
+/*! Copies the value in an xcb reply into a new buffer laid out the same way
+  as XGetWindowProperty() returns it, so it can be freed with XFree() */
+static guchar* prefetch_copy_value(xcb_get_property_reply_t *r)
+{
+    const void *v = xcb_get_property_value(r);
+    guchar *data;
+    gsize size;
+    guint i;
+
+    /* Xlib returns 16 and 32 bit values as shorts and longs */
+    switch (r->format) {
+    case 8:  size = 1; break;
+    case 16: size = sizeof(gshort); break;
+    case 32: size = sizeof(glong); break;
+    default: return NULL;
+    }
+
+    /* Xlib adds a nul byte to the end of every value */
+    data = malloc(r->value_len * size + 1);
+    for (i = 0; i < r->value_len; ++i)
+        switch (r->format) {
+        case 8:
+            data[i] = ((const guint8*)v)[i];
+            break;
+        case 16:
+            ((gshort*)data)[i] = ((const gint16*)v)[i];
+            break;
+        case 32:
+            ((glong*)data)[i] = ((const guint32*)v)[i];
+            break;
+        }
+    data[r->value_len * size] = '\0';
+    return data;
+}
+#endif
+
+void obt_prop_prefetch(Window win, const Atom *props, guint num)
+{
+    obt_prop_prefetch_windows(&win, 1, props, num);
+}
+
+void obt_prop_prefetch_windows(const Window *wins, guint nwins,
+                               const Atom *props, guint nprops)
+{
+#ifdef USE_XCB
+    xcb_connection_t *c = XGetXCBConnection(obt_display);
+    xcb_get_property_cookie_t *cookies;
+    PrefetchWindow **pws;
+    Atom *atoms;
+    guint i, j, n;
+
+    if (!prefetch_windows)
+        prefetch_windows = g_hash_table_new_full(
+            (GHashFunc)window_hash, (GEqualFunc)window_comp,
+            NULL, (GDestroyNotify)prefetch_window_free);
+
+    cookies = g_new(xcb_get_property_cookie_t, nwins * nprops);
+    pws = g_new(PrefetchWindow*, nwins * nprops);
+    atoms = g_new(Atom, nwins * nprops);
+
+    /* send all of the requests before waiting for any of the replies */
+    n = 0;
+    for (i = 0; i < nwins; ++i) {
+        PrefetchWindow *pw;
+
+        /* add to the properties already prefetched for the window */
+        if (!(pw = g_hash_table_lookup(prefetch_windows, &wins[i]))) {
+            pw = g_slice_new(PrefetchWindow);
+            pw->win = wins[i];
+            pw->props = g_hash_table_new_full(
+                g_direct_hash, g_direct_equal, NULL,
+                (GDestroyNotify)prefetch_prop_free);
+            g_hash_table_replace(prefetch_windows, &pw->win, pw);
+        }
+
+        for (j = 0; j < nprops; ++j) {
+            /* don't ask again for one that was already prefetched */
+            if (g_hash_table_lookup(pw->props, GUINT_TO_POINTER(props[j])))
+                continue;
+
+            cookies[n] = xcb_get_property(c, FALSE, wins[i], props[j],
+                                          XCB_GET_PROPERTY_TYPE_ANY,
+                                          0, G_MAXUINT32 / 4);
+            pws[n] = pw;
+            atoms[n] = props[j];
+            ++n;
+        }
+    }
+
+    /* the replies all come back together */
+    if (n) ++obt_display_round_trips;
+
+    for (i = 0; i < n; ++i) {
+        xcb_get_property_reply_t *r;
+        PrefetchProp *p;
+
+        /* on an error (like the window being destroyed) the property is not
+           cached, and reading it later will go to the server and fail in the
+           usual way */
+        if (!(r = xcb_get_property_reply(c, cookies[i], NULL)))
+            continue;
+
+        p = g_slice_new(PrefetchProp);
+        p->type = r->type;
+        p->format = r->format;
+        p->nitems = r->value_len;
+        p->data = r->type != None ? prefetch_copy_value(r) : NULL;
+        if (r->type != None && !p->data)
+            prefetch_prop_free(p); /* a bad format, ask the server later */
+        else
+            g_hash_table_replace(pws[i]->props, GUINT_TO_POINTER(atoms[i]),
+                                 p);
+        free(r);
+    }
+    g_free(cookies);
+    g_free(pws);
+    g_free(atoms);
+#else
+    (void)wins; (void)nwins; (void)props; (void)nprops;
+#endif
+}
+
+void obt_prop_prefetch_end(Window win)
+{
+    if (prefetch_windows)
+        g_hash_table_remove(prefetch_windows, &win);
+}
+
+/*! Acts like XGetWindowProperty() (always reading from offset 0, without
+  deleting the property), but returns the prefetched value of the property
+  if there is one. */
+static gint get_property(Window win, Atom prop, glong len, Atom type,
+                         Atom *ret_type, gint *ret_size, gulong *ret_items,
+                         gulong *bytes_left, guchar **xdata)
+{
+    PrefetchWindow *pw;
+    PrefetchProp *p;
+    gulong n, item_size;
+
+    if (!(prefetch_windows &&
+          (pw = g_hash_table_lookup(prefetch_windows, &win)) &&
+          (p = g_hash_table_lookup(pw->props, GUINT_TO_POINTER(prop)))))
+    {
+        ++obt_display_round_trips;
+        return XGetWindowProperty(obt_display, win, prop, 0l, len,
+                                  FALSE, type, ret_type, ret_size,
+                                  ret_items, bytes_left, xdata);
+    }
+
+    *ret_type = p->type;
+    *ret_size = p->format;
+    *ret_items = 0;
+    *bytes_left = 0;
+    *xdata = NULL;
+    if (p->type == None)
+        return Success; /* the property does not exist */
+
+    item_size = p->format / 8;
+    if (type != AnyPropertyType && type != p->type) {
+        /* the value is not returned if the type doesn't match */
+        *bytes_left = p->nitems * item_size;
+        return Success;
+    }
+
+    /* len is in 32-bit units */
+    n = MIN(p->nitems, (gulong)MIN(len, G_MAXLONG / 4) * 4 / item_size);
+    *ret_items = n;
+    *bytes_left = (p->nitems - n) * item_size;
+    /* Xlib returns 16 and 32 bit values as shorts and longs */
+    if (p->format == 32) item_size = sizeof(glong);
+    if (p->format == 16) item_size = sizeof(gshort);
+    /* copy the value, with the nul byte after it */
+    *xdata = malloc(n * item_size + 1);
+    memcpy(*xdata, p->data, n * item_size);
+    (*xdata)[n * item_size] = '\0';
+    return Success;
+}
+
 static gboolean get_prealloc(Window win, Atom prop, Atom type, gint size,
                              guchar *data, gulong num)
 {
@@ -220,9 +468,8 @@ static gboolean get_prealloc(Window win, Atom prop, Atom type, gint size,
     gulong ret_items, bytes_left;
     glong num32 = 32 / size * num; /* num in 32-bit elements */
 
-    res = XGetWindowProperty(obt_display, win, prop, 0l, num32,
-                             FALSE, type, &ret_type, &ret_size,
-                             &ret_items, &bytes_left, &xdata);
+    res = get_property(win, prop, num32, type, &ret_type, &ret_size,
+                       &ret_items, &bytes_left, &xdata);
     if (res == Success && ret_items && xdata) {
         if (ret_size == size && ret_items >= num) {
             guint i;
@@ -257,9 +504,8 @@ static gboolean get_all(Window win, Atom prop, Atom type, gint size,
     gint ret_size;
     gulong ret_items, bytes_left;
 
-    res = XGetWindowProperty(obt_display, win, prop, 0l, G_MAXLONG,
-                             FALSE, type, &ret_type, &ret_size,
-                             &ret_items, &bytes_left, &xdata);
+    res = get_property(win, prop, G_MAXLONG, type, &ret_type, &ret_size,
+                       &ret_items, &bytes_left, &xdata);
     if (res == Success) {
         if (ret_size == size && ret_items > 0) {
             guint i;
@@ -299,7 +545,17 @@ static gboolean get_all(Window win, Atom prop, Atom type, gint size,
 static gboolean get_text_property(Window win, Atom prop,
                                   XTextProperty *tprop, ObtPropTextType type)
 {
-    if (!(XGetTextProperty(obt_display, win, tprop, prop) && tprop->nitems))
+    gint res;
+    gulong bytes_left;
+
+    /* the caller frees this, even if reading the property fails */
+    tprop->value = NULL;
+
+    /* this is what XGetTextProperty() does */
+    res = get_property(win, prop, 1000000l, AnyPropertyType,
+                       &tprop->encoding, &tprop->format, &tprop->nitems,
+                       &bytes_left, &tprop->value);
+    if (!(res == Success && tprop->encoding != None && tprop->nitems))
         return FALSE;
     if (!type)
         return TRUE; /* no type checking */
@@ -523,6 +779,87 @@ gboolean obt_prop_get_array_text(Window win, Atom prop,
     return ret;
 }
 
+XWMHints* obt_prop_get_wm_hints(Window win)
+{
+    XWMHints *hints = NULL;
+    glong *xdata = NULL;
+    Atom ret_type;
+    gint res, ret_size;
+    gulong ret_items, bytes_left;
+
+    /* this decodes the property the same way as XGetWMHints() */
+    res = get_property(win, OBT_PROP_ATOM(WM_HINTS),
+                       NUM_PROP_WM_HINTS_ELEMENTS, OBT_PROP_ATOM(WM_HINTS),
+                       &ret_type, &ret_size, &ret_items, &bytes_left,
+                       (guchar**)&xdata);
+    if (res == Success && ret_type == OBT_PROP_ATOM(WM_HINTS) &&
+        ret_size == 32 && ret_items >= NUM_PROP_WM_HINTS_ELEMENTS - 1)
+    {
+        hints = XAllocWMHints();
+        hints->flags = xdata[0];
+        hints->input = xdata[1] ? True : False;
+        hints->initial_state = (gint32)xdata[2];
+        hints->icon_pixmap = xdata[3];
+        hints->icon_window = xdata[4];
+        hints->icon_x = (gint32)xdata[5];
+        hints->icon_y = (gint32)xdata[6];
+        hints->icon_mask = xdata[7];
+        if (ret_items >= NUM_PROP_WM_HINTS_ELEMENTS)
+            hints->window_group = xdata[8];
+        else
+            hints->window_group = None;
+    }
+    if (xdata) XFree(xdata);
+    return hints;
+}
+
+gboolean obt_prop_get_wm_normal_hints(Window win, XSizeHints *hints,
+                                      glong *supplied)
+{
+    gboolean ret = FALSE;
+    glong *xdata = NULL;
+    Atom ret_type;
+    gint res, ret_size;
+    gulong ret_items, bytes_left;
+
+    /* this decodes the property the same way as XGetWMNormalHints() */
+    res = get_property(win, OBT_PROP_ATOM(WM_NORMAL_HINTS),
+                       NUM_PROP_SIZE_ELEMENTS, OBT_PROP_ATOM(WM_SIZE_HINTS),
+                       &ret_type, &ret_size, &ret_items, &bytes_left,
+                       (guchar**)&xdata);
+    if (res == Success && ret_type == OBT_PROP_ATOM(WM_SIZE_HINTS) &&
+        ret_size == 32 && ret_items >= OLD_NUM_PROP_SIZE_ELEMENTS)
+    {
+        hints->flags = xdata[0];
+        hints->x = (gint32)xdata[1];
+        hints->y = (gint32)xdata[2];
+        hints->width = (gint32)xdata[3];
+        hints->height = (gint32)xdata[4];
+        hints->min_width = (gint32)xdata[5];
+        hints->min_height = (gint32)xdata[6];
+        hints->max_width = (gint32)xdata[7];
+        hints->max_height = (gint32)xdata[8];
+        hints->width_inc = (gint32)xdata[9];
+        hints->height_inc = (gint32)xdata[10];
+        hints->min_aspect.x = (gint32)xdata[11];
+        hints->min_aspect.y = (gint32)xdata[12];
+        hints->max_aspect.x = (gint32)xdata[13];
+        hints->max_aspect.y = (gint32)xdata[14];
+
+        *supplied = (USPosition | USSize | PAllHints);
+        if (ret_items >= NUM_PROP_SIZE_ELEMENTS) {
+            hints->base_width = (gint32)xdata[15];
+            hints->base_height = (gint32)xdata[16];
+            hints->win_gravity = (gint32)xdata[17];
+            *supplied |= (PBaseSize | PWinGravity);
+        }
+        hints->flags &= *supplied;
+        ret = TRUE;
+    }
+    if (xdata) XFree(xdata);
+    return ret;
+}
+
 void obt_prop_set32(Window win, Atom prop, Atom type, gulong val)
 {
     XChangeProperty(obt_display, win, prop, type, 32, PropModeReplace,
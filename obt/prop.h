@@ -21,6 +21,7 @@
 #define __obt_prop_h
 
 #include <X11/Xlib.h>
+#include <X11/Xutil.h>
 #include <glib.h>
 
 G_BEGIN_DECLS
@@ -54,6 +55,9 @@ typedef enum {
     OBT_PROP_WM_COMMAND,
     OBT_PROP_WM_CLIENT_LEADER,
     OBT_PROP_WM_TRANSIENT_FOR,
+    OBT_PROP_WM_HINTS,
+    OBT_PROP_WM_NORMAL_HINTS,
+    OBT_PROP_WM_SIZE_HINTS,
     OBT_PROP_MOTIF_WM_HINTS,
     OBT_PROP_MOTIF_WM_INFO,
 
@@ -256,6 +260,37 @@ gboolean obt_prop_get_array_text(Window win, Atom prop,
                                  ObtPropTextType type,
                                  gchar ***ret);
 
+/*! Like XGetWMHints(), but uses the prefetched WM_HINTS if there is one.
+  The returned structure must be freed with XFree(). */
+XWMHints* obt_prop_get_wm_hints(Window win);
+/*! Like XGetWMNormalHints(), but uses the prefetched WM_NORMAL_HINTS if there
+  is one. */
+gboolean obt_prop_get_wm_normal_hints(Window win, XSizeHints *hints,
+                                      glong *supplied);
+
+/*! Requests a set of properties from a window all at once, and waits for all
+  of the replies together.  Until obt_prop_prefetch_end() is called for the
+  window, reading any of these properties from it with the obt_prop_get
+  functions uses the fetched values instead of asking the X server again.
+  This only batches the requests when Obt is built with XCB support, otherwise
+  it does nothing.
+  @param win The window to read the properties from.
+  @param props The atoms of the properties to read.
+  @param num The number of atoms in @props.
+*/
+void obt_prop_prefetch(Window win, const Atom *props, guint num);
+/*! Like obt_prop_prefetch(), but for a number of windows at once, so that
+  the requests for all of them are sent before waiting for any replies.
+  Properties which were already prefetched for a window are not asked for
+  again.  Call obt_prop_prefetch_end() for each of the windows when done.
+*/
+void obt_prop_prefetch_windows(const Window *wins, guint nwins,
+                               const Atom *props, guint nprops);
+/*! Forgets the prefetched properties of a window, so that they are read from
+  the X server again.  This should be called once the window is set up, as
+  the values are not updated when they change. */
+void obt_prop_prefetch_end(Window win);
+
 void obt_prop_set32(Window win, Atom prop, Atom type, gulong val);
 void obt_prop_set_array32(Window win, Atom prop, Atom type, gulong *val,
                           guint num);
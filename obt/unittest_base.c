@@ -7,14 +7,8 @@ guint g_test_failures_at_test_start = 0;
 const gchar* g_active_test_suite = NULL;
 const gchar* g_active_test_name = NULL;
 
-/* Add all test suites here. Keep them sorted. */
-extern void run_bsearch_unittest();
-
-gint main(gint argc, gchar **argv)
+gint unittest_result()
 {
-    /* Add all test suites here. Keep them sorted. */
-    run_bsearch_unittest();
-
     return g_test_failures == 0 ? 0 : 1;
 }
 
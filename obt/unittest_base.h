@@ -51,6 +51,9 @@ extern const gchar* g_active_test_name;
                ((actual) ? (actual) : NULL)); \
     }
 
+/* Returns the exit status for the test program, after running its suites. */
+gint unittest_result();
+
 void unittest_start_suite(const char* suite_name);
 void unittest_end_suite();
 
@@ -41,6 +41,10 @@ struct Callback {
     gpointer data;
 };
 
+struct _ObtXmlStream {
+    xmlParserCtxtPtr ctxt;
+};
+
 struct _ObtXmlInst {
     gint ref;
     ObtPaths *xdg_paths;
@@ -271,33 +275,88 @@ gboolean obt_xml_load_theme_file(ObtXmlInst *i,
 }
 
 
+/*! Checks the root node of a freshly parsed document, and closes the document
+  if it is not the one we were looking for */
+static gboolean load_root(ObtXmlInst *i, const gchar *root_node)
+{
+    if (!i->doc)
+        return FALSE;
+
+    i->root = xmlDocGetRootElement(i->doc);
+    if (!i->root) {
+        xmlFreeDoc(i->doc);
+        i->doc = NULL;
+        g_message("Given memory is an empty document");
+        return FALSE;
+    }
+    if (xmlStrcmp(i->root->name, (const xmlChar*)root_node)) {
+        xmlFreeDoc(i->doc);
+        i->doc = NULL;
+        i->root = NULL;
+        g_message("XML Document in given memory is of wrong "
+                  "type. Root node is not '%s'\n", root_node);
+        return FALSE;
+    }
+    return TRUE; /* ok ! */
+}
+
 gboolean obt_xml_load_mem(ObtXmlInst *i,
                           gpointer data, guint len, const gchar *root_node)
 {
-    gboolean r = FALSE;
+    gboolean r;
 
     g_assert(i->doc == NULL); /* another doc isn't open already? */
 
     xmlResetLastError();
 
     i->doc = xmlParseMemory(data, len);
-    if (i->doc) {
-        i->root = xmlDocGetRootElement(i->doc);
-        if (!i->root) {
-            xmlFreeDoc(i->doc);
-            i->doc = NULL;
-            g_message("Given memory is an empty document");
-        }
-        else if (xmlStrcmp(i->root->name, (const xmlChar*)root_node)) {
-            xmlFreeDoc(i->doc);
-            i->doc = NULL;
-            i->root = NULL;
-            g_message("XML Document in given memory is of wrong "
-                      "type. Root node is not '%s'\n", root_node);
-        }
-        else
-            r = TRUE; /* ok ! */
+    r = load_root(i, root_node);
+
+    obt_xml_save_last_error(i);
+
+    return r;
+}
+
+ObtXmlStream* obt_xml_stream_new(void)
+{
+    ObtXmlStream *s = g_slice_new(ObtXmlStream);
+    s->ctxt = xmlCreatePushParserCtxt(NULL, NULL, NULL, 0, NULL);
+    return s;
+}
+
+void obt_xml_stream_free(ObtXmlStream *s)
+{
+    if (s) {
+        if (s->ctxt->myDoc)
+            xmlFreeDoc(s->ctxt->myDoc);
+        xmlFreeParserCtxt(s->ctxt);
+        g_slice_free(ObtXmlStream, s);
     }
+}
+
+gboolean obt_xml_stream_push(ObtXmlStream *s, gpointer data, guint len)
+{
+    return xmlParseChunk(s->ctxt, data, len, FALSE) == XML_ERR_OK;
+}
+
+gboolean obt_xml_load_stream(ObtXmlInst *i,
+                             ObtXmlStream *s, const gchar *root_node)
+{
+    gboolean r;
+
+    g_assert(i->doc == NULL); /* another doc isn't open already? */
+
+    xmlResetLastError();
+
+    xmlParseChunk(s->ctxt, NULL, 0, TRUE);
+    if (s->ctxt->wellFormed)
+        i->doc = s->ctxt->myDoc;
+    else if (s->ctxt->myDoc)
+        xmlFreeDoc(s->ctxt->myDoc);
+    s->ctxt->myDoc = NULL;
+    obt_xml_stream_free(s);
+
+    r = load_root(i, root_node);
 
     obt_xml_save_last_error(i);
 
@@ -25,6 +25,7 @@
 G_BEGIN_DECLS
 
 typedef struct _ObtXmlInst ObtXmlInst;
+typedef struct _ObtXmlStream ObtXmlStream;
 
 typedef void (*ObtXmlCallback)(xmlNodePtr node, gpointer data);
 
@@ -51,6 +52,21 @@ gboolean obt_xml_load_theme_file(ObtXmlInst *inst,
 gboolean obt_xml_load_mem(ObtXmlInst *inst,
                           gpointer data, guint len, const gchar *root_node);
 
+/*! Starts parsing a document which is read in pieces, such as the output of
+  a running program */
+ObtXmlStream* obt_xml_stream_new(void);
+/*! Parses the next piece of the document.
+  @return FALSE if the document is malformed, and the rest of it can be
+    ignored.
+*/
+gboolean obt_xml_stream_push(ObtXmlStream *s, gpointer data, guint len);
+/*! Frees a stream without loading its document */
+void obt_xml_stream_free(ObtXmlStream *s);
+/*! Finishes parsing a stream's document and loads it, like obt_xml_load_mem.
+  The stream is freed. */
+gboolean obt_xml_load_stream(ObtXmlInst *inst,
+                             ObtXmlStream *s, const gchar *root_node);
+
 /* Returns true if an error is present. */
 gboolean obt_xml_last_error(ObtXmlInst *inst);
 gchar* obt_xml_last_error_file(ObtXmlInst *inst);
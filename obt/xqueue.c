@@ -21,28 +21,183 @@
 
 #define MINSZ 16
 
-static XEvent *q = NULL;
+/*! A place in the queue.  An event which is taken out of the middle of the
+  queue is only marked as gone, so that nothing has to be moved to fill the
+  space, and it is skipped over until it reaches the front. */
+typedef struct _ObtXQueueSlot {
+    XEvent e;
+    gboolean gone;
+} ObtXQueueSlot;
+
+static ObtXQueueSlot *q = NULL;
 static gulong qsz = 0;
 static gulong qstart; /* the first event in the queue */
 static gulong qend; /* the last event in the queue */
-static gulong qnum = 0;
+static gulong qlen = 0; /* the number of slots in use, including gone ones */
+static gulong qnum = 0; /* the number of events in the queue */
+/*! Every event gets the next number as it goes into the queue.  This is the
+  number of the event in the first slot */
+static gulong qseq = 0;
+
+/*! How events are ordered when they are handled from the main loop */
+typedef enum {
+    /*! Input from the user, which is handled before anything else */
+    CLASS_INPUT,
+    /*! Everything that changes the state of windows, handled in order */
+    CLASS_STRUCTURAL,
+    /*! Redrawing, which can wait until the structural events are done */
+    CLASS_COSMETIC,
+    NUM_CLASSES
+} EventClass;
+
+/*! The most events that are handled ahead of a waiting cosmetic event,
+  before the cosmetic event gets a turn */
+#define COSMETIC_MAX_PASSED 64
+/*! How many events are handled from the main loop before checking the X
+  server again for new user input */
+#define INPUT_CHECK_EVERY 16
+
+/*! The number of events in the queue in each class */
+static gulong qclass[NUM_CLASSES];
+/*! The numbers of the events in each class, oldest first, so the next one to
+  handle can be found without searching the queue.  Events which were taken
+  out of the queue some other way are left in here, and skipped when they
+  reach the front */
+static GQueue qclass_seqs[NUM_CLASSES];
+/*! The numbers of the barrier events (see is_barrier()), oldest first, in the
+  same way as qclass_seqs */
+static GQueue qbarrier_seqs;
+
+/*! The number of PropertyNotify events in the queue for a window and atom */
+typedef struct _ObtXQueueProp {
+    Window window;
+    Atom atom;
+    guint num;
+} ObtXQueueProp;
+
+/*! Holds an ObtXQueueProp for each window and atom with a PropertyNotify in
+  the queue, with itself as the key */
+static GHashTable *props = NULL;
+
+static guint prop_hash(const ObtXQueueProp *p)
+{
+    return (guint)p->window * 31 + (guint)p->atom;
+}
+
+static gboolean prop_equal(const ObtXQueueProp *p1, const ObtXQueueProp *p2)
+{
+    return p1->window == p2->window && p1->atom == p2->atom;
+}
+
+static void prop_free(ObtXQueueProp *p)
+{
+    g_slice_free(ObtXQueueProp, p);
+}
+
+/*! Counts a PropertyNotify event going into the queue */
+static void prop_push(const XEvent *e)
+{
+    ObtXQueueProp key, *p;
+
+    key.window = e->xproperty.window;
+    key.atom = e->xproperty.atom;
+    if ((p = g_hash_table_lookup(props, &key)))
+        ++p->num;
+    else {
+        p = g_slice_new(ObtXQueueProp);
+        *p = key;
+        p->num = 1;
+        g_hash_table_insert(props, p, p);
+    }
+}
+
+/*! Counts a PropertyNotify event coming out of the queue */
+static void prop_pop(const XEvent *e)
+{
+    ObtXQueueProp key, *p;
+
+    key.window = e->xproperty.window;
+    key.atom = e->xproperty.atom;
+    p = g_hash_table_lookup(props, &key);
+    g_assert(p != NULL);
+    if (--p->num == 0)
+        g_hash_table_remove(props, p);
+}
+
+static gboolean is_root(Window w)
+{
+    gint i;
+
+    for (i = 0; i < ScreenCount(obt_display); ++i)
+        if (w == RootWindow(obt_display, i))
+            return TRUE;
+    return FALSE;
+}
+
+static EventClass event_class(const XEvent *e)
+{
+    switch (e->type) {
+    case KeyPress:
+    case KeyRelease:
+    case ButtonPress:
+    case ButtonRelease:
+    case MotionNotify:
+        return CLASS_INPUT;
+    case ConfigureNotify:
+        /* the root window changing size is the screen changing size */
+        if (is_root(e->xconfigure.window))
+            return CLASS_STRUCTURAL;
+        return CLASS_COSMETIC;
+    case Expose:
+    case GraphicsExpose:
+    case NoExpose:
+        return CLASS_COSMETIC;
+    default:
+        /* PropertyNotify is here as a client's properties, like its size
+           hints, change what its other requests do */
+        return CLASS_STRUCTURAL;
+    }
+}
+
+/*! Returns TRUE for events which change what user input does, so that input
+  which came after them is not handled before them.  Focus moving, the
+  pointer moving to another window, the keyboard map changing, and windows
+  appearing or going away all change which client or binding the input goes
+  to. */
+static gboolean is_barrier(const XEvent *e)
+{
+    switch (e->type) {
+    case FocusIn:
+    case FocusOut:
+    case EnterNotify:
+    case LeaveNotify:
+    case MappingNotify:
+    case MapRequest:
+    case MapNotify:
+    case UnmapNotify:
+    case DestroyNotify:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
 
 static inline void shrink(void) {
-    if (qsz > MINSZ && qnum < qsz / 4) {
+    if (qsz > MINSZ && qlen < qsz / 4) {
         const gulong newsz = qsz/2;
         gulong i;
 
-        if (qnum == 0) {
+        if (qlen == 0) {
             qstart = 0;
             qend = -1;
         }
 
         /* all in the shinking part, move it to pos 0 */
         else if (qstart >= newsz && qend >= newsz) {
-            for (i = 0; i < qnum; ++i)
+            for (i = 0; i < qlen; ++i)
                 q[i] = q[qstart+i];
             qstart = 0;
-            qend = qnum - 1;
+            qend = qlen - 1;
         }
 
         /* it wraps around to 0 right now, move the part between newsz and qsz
@@ -62,19 +217,19 @@ static inline void shrink(void) {
             qend = n - 1;
         }
 
-        q = g_renew(XEvent, q, newsz);
+        q = g_renew(ObtXQueueSlot, q, newsz);
         qsz = newsz;
     }
 }
 
 static inline void grow(void) {
-    if (qnum == qsz) {
+    if (qlen == qsz) {
         const gulong newsz = qsz*2;
         gulong i;
  
-        q = g_renew(XEvent, q, newsz);
+        q = g_renew(ObtXQueueSlot, q, newsz);
 
-        g_assert(qnum > 0);
+        g_assert(qlen > 0);
 
         if (qend < qstart) { /* it wraps around to 0 right now */
             for (i = 0; i <= qend; ++i)
@@ -86,6 +241,34 @@ static inline void grow(void) {
     }
 }
 
+/*! Returns the slot holding the event with the number @seq */
+static inline gulong seq_slot(gulong seq)
+{
+    return (qstart + (seq - qseq)) % qsz;
+}
+
+/*! Returns TRUE if the event with the number @seq is still in the queue */
+static inline gboolean seq_live(gulong seq)
+{
+    return seq - qseq < qlen && !q[seq_slot(seq)].gone;
+}
+
+/*! Finds the oldest event in @seqs that is still in the queue, and forgets
+  the ones in front of it that are not */
+static gboolean seqs_head(GQueue *seqs, gulong *seq)
+{
+    while (!g_queue_is_empty(seqs)) {
+        const gulong s = GPOINTER_TO_SIZE(g_queue_peek_head(seqs));
+
+        if (seq_live(s)) {
+            *seq = s;
+            return TRUE;
+        }
+        g_queue_pop_head(seqs);
+    }
+    return FALSE;
+}
+
 /* Grab all pending X events */
 static gboolean read_events(gboolean block)
 {
@@ -103,8 +286,18 @@ static gboolean read_events(gboolean block)
         grow(); /* make sure there is room */
 
         ++qnum;
+        ++qlen;
         qend = (qend + 1) % qsz; /* move the end */
-        q[qend] = e; /* stick the event at the end */
+        q[qend].e = e; /* stick the event at the end */
+        q[qend].gone = FALSE;
+        ++qclass[event_class(&e)];
+        g_queue_push_tail(&qclass_seqs[event_class(&e)],
+                          GSIZE_TO_POINTER(qseq + qlen - 1));
+        if (is_barrier(&e))
+            g_queue_push_tail(&qbarrier_seqs,
+                              GSIZE_TO_POINTER(qseq + qlen - 1));
+        if (e.type == PropertyNotify)
+            prop_push(&e);
 
         --n;
         sth = TRUE;
@@ -115,62 +308,69 @@ static gboolean read_events(gboolean block)
 
 static void pop(const gulong p)
 {
+    const EventClass c = event_class(&q[p].e);
+    gulong seq;
+
+    --qclass[c];
+    if (q[p].e.type == PropertyNotify)
+        prop_pop(&q[p].e);
+
     /* remove the event */
     --qnum;
-    if (qnum == 0) {
+    q[p].gone = TRUE;
+
+    /* move the start past it, and any others that are gone behind it */
+    while (qlen && q[qstart].gone) {
+        qstart = (qstart + 1) % qsz;
+        ++qseq;
+        --qlen;
+    }
+    if (qlen == 0) {
         qstart = 0;
         qend = -1;
     }
-    else if (p == qstart)
-        qstart = (qstart + 1) % qsz;
-    else {
-        gulong pi;
-
-        /* is it cheaper to move the start or the end ? */
-        if ((p >= qstart && p < qstart + qnum/2) ||
-            (p < qstart && p < (qstart + qnum/2) % qsz))
-        {
-            /* move the start */
-            pi = p;
-            while (pi != qstart) {
-                const gulong pi_next = (pi == 0 ? qsz-1 : pi-1);
-
-                q[pi] = q[pi_next];
-                pi = pi_next;
-            }
-            qstart = (qstart + 1) % qsz;
-        }
-        else {
-            /* move the end */
-            pi = p;
-            while (pi != qend) {
-                const gulong pi_next = (pi + 1) % qsz;
-
-                q[pi] = q[pi_next];
-                pi = pi_next;
-            }
-            qend = (qend == 0 ? qsz-1 : qend-1);
-        }
-    }
+
+    /* forget the gone events at the front of the lists, so that events
+       which are not taken out by next_scheduled() don't pile up in them */
+    seqs_head(&qclass_seqs[c], &seq);
+    seqs_head(&qbarrier_seqs, &seq);
 
     shrink(); /* shrink the q if too little in it */
 }
 
 void xqueue_init(void)
 {
+    EventClass c;
+
     if (q != NULL) return;
     qsz = MINSZ;
-    q = g_new(XEvent, qsz);
+    q = g_new(ObtXQueueSlot, qsz);
     qstart = 0;
     qend = -1;
+    for (c = 0; c < NUM_CLASSES; ++c)
+        g_queue_init(&qclass_seqs[c]);
+    g_queue_init(&qbarrier_seqs);
+    props = g_hash_table_new_full((GHashFunc)prop_hash,
+                                  (GEqualFunc)prop_equal,
+                                  (GDestroyNotify)prop_free, NULL);
 }
 
 void xqueue_destroy(void)
 {
+    EventClass c;
+
     if (q == NULL) return;
     g_free(q);
     q = NULL;
     qsz = 0;
+    qnum = qlen = 0;
+    for (c = 0; c < NUM_CLASSES; ++c) {
+        qclass[c] = 0;
+        g_queue_clear(&qclass_seqs[c]);
+    }
+    g_queue_clear(&qbarrier_seqs);
+    g_hash_table_destroy(props);
+    props = NULL;
 }
 
 gboolean xqueue_match_window(XEvent *e, gpointer data)
@@ -204,7 +404,7 @@ gboolean xqueue_peek(XEvent *event_return)
 
     if (!qnum) read_events(TRUE);
     if (!qnum) return FALSE;
-    *event_return = q[qstart]; /* get the head */
+    *event_return = q[qstart].e; /* get the head */
     return TRUE;
 }
 
@@ -215,7 +415,7 @@ gboolean xqueue_peek_local(XEvent *event_return)
 
     if (!qnum) read_events(FALSE);
     if (!qnum) return FALSE;
-    *event_return = q[qstart]; /* get the head */
+    *event_return = q[qstart].e; /* get the head */
     return TRUE;
 }
 
@@ -226,7 +426,7 @@ gboolean xqueue_next(XEvent *event_return)
 
     if (!qnum) read_events(TRUE);
     if (qnum) {
-        *event_return = q[qstart]; /* get the head */
+        *event_return = q[qstart].e; /* get the head */
         pop(qstart);
         return TRUE;
     }
@@ -241,7 +441,7 @@ gboolean xqueue_next_local(XEvent *event_return)
 
     if (!qnum) read_events(FALSE);
     if (qnum) {
-        *event_return = q[qstart]; /* get the head */
+        *event_return = q[qstart].e; /* get the head */
         pop(qstart);
         return TRUE;
     }
@@ -258,9 +458,9 @@ gboolean xqueue_exists(xqueue_match_func match, gpointer data)
 
     checked = 0;
     while (TRUE) {
-        for (i = checked; i < qnum; ++i, ++checked) {
+        for (i = checked; i < qlen; ++i, ++checked) {
             const gulong p = (qstart + i) % qsz;
-            if (match(&q[p], data))
+            if (!q[p].gone && match(&q[p].e, data))
                 return TRUE;
         }
         if (!read_events(TRUE)) break; /* error */
@@ -277,9 +477,9 @@ gboolean xqueue_exists_local(xqueue_match_func match, gpointer data)
 
     checked = 0;
     while (TRUE) {
-        for (i = checked; i < qnum; ++i, ++checked) {
+        for (i = checked; i < qlen; ++i, ++checked) {
             const gulong p = (qstart + i) % qsz;
-            if (match(&q[p], data))
+            if (!q[p].gone && match(&q[p].e, data))
                 return TRUE;
         }
         if (!read_events(FALSE)) break;
@@ -298,10 +498,10 @@ gboolean xqueue_remove_local(XEvent *event_return,
 
     checked = 0;
     while (TRUE) {
-        for (i = checked; i < qnum; ++i, ++checked) {
+        for (i = checked; i < qlen; ++i, ++checked) {
             const gulong p = (qstart + i) % qsz;
-            if (match(&q[p], data)) {
-                *event_return = q[p];
+            if (!q[p].gone && match(&q[p].e, data)) {
+                *event_return = q[p].e;
                 pop(p);
                 return TRUE;
             }
@@ -311,6 +511,25 @@ gboolean xqueue_remove_local(XEvent *event_return,
     return FALSE;
 }
 
+gboolean xqueue_pending_property(Window window, const Atom *atoms, guint n)
+{
+    ObtXQueueProp key;
+    guint i;
+
+    g_return_val_if_fail(q != NULL, FALSE);
+
+    /* get everything that is waiting, like xqueue_exists_local does */
+    while (read_events(FALSE));
+
+    key.window = window;
+    for (i = 0; i < n; ++i) {
+        key.atom = atoms[i];
+        if (g_hash_table_lookup(props, &key))
+            return TRUE;
+    }
+    return FALSE;
+}
+
 gboolean xqueue_pending_local(void)
 {
     g_return_val_if_fail(q != NULL, FALSE);
@@ -327,13 +546,72 @@ typedef struct _ObtXQueueCB {
 static ObtXQueueCB *callbacks = NULL;
 static guint n_callbacks = 0;
 
+/*! Takes the event with the number @seq out of the queue */
+static void take(gulong seq, XEvent *event_return)
+{
+    const gulong p = seq_slot(seq);
+
+    *event_return = q[p].e;
+    pop(p);
+}
+
+/*! Takes the next event to handle from the main loop out of the queue.  This
+  is the oldest user input, so that it doesn't wait behind a storm of events
+  from clients, unless there is an older barrier event (see is_barrier()) in
+  the way.  Otherwise it is the oldest structural event, and cosmetic
+  events wait until there are none, or they have been passed over too many
+  times, by input or structural events.  Events in the same class are always
+  handled in order. */
+static gboolean next_scheduled(XEvent *event_return)
+{
+    static guint cosmetic_passed = 0;
+    EventClass want;
+    gulong seq, barrier, cosmetic;
+    gboolean waiting;
+
+    if (!qnum) return FALSE;
+
+    waiting = seqs_head(&qclass_seqs[CLASS_COSMETIC], &cosmetic);
+
+    if (waiting && cosmetic_passed >= COSMETIC_MAX_PASSED)
+        want = CLASS_COSMETIC;
+    else if (seqs_head(&qclass_seqs[CLASS_INPUT], &seq) &&
+             (!seqs_head(&qbarrier_seqs, &barrier) || seq < barrier))
+        want = CLASS_INPUT;
+    else if (waiting && !qclass[CLASS_STRUCTURAL])
+        want = CLASS_COSMETIC;
+    else
+        /* there is always a structural event here, as input is only held
+           back by a barrier, which is one */
+        want = CLASS_STRUCTURAL;
+
+    if (!seqs_head(&qclass_seqs[want], &seq))
+        g_assert_not_reached();
+
+    if (want == CLASS_COSMETIC)
+        cosmetic_passed = 0;
+    else if (waiting && seq > cosmetic)
+        ++cosmetic_passed;
+
+    take(seq, event_return);
+    return TRUE;
+}
+
 static gboolean event_read(GSource *source, GSourceFunc callback,
                            gpointer data)
 {
     XEvent ev;
+    guint n = 0;
 
-    while (xqueue_next_local(&ev)) {
+    while (TRUE) {
         guint i;
+
+        /* look for new user input that should go ahead of what is here */
+        if (!qnum || n++ % INPUT_CHECK_EVERY == 0)
+            while (read_events(FALSE));
+
+        if (!next_scheduled(&ev)) break;
+
         for (i = 0; i < n_callbacks; ++i)
             callbacks[i].func(&ev, callbacks[i].data);
     }
@@ -87,6 +87,13 @@ gboolean xqueue_exists_local(xqueue_match_func match, gpointer data);
 gboolean xqueue_remove_local(XEvent *event_return,
                              xqueue_match_func match, gpointer data);
 
+/*! Returns TRUE if there is a PropertyNotify event in the current event queue
+  for the window and any of the @n atoms in @atoms.  Like
+  xqueue_exists_local(), it first reads any events waiting from the server.
+  The queue keeps a count of these events, so this does not search through
+  it. */
+gboolean xqueue_pending_property(Window window, const Atom *atoms, guint n);
+
 typedef void (*ObtXQueueFunc)(const XEvent *ev, gpointer data);
 
 /*! Begin listening for X events in the default GMainContext, and feed them
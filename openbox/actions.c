@@ -26,6 +26,7 @@
 #include "focus.h"
 #include "openbox.h"
 #include "debug.h"
+#include "stats.h"
 
 #include "actions/all.h"
 
@@ -373,7 +374,12 @@ void actions_run_acts(GSList *acts,
 
         /* fire the action's run function with this data */
         if (ok) {
-            if (!act->def->run(&data, act->options)) {
+            const gint64 stats_time = stats_start();
+            gboolean stop;
+
+            stop = act->def->run(&data, act->options);
+            stats_action(act->def->name, stats_time);
+            if (!stop) {
                 if (actions_act_is_interactive(act)) {
                     actions_interactive_end_act();
                 }
@@ -30,6 +30,7 @@
 #include "event.h"
 #include "grab.h"
 #include "prompt.h"
+#include "resist.h"
 #include "focus.h"
 #include "focus_cycle.h"
 #include "stacking.h"
@@ -39,6 +40,8 @@
 #include "menuframe.h"
 #include "keyboard.h"
 #include "mouse.h"
+#include "stats.h"
+#include "trace.h"
 #include "obrender/render.h"
 #include "gettext.h"
 #include "obt/display.h"
@@ -74,6 +77,18 @@ GList          *client_list             = NULL;
 static GSList  *client_destroy_notifies = NULL;
 static RrImage *client_default_icon     = NULL;
 
+/*! The _NET_CLIENT_LIST property is written from a callback in the main loop,
+  so that when many windows are managed or unmanaged at once it is only set
+  once.  It has the same priority as the X events, so a steady stream of
+  events can't hold it back past the end of the events waiting now */
+static guint    client_list_idle_id     = 0;
+/*! The window ids last written to _NET_CLIENT_LIST */
+static Window  *client_list_windows     = NULL;
+static guint    client_list_num         = 0;
+static guint    client_list_size        = 0;
+static gboolean client_list_valid       = FALSE;
+
+static void client_flush_list(void);
 static void client_get_all(ObClient *self, gboolean real);
 static void client_get_startup_id(ObClient *self);
 static void client_get_session_ids(ObClient *self);
@@ -132,6 +147,18 @@ void client_shutdown(gboolean reconfig)
     client_default_icon = NULL;
 
     if (reconfig) return;
+
+    /* write out the final list of clients */
+    if (client_list_idle_id) {
+        g_source_remove(client_list_idle_id);
+        client_list_idle_id = 0;
+        client_flush_list();
+    }
+
+    g_free(client_list_windows);
+    client_list_windows = NULL;
+    client_list_num = client_list_size = 0;
+    client_list_valid = FALSE;
 }
 
 static void client_call_notifies(ObClient *self, GSList *list)
@@ -182,26 +209,51 @@ void client_remove_destroy_notify_data(ObClientCallback func, gpointer data)
     }
 }
 
-void client_set_list(void)
+static void client_flush_list(void)
 {
-    Window *windows, *win_it;
     GList *it;
-    guint size = g_list_length(client_list);
-
-    /* create an array of the window ids */
-    if (size > 0) {
-        windows = g_new(Window, size);
-        win_it = windows;
-        for (it = client_list; it; it = g_list_next(it), ++win_it)
-            *win_it = ((ObClient*)it->data)->window;
-    } else
-        windows = NULL;
+    guint i, num = g_list_length(client_list);
+    gboolean changed;
+
+    /* nothing needs to be written if the list is the same as the last one */
+    changed = !client_list_valid || num != client_list_num;
+
+    if (num > client_list_size) {
+        client_list_size = MAX(num, client_list_size * 2);
+        client_list_windows = g_renew(Window, client_list_windows,
+                                      client_list_size);
+    }
+
+    /* fill in the array of the window ids */
+    for (i = 0, it = client_list; it; ++i, it = g_list_next(it)) {
+        Window w = ((ObClient*)it->data)->window;
+        if (changed || client_list_windows[i] != w) {
+            client_list_windows[i] = w;
+            changed = TRUE;
+        }
+    }
+    client_list_num = num;
 
-    OBT_PROP_SETA32(obt_root(ob_screen), NET_CLIENT_LIST, WINDOW,
-                    (gulong*)windows, size);
+    if (changed) {
+        OBT_PROP_SETA32(obt_root(ob_screen), NET_CLIENT_LIST, WINDOW,
+                        (gulong*)client_list_windows, num);
+        client_list_valid = TRUE;
+    }
+}
 
-    if (windows)
-        g_free(windows);
+static gboolean client_set_list_idle(gpointer data)
+{
+    client_list_idle_id = 0;
+    client_flush_list();
+    return FALSE; /* don't repeat */
+}
+
+void client_set_list(void)
+{
+    if (!client_list_idle_id)
+        client_list_idle_id = g_idle_add_full(G_PRIORITY_DEFAULT,
+                                              client_set_list_idle,
+                                              NULL, NULL);
 
     stacking_set_list();
 }
@@ -219,6 +271,8 @@ void client_manage(Window window, ObPrompt *prompt)
     guint32 user_time;
     gboolean obplaced;
     gulong ignore_start = FALSE;
+    const gint64 stats_time = stats_start();
+    const gint64 trace_time = trace_start();
 
     ob_debug("Managing window: 0x%lx", window);
 
@@ -527,8 +581,13 @@ void client_manage(Window window, ObPrompt *prompt)
     window_add(&self->window, CLIENT_AS_WINDOW(self));
 
     /* this has to happen after we're in the client_list */
-    if (STRUT_EXISTS(self->strut))
-        screen_update_areas();
+    if (STRUT_EXISTS(self->strut)) {
+        StrutPartial none;
+
+        STRUT_PARTIAL_SET(none, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        screen_update_client_strut(&none, self->desktop,
+                                   &self->strut, self->desktop);
+    }
 
     /* update the list hints */
     client_set_list();
@@ -538,6 +597,10 @@ void client_manage(Window window, ObPrompt *prompt)
 
     ob_debug("Managed window 0x%lx plate 0x%x (%s)",
              window, self->frame->window, self->class);
+
+    stats_section(OB_STATS_CLIENT_MANAGE, stats_time);
+    trace_phase_arg("client", "client_manage", trace_time, "title",
+                    self->title);
 }
 
 ObClient *client_fake_manage(Window window)
@@ -583,6 +646,7 @@ void client_unmanage(ObClient *self)
 {
     GSList *it;
     gulong ignore_start;
+    const gint64 stats_time = stats_start();
 
     ob_debug("Unmanaging window: 0x%x plate 0x%x (%s) (%s)",
              self->window, self->frame->window,
@@ -626,13 +690,18 @@ void client_unmanage(ObClient *self)
     self->kill_prompt = NULL;
 
     client_list = g_list_remove(client_list, self);
-    stacking_remove(self);
+    stacking_remove(CLIENT_AS_WINDOW(self));
     window_remove(self->window);
 
     /* once the client is out of the list, update the struts to remove its
        influence */
-    if (STRUT_EXISTS(self->strut))
-        screen_update_areas();
+    if (STRUT_EXISTS(self->strut)) {
+        StrutPartial none;
+
+        STRUT_PARTIAL_SET(none, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        screen_update_client_strut(&self->strut, self->desktop,
+                                   &none, self->desktop);
+    }
 
     client_call_notifies(self, client_destroy_notifies);
 
@@ -729,6 +798,8 @@ void client_unmanage(ObClient *self)
     g_free(self->client_machine);
     g_free(self->sm_client_id);
     g_slice_free(ObClient, self);
+
+    stats_section(OB_STATS_CLIENT_UNMANAGE, stats_time);
 }
 
 void client_fake_unmanage(ObClient *self)
@@ -908,11 +979,14 @@ static gboolean client_can_steal_focus(ObClient *self,
 static ObAppSettings *client_get_settings_state(ObClient *self)
 {
     ObAppSettings *settings;
-    GSList *it;
+    GSList *apps, *it;
 
     settings = config_create_app_settings();
 
-    for (it = config_per_app_settings; it; it = g_slist_next(it)) {
+    /* only look at the settings which could match the window */
+    apps = config_find_app_settings(self->name, self->class, self->role);
+
+    for (it = apps; it; it = g_slist_next(it)) {
         ObAppSettings *app = it->data;
         gboolean match = TRUE;
 
@@ -957,6 +1031,7 @@ static ObAppSettings *client_get_settings_state(ObClient *self)
             config_app_settings_copy_non_defaults(app, settings);
         }
     }
+    g_slist_free(apps);
 
     if (settings->shade != -1)
         self->shaded = !!settings->shade;
@@ -1202,8 +1277,71 @@ gboolean client_find_onscreen(ObClient *self, gint *x, gint *y, gint w, gint h,
     return ox != *x || oy != *y;
 }
 
+/*! Asks for all of the properties that client_get_all() reads from the
+  windows, with one round trip for all of them.  The icons can be megabytes
+  each, so they are only asked for when @icon is TRUE, rather than holding
+  them for every window at once */
+static void client_prefetch_props(const Window *wins, guint num, gboolean real,
+                                  gboolean icon)
+{
+    /* the properties which decide the decorations and app rule matching,
+       these are read for both real and fake clients */
+    const Atom decor_props[] = {
+        OBT_PROP_ATOM(MOTIF_WM_HINTS),
+        OBT_PROP_ATOM(NET_WM_WINDOW_TYPE),
+        OBT_PROP_ATOM(WM_TRANSIENT_FOR),
+        OBT_PROP_ATOM(WM_NORMAL_HINTS),
+        OBT_PROP_ATOM(NET_WM_STATE),
+        OBT_PROP_ATOM(WM_CLIENT_LEADER),
+        OBT_PROP_ATOM(SM_CLIENT_ID),
+        OBT_PROP_ATOM(WM_CLASS),
+        OBT_PROP_ATOM(WM_WINDOW_ROLE),
+        OBT_PROP_ATOM(WM_COMMAND),
+        OBT_PROP_ATOM(WM_CLIENT_MACHINE),
+        OBT_PROP_ATOM(NET_WM_PID),
+        OBT_PROP_ATOM(NET_WM_NAME),
+        OBT_PROP_ATOM(WM_NAME),
+        OBT_PROP_ATOM(NET_WM_ICON_NAME),
+        OBT_PROP_ATOM(WM_ICON_NAME)
+    };
+    /* the rest of the properties read when managing a real client */
+    const Atom real_props[] = {
+        OBT_PROP_ATOM(WM_PROTOCOLS),
+        OBT_PROP_ATOM(WM_HINTS),
+        OBT_PROP_ATOM(NET_STARTUP_ID),
+        OBT_PROP_ATOM(NET_WM_DESKTOP),
+#ifdef SYNC
+        OBT_PROP_ATOM(NET_WM_SYNC_REQUEST_COUNTER),
+#endif
+        OBT_PROP_ATOM(NET_WM_STRUT),
+        OBT_PROP_ATOM(NET_WM_STRUT_PARTIAL),
+        OBT_PROP_ATOM(NET_WM_ICON_GEOMETRY)
+    };
+    const Atom icon_prop = OBT_PROP_ATOM(NET_WM_ICON);
+
+    obt_prop_prefetch_windows(wins, num,
+                              decor_props, G_N_ELEMENTS(decor_props));
+    if (real) {
+        obt_prop_prefetch_windows(wins, num,
+                                  real_props, G_N_ELEMENTS(real_props));
+        if (icon)
+            obt_prop_prefetch_windows(wins, num, &icon_prop, 1);
+    }
+}
+
+void client_prefetch(const Window *wins, guint num)
+{
+    client_prefetch_props(wins, num, TRUE, FALSE);
+}
+
 static void client_get_all(ObClient *self, gboolean real)
 {
+    /* ask for all of the properties in one round trip instead of one round
+       trip each, the server is grabbed so they can't change under us.  any
+       which were prefetched already by window_manage_all() are not asked
+       for again */
+    client_prefetch_props(&self->window, 1, real, TRUE);
+
     /* this is needed for the frame to set itself up */
     client_get_area(self);
 
@@ -1229,8 +1367,10 @@ static void client_get_all(ObClient *self, gboolean real)
 
     /* now we got everything that can affect the decorations or app rule
        matching */
-    if (!real)
+    if (!real) {
+        obt_prop_prefetch_end(self->window);
         return;
+    }
 
     /* save the values of the variables used for app rule matching */
     client_save_app_rule_values(self);
@@ -1263,6 +1403,8 @@ static void client_get_all(ObClient *self, gboolean real)
     client_update_strut(self);
     client_update_icons(self);
     client_update_icon_geometry(self);
+
+    obt_prop_prefetch_end(self->window);
 }
 
 static void client_get_startup_id(ObClient *self)
@@ -1400,11 +1542,11 @@ static void client_get_shaped(ObClient *self)
 
 void client_update_transient_for(ObClient *self)
 {
-    Window t = None;
+    guint32 t = None;
     ObClient *target = NULL;
     gboolean trangroup = FALSE;
 
-    if (XGetTransientForHint(obt_display, self->window, &t)) {
+    if (OBT_PROP_GET32(self->window, WM_TRANSIENT_FOR, WINDOW, &t)) {
         if (t != self->window) { /* can't be transient to itself! */
             ObWindow *tw = window_find(t);
             /* if this happens then we need to check for it */
@@ -1569,7 +1711,7 @@ void client_get_type_and_transientness(ObClient *self)
 {
     guint num, i;
     guint32 *val;
-    Window t;
+    guint32 t;
 
     self->type = -1;
     self->transient = FALSE;
@@ -1608,7 +1750,7 @@ void client_get_type_and_transientness(ObClient *self)
         g_free(val);
     }
 
-    if (XGetTransientForHint(obt_display, self->window, &t))
+    if (OBT_PROP_GET32(self->window, WM_TRANSIENT_FOR, WINDOW, &t))
         self->transient = TRUE;
 
     if (self->type == (ObClientType) -1) {
@@ -1729,7 +1871,7 @@ void client_update_normal_hints(ObClient *self)
     SIZE_SET(self->max_size, G_MAXINT, G_MAXINT);
 
     /* get the hints from the window */
-    if (XGetWMNormalHints(obt_display, self->window, &size, &ret)) {
+    if (obt_prop_get_wm_normal_hints(self->window, &size, &ret)) {
         /* normal windows can't request placement! har har
         if (!client_normal(self))
         */
@@ -2011,7 +2153,7 @@ void client_update_wmhints(ObClient *self)
     /* assume a window takes input if it doesn't specify */
     self->can_focus = TRUE;
 
-    if ((hints = XGetWMHints(obt_display, self->window)) != NULL) {
+    if ((hints = obt_prop_get_wm_hints(self->window)) != NULL) {
         gboolean ur;
 
         if (hints->flags & InputHint)
@@ -2212,12 +2354,15 @@ void client_update_strut(ObClient *self)
                           0, 0, 0, 0, 0, 0, 0, 0);
 
     if (!PARTIAL_STRUT_EQUAL(strut, self->strut)) {
+        StrutPartial old = self->strut;
+
         self->strut = strut;
 
         /* updating here is pointless while we're being mapped cuz we're not in
            the client list yet */
         if (self->frame)
-            screen_update_areas();
+            screen_update_client_strut(&old, self->desktop,
+                                       &self->strut, self->desktop);
     }
 }
 
@@ -2273,16 +2418,18 @@ void client_update_icons(ObClient *self)
     if (!img) {
         XWMHints *hints;
 
-        if ((hints = XGetWMHints(obt_display, self->window))) {
+        if ((hints = obt_prop_get_wm_hints(self->window))) {
             if (hints->flags & IconPixmapHint) {
                 gboolean xicon;
-                obt_display_ignore_errors(TRUE);
+                ObtXErrorTrap *trap;
+
+                trap = obt_display_trap_begin();
                 xicon = RrPixmapToRGBA(ob_rr_inst,
                                        hints->icon_pixmap,
                                        (hints->flags & IconMaskHint ?
                                         hints->icon_mask : None),
                                        (gint*)&w, (gint*)&h, &data);
-                obt_display_ignore_errors(FALSE);
+                obt_display_trap_end(trap);
 
                 if (xicon) {
                     if (w > 0 && h > 0) {
@@ -3755,6 +3902,7 @@ static void client_set_desktop_recursive(ObClient *self,
 
         old = self->desktop;
         self->desktop = target;
+        resist_update_client(self);
         OBT_PROP_SET32(self->window, NET_WM_DESKTOP, CARDINAL, target);
         /* the frame can display the current desktop state */
         frame_adjust_state(self->frame);
@@ -3766,7 +3914,8 @@ static void client_set_desktop_recursive(ObClient *self,
         if (old != DESKTOP_ALL && !dontraise)
             stacking_raise(CLIENT_AS_WINDOW(self));
         if (STRUT_EXISTS(self->strut))
-            screen_update_areas();
+            screen_update_client_strut(&self->strut, old,
+                                       &self->strut, self->desktop);
         else
             /* the new desktop's geometry may be different, so we may need to
                resize, for example if we are maximized */
@@ -3831,7 +3980,7 @@ gboolean client_validate(ObClient *self)
 {
     struct ObClientFindDestroyUnmap find;
 
-    XSync(obt_display, FALSE); /* get all events on the server */
+    obt_display_sync(); /* get all events on the server */
 
     find.window = self->window;
     find.ignore_unmaps = self->ignore_unmaps;
@@ -4027,6 +4176,9 @@ gboolean client_can_focus(ObClient *self)
 
 gboolean client_focus(ObClient *self)
 {
+    ObtXErrorTrap *trap;
+    gboolean error;
+
     if (!client_validate(self)) return FALSE;
 
     /* we might not focus this window, so if we have modal children which would
@@ -4053,7 +4205,7 @@ gboolean client_focus(ObClient *self)
        go moving on us */
     event_halt_focus_delay();
 
-    obt_display_ignore_errors(TRUE);
+    trap = obt_display_trap_begin();
 
     if (self->can_focus) {
         /* This can cause a BadMatch error with CurrentTime, or if an app
@@ -4077,11 +4229,10 @@ gboolean client_focus(ObClient *self)
         XSendEvent(obt_display, self->window, FALSE, NoEventMask, &ce);
     }
 
-    obt_display_ignore_errors(FALSE);
+    error = obt_display_trap_check(trap);
 
-    ob_debug_type(OB_DEBUG_FOCUS, "Error focusing? %d",
-                  obt_display_error_occured);
-    return !obt_display_error_occured;
+    ob_debug_type(OB_DEBUG_FOCUS, "Error focusing? %d", error);
+    return !error;
 }
 
 static void client_present(ObClient *self, gboolean here, gboolean raise,
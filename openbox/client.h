@@ -337,6 +337,15 @@ void client_remove_destroy_notify_data(ObClientCallback func, gpointer data);
                 possible to manage Openbox-owned windows through this.
 */
 void client_manage(Window win, struct _ObPrompt *prompt);
+/*! Reads the properties needed to manage each of the windows, all at once.
+  They are used when client_manage() is called for the windows.  Changes
+  made to the properties after they are read are only seen if
+  obt_prop_prefetch_end() is called for the window first, which
+  window_manage() does.  obt_prop_prefetch_end() must also be called for
+  any of the windows which are not managed.  The icons are not included,
+  they are read for one window at a time when it is managed.
+*/
+void client_prefetch(const Window *wins, guint num);
 /*! Unmanages all managed windows */
 void client_unmanage_all(void);
 /*! Unmanages a given client */
@@ -350,7 +359,9 @@ ObClient *client_fake_manage(Window win);
 /*! Free the stuff created by client_fake_manage() */
 void client_fake_unmanage(ObClient *self);
 
-/*! Sets the client list on the root window from the client_list */
+/*! Sets the client list on the root window from the client_list.  The
+  property is written once the main loop is idle, and only if the list has
+  changed */
 void client_set_list(void);
 
 /*! Determines if the client should be shown or hidden currently.
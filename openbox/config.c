@@ -53,6 +53,8 @@ gchar   *config_title_layout;
 
 gboolean config_animate_iconify;
 
+guint    config_title_update_interval;
+
 RrFont *config_font_activewindow;
 RrFont *config_font_inactivewindow;
 RrFont *config_font_menuitem;
@@ -98,6 +100,8 @@ guint    config_submenu_show_delay;
 guint    config_submenu_hide_delay;
 gboolean config_menu_manage_desktops;
 gboolean config_menu_show_icons;
+guint    config_menu_pipe_timeout;
+guint    config_menu_pipe_cache_time;
 
 GSList *config_menu_files;
 
@@ -106,6 +110,17 @@ gint     config_resist_edge;
 
 GSList *config_per_app_settings;
 
+/* The per app settings are indexed by the exact name, class or role which
+   they match, so that a window is only checked against the settings which
+   could match it.  Settings which only match these with glob patterns, or
+   match only on other things, go in per_app_settings_globs. */
+static GHashTable *per_app_settings_by_name;
+static GHashTable *per_app_settings_by_class;
+static GHashTable *per_app_settings_by_role;
+static GSList     *per_app_settings_globs;
+static GSList     *per_app_settings_last;
+static guint       per_app_settings_count;
+
 ObAppSettings* config_create_app_settings(void)
 {
     ObAppSettings *settings = g_slice_new0(ObAppSettings);
@@ -162,6 +177,75 @@ void config_app_settings_copy_non_defaults(const ObAppSettings *src,
     dst->height_denom = src->height_denom;
 }
 
+static gboolean pattern_is_exact(const gchar *pattern)
+{
+    return strpbrk(pattern, "*?") == NULL;
+}
+
+static void index_app_settings(GHashTable *table, const gchar *key,
+                               ObAppSettings *settings)
+{
+    GSList *list;
+
+    /* appending to a non-empty list doesn't change its head */
+    if ((list = g_hash_table_lookup(table, key)))
+        g_slist_append(list, settings);
+    else
+        g_hash_table_insert(table, g_strdup(key),
+                            g_slist_append(NULL, settings));
+}
+
+static void add_app_settings(ObAppSettings *settings, const gchar *name,
+                             const gchar *class, const gchar *role)
+{
+    settings->order = per_app_settings_count++;
+
+    /* keep a pointer to the end of the list, so adding is not O(n) */
+    per_app_settings_last = g_slist_append(per_app_settings_last, settings);
+    if (!config_per_app_settings)
+        config_per_app_settings = per_app_settings_last;
+    else
+        per_app_settings_last = per_app_settings_last->next;
+
+    /* it only needs to be in one of the indexes, since it can only match
+       windows which have that exact string */
+    if (class && pattern_is_exact(class))
+        index_app_settings(per_app_settings_by_class, class, settings);
+    else if (name && pattern_is_exact(name))
+        index_app_settings(per_app_settings_by_name, name, settings);
+    else if (role && pattern_is_exact(role))
+        index_app_settings(per_app_settings_by_role, role, settings);
+    else
+        per_app_settings_globs = g_slist_append(per_app_settings_globs,
+                                                settings);
+}
+
+static gint app_settings_cmp(gconstpointer a, gconstpointer b)
+{
+    const ObAppSettings *sa = a, *sb = b;
+    return (gint)sa->order - (gint)sb->order;
+}
+
+GSList* config_find_app_settings(const gchar *name, const gchar *class,
+                                 const gchar *role)
+{
+    GSList *ret = NULL, *it;
+
+    for (it = g_hash_table_lookup(per_app_settings_by_class, class); it;
+         it = g_slist_next(it))
+        ret = g_slist_prepend(ret, it->data);
+    for (it = g_hash_table_lookup(per_app_settings_by_name, name); it;
+         it = g_slist_next(it))
+        ret = g_slist_prepend(ret, it->data);
+    for (it = g_hash_table_lookup(per_app_settings_by_role, role); it;
+         it = g_slist_next(it))
+        ret = g_slist_prepend(ret, it->data);
+    for (it = per_app_settings_globs; it; it = g_slist_next(it))
+        ret = g_slist_prepend(ret, it->data);
+
+    return g_slist_sort(ret, app_settings_cmp);
+}
+
 void config_parse_relative_number(gchar *s, gint *num, gint *denom)
 {
     *num = strtol(s, &s, 10);
@@ -419,6 +503,12 @@ static void parse_per_app_settings(xmlNodePtr node, gpointer d)
         if (type_set)
             settings->type = type;
 
+        parse_single_per_app_settings(app, settings);
+        add_app_settings(settings,
+                         name_set ? name : NULL,
+                         class_set ? class : NULL,
+                         role_set ? role : NULL);
+
         g_free(name);
         g_free(class);
         g_free(group_name);
@@ -426,10 +516,6 @@ static void parse_per_app_settings(xmlNodePtr node, gpointer d)
         g_free(role);
         g_free(title);
         g_free(type_str);
-
-        parse_single_per_app_settings(app, settings);
-        config_per_app_settings = g_slist_append(config_per_app_settings,
-                                                 (gpointer)settings);
     }
 }
 
@@ -712,6 +798,8 @@ static void parse_theme(xmlNodePtr node, gpointer d)
         config_theme_keepborder = obt_xml_node_bool(n);
     if ((n = obt_xml_find_node(node, "animateIconify")))
         config_animate_iconify = obt_xml_node_bool(n);
+    if ((n = obt_xml_find_node(node, "titleUpdateInterval")))
+        config_title_update_interval = MAX(obt_xml_node_int(n), 0);
     if ((n = obt_xml_find_node(node, "windowListIconSize"))) {
         config_theme_window_list_icon_size = obt_xml_node_int(n);
         if (config_theme_window_list_icon_size < 16)
@@ -949,6 +1037,10 @@ static void parse_menu(xmlNodePtr node, gpointer d)
         config_submenu_hide_delay = obt_xml_node_int(n);
     if ((n = obt_xml_find_node(node, "manageDesktops")))
         config_menu_manage_desktops = obt_xml_node_bool(n);
+    if ((n = obt_xml_find_node(node, "pipeMenuTimeout")))
+        config_menu_pipe_timeout = obt_xml_node_int(n);
+    if ((n = obt_xml_find_node(node, "pipeMenuCacheTime")))
+        config_menu_pipe_cache_time = obt_xml_node_int(n);
     if ((n = obt_xml_find_node(node, "showIcons"))) {
         config_menu_show_icons = obt_xml_node_bool(n);
 #if !defined(USE_IMLIB2) && !defined(USE_LIBRSVG)
@@ -1095,6 +1187,7 @@ void config_startup(ObtXmlInst *i)
     config_theme = NULL;
 
     config_animate_iconify = TRUE;
+    config_title_update_interval = 100;
     config_title_layout = g_strdup("NLIMC");
     config_theme_keepborder = TRUE;
     config_theme_window_list_icon_size = 36;
@@ -1167,10 +1260,24 @@ void config_startup(ObtXmlInst *i)
     config_menu_manage_desktops = TRUE;
     config_menu_files = NULL;
     config_menu_show_icons = TRUE;
+    config_menu_pipe_timeout = 10000;
+    config_menu_pipe_cache_time = 0;
 
     obt_xml_register(i, "menu", parse_menu, NULL);
 
     config_per_app_settings = NULL;
+    per_app_settings_last = NULL;
+    per_app_settings_globs = NULL;
+    per_app_settings_count = 0;
+    per_app_settings_by_name =
+        g_hash_table_new_full(g_str_hash, g_str_equal,
+                              g_free, (GDestroyNotify)g_slist_free);
+    per_app_settings_by_class =
+        g_hash_table_new_full(g_str_hash, g_str_equal,
+                              g_free, (GDestroyNotify)g_slist_free);
+    per_app_settings_by_role =
+        g_hash_table_new_full(g_str_hash, g_str_equal,
+                              g_free, (GDestroyNotify)g_slist_free);
 
     obt_xml_register(i, "applications", parse_per_app_settings, NULL);
 }
@@ -1209,4 +1316,9 @@ void config_shutdown(void)
         g_slice_free(ObAppSettings, it->data);
     }
     g_slist_free(config_per_app_settings);
+
+    g_hash_table_destroy(per_app_settings_by_name);
+    g_hash_table_destroy(per_app_settings_by_class);
+    g_hash_table_destroy(per_app_settings_by_role);
+    g_slist_free(per_app_settings_globs);
 }
@@ -66,6 +66,9 @@ struct _ObAppSettings
     gint fullscreen;
 
     gint layer;
+
+    /*! The position of these settings in config_per_app_settings */
+    guint order;
 };
 
 /*! Should new windows be focused */
@@ -150,6 +153,9 @@ extern gboolean config_theme_keepborder;
 extern gchar *config_title_layout;
 /*! Animate windows iconifying and restoring */
 extern gboolean config_animate_iconify;
+/*! The shortest time between redrawing a window's title when it changes,
+  in milliseconds */
+extern guint config_title_update_interval;
 /*! Size of icons in focus switching dialogs */
 extern guint config_theme_window_list_icon_size;
 
@@ -211,6 +217,12 @@ extern guint    config_submenu_hide_delay;
 extern gboolean config_menu_manage_desktops;
 /*! Load & show icons in user-defined menus */
 extern gboolean config_menu_show_icons;
+/*! Time to wait for a pipe-menu's command to finish in milliseconds, 0 to
+  wait forever */
+extern guint    config_menu_pipe_timeout;
+/*! Time to keep a pipe-menu's entries before running the command again, in
+  seconds */
+extern guint    config_menu_pipe_cache_time;
 /*! User-specified menu files */
 extern GSList *config_menu_files;
 /*! Per app settings */
@@ -221,6 +233,12 @@ void config_shutdown(void);
 
 /*! Create an ObAppSettings structure with the default values */
 ObAppSettings* config_create_app_settings(void);
+/*! Returns the per app settings which could match a window with the given
+  name, class and role, in the same order as config_per_app_settings.  Only
+  settings that can not match are left out, so the other criteria must still
+  be checked.  The returned list must be freed with g_slist_free(). */
+GSList* config_find_app_settings(const gchar *name, const gchar *class,
+                                 const gchar *role);
 /*! Copies any settings in src to dest, if they are their default value in
   src. */
 void config_app_settings_copy_non_defaults(const ObAppSettings *src,
@@ -130,7 +130,7 @@ void dock_shutdown(gboolean reconfig)
     XDestroyWindow(obt_display, dock->frame);
     RrAppearanceFree(dock->a_frame);
     window_remove(dock->frame);
-    stacking_remove(dock);
+    stacking_remove(DOCK_AS_WINDOW(dock));
     g_slice_free(ObDock, dock);
     dock = NULL;
 }
@@ -187,7 +187,7 @@ void dock_manage(Window icon_win, Window name_win)
         XMapWindow(obt_display, app->name_win);
     }
 
-    XSync(obt_display, False);
+    obt_display_sync();
 
     XSelectInput(obt_display, app->icon_win, DOCKAPP_EVENT_MASK);
 
@@ -211,7 +211,7 @@ void dock_unmanage(ObDockApp *app, gboolean reparent)
     XSelectInput(obt_display, app->icon_win, NoEventMask);
     /* remove the window from our save set */
     XChangeSaveSet(obt_display, app->icon_win, SetModeDelete);
-    XSync(obt_display, False);
+    obt_display_sync();
 
     if (reparent) {
         XReparentWindow(obt_display, app->icon_win, obt_root(ob_screen), 0, 0);
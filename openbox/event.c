@@ -39,6 +39,8 @@
 #include "group.h"
 #include "stacking.h"
 #include "ping.h"
+#include "record.h"
+#include "stats.h"
 #include "obt/display.h"
 #include "obt/xqueue.h"
 #include "obt/prop.h"
@@ -80,6 +82,37 @@ typedef struct
     gulong end;   /* inclusive */
 } ObSerialRange;
 
+/*! How many ConfigureRequests and ClientMessages a client can send at once
+  before it is rate limited */
+#define CLIENT_BUDGET_BURST 40
+/*! How many ConfigureRequests and ClientMessages a client can have handled
+  each second once it has used up its burst */
+#define CLIENT_BUDGET_RATE 100
+
+/*! A token bucket for the requests each client sends us, so that one client
+  flooding us can't starve user input and everyone else */
+typedef struct
+{
+    ObClient *client;
+    /*! How many more requests can be handled right away */
+    gdouble tokens;
+    /*! When tokens were last added */
+    gint64 time;
+    /*! Copies of the XEvents which are waiting for tokens, oldest first */
+    GQueue deferred;
+    /*! Handles the deferred events as tokens become available */
+    guint timer;
+
+    /*! ConfigureRequests merged into one that was already waiting, while
+      the client is being throttled */
+    guint coalesced;
+    /*! Events deferred while the client is being throttled */
+    guint throttled;
+    /*! The total of each over the lifetime of the client */
+    guint total_coalesced;
+    guint total_throttled;
+} ObClientBudget;
+
 static void event_process(const XEvent *e, gpointer data);
 static void event_handle_root(XEvent *e);
 static gboolean event_handle_menu_input(XEvent *e);
@@ -97,6 +130,9 @@ static void unfocus_delay_dest(gpointer data);
 static gboolean focus_delay_func(gpointer data);
 static gboolean unfocus_delay_func(gpointer data);
 static void focus_delay_client_dest(ObClient *client, gpointer data);
+static gboolean client_budget_defer(ObClient *client, const XEvent *e);
+static void client_budget_free(ObClientBudget *b);
+static void client_budget_client_dest(ObClient *client, gpointer data);
 
 Time event_last_user_time = CurrentTime;
 
@@ -116,6 +152,11 @@ static guint focus_delay_timeout_id = 0;
 static ObClient *focus_delay_timeout_client = NULL;
 static guint unfocus_delay_timeout_id = 0;
 static ObClient *unfocus_delay_timeout_client = NULL;
+/*! An ObClientBudget for each client which has sent us requests, with the
+  client as the key */
+static GHashTable *client_budgets = NULL;
+/*! TRUE while handling events which were deferred by a client's budget */
+static gboolean client_budget_replaying = FALSE;
 
 #ifdef USE_SM
 static gboolean ice_handler(GIOChannel *source, GIOCondition cond,
@@ -155,6 +196,11 @@ void event_startup(gboolean reconfig)
 #endif
 
     client_add_destroy_notify(focus_delay_client_dest, NULL);
+
+    client_budgets = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                           NULL,
+                                           (GDestroyNotify)client_budget_free);
+    client_add_destroy_notify(client_budget_client_dest, NULL);
 }
 
 void event_shutdown(gboolean reconfig)
@@ -166,6 +212,10 @@ void event_shutdown(gboolean reconfig)
 #endif
 
     client_remove_destroy_notify(focus_delay_client_dest);
+
+    client_remove_destroy_notify(client_budget_client_dest);
+    g_hash_table_destroy(client_budgets);
+    client_budgets = NULL;
 }
 
 static Window event_get_window(XEvent *e)
@@ -459,6 +509,10 @@ static void event_process(const XEvent *ec, gpointer data)
     ObMenuFrame *menu = NULL;
     ObPrompt *prompt = NULL;
     gboolean used;
+    /* events deferred by a client's budget were counted and recorded when
+       they first arrived */
+    const gint64 stats_time = client_budget_replaying ? 0 : stats_start();
+    const gint64 record_time = client_budget_replaying ? 0 : record_start(ec);
 
     /* make a copy we can mangle */
     ee = *ec;
@@ -595,7 +649,9 @@ static void event_process(const XEvent *ec, gpointer data)
             Window win, root;
             gint i;
             guint u;
-            obt_display_ignore_errors(TRUE);
+            ObtXErrorTrap *trap;
+
+            trap = obt_display_trap_begin();
             if (XGetInputFocus(obt_display, &win, &i) &&
                 XGetGeometry(obt_display, win, &root, &i,&i,&u,&u,&u,&u) &&
                 root != obt_root(ob_screen))
@@ -607,7 +663,7 @@ static void event_process(const XEvent *ec, gpointer data)
             else
                 ob_debug_type(OB_DEBUG_FOCUS,
                               "Focus went to a black hole !");
-            obt_display_ignore_errors(FALSE);
+            obt_display_trap_end(trap);
             /* nothing is focused */
             focus_set_client(NULL);
         } else {
@@ -622,8 +678,10 @@ static void event_process(const XEvent *ec, gpointer data)
         if (client && client != focus_client)
             frame_adjust_focus(client->frame, FALSE);
     }
-    else if (client)
-        event_handle_client(client, e);
+    else if (client) {
+        if (!client_budget_defer(client, e))
+            event_handle_client(client, e);
+    }
     else if (dockapp)
         event_handle_dockapp(dockapp, e);
     else if (dock)
@@ -672,6 +730,7 @@ static void event_process(const XEvent *ec, gpointer data)
         /* unhandled configure requests must be used to configure the
            window directly */
         XWindowChanges xwc;
+        ObtXErrorTrap *trap;
 
         xwc.x = e->xconfigurerequest.x;
         xwc.y = e->xconfigurerequest.y;
@@ -683,10 +742,10 @@ static void event_process(const XEvent *ec, gpointer data)
 
         /* we are not to be held responsible if someone sends us an
            invalid request! */
-        obt_display_ignore_errors(TRUE);
+        trap = obt_display_trap_begin();
         XConfigureWindow(obt_display, window,
                          e->xconfigurerequest.value_mask, &xwc);
-        obt_display_ignore_errors(FALSE);
+        obt_display_trap_end(trap);
     }
 #ifdef SYNC
     else if (obt_display_extension_sync &&
@@ -743,6 +802,11 @@ static void event_process(const XEvent *ec, gpointer data)
        the time, so clear it here until the next event is handled */
     event_curtime = event_sourcetime = CurrentTime;
     event_curserial = 0;
+
+    if (!client_budget_replaying) {
+        stats_event(ec->type, stats_time);
+        record_event(ec, record_time);
+    }
 }
 
 static void event_handle_root(XEvent *e)
@@ -935,36 +999,147 @@ static gboolean more_client_message_event(Window window, Atom msgtype)
     return xqueue_exists_local(xqueue_match_window_message, &wm);
 }
 
-struct ObSkipPropertyChange {
-    Window window;
-    Atom prop;
-};
+static void client_budget_free(ObClientBudget *b)
+{
+    XEvent *e;
+
+    while ((e = g_queue_pop_head(&b->deferred)))
+        g_slice_free(XEvent, e);
+    if (b->timer) g_source_remove(b->timer);
+    g_slice_free(ObClientBudget, b);
+}
 
-static gboolean skip_property_change(XEvent *e, gpointer data)
+static void client_budget_client_dest(ObClient *client, gpointer data)
 {
-    const struct ObSkipPropertyChange s = *(struct ObSkipPropertyChange*)data;
-
-    if (e->type == PropertyNotify && e->xproperty.window == s.window) {
-        const Atom a = e->xproperty.atom;
-        const Atom b = s.prop;
-
-        /* these are all updated together */
-        if ((a == OBT_PROP_ATOM(NET_WM_NAME) ||
-             a == OBT_PROP_ATOM(WM_NAME) ||
-             a == OBT_PROP_ATOM(NET_WM_ICON_NAME) ||
-             a == OBT_PROP_ATOM(WM_ICON_NAME))
-            &&
-            (b == OBT_PROP_ATOM(NET_WM_NAME) ||
-             b == OBT_PROP_ATOM(WM_NAME) ||
-             b == OBT_PROP_ATOM(NET_WM_ICON_NAME) ||
-             b == OBT_PROP_ATOM(WM_ICON_NAME)))
-        {
-            return TRUE;
-        }
-        else if (a == b && a == OBT_PROP_ATOM(NET_WM_ICON))
-            return TRUE;
+    /* any requests still waiting are for a window which is gone */
+    g_hash_table_remove(client_budgets, client);
+}
+
+/*! Gives the client the tokens it has earned since they were last added */
+static void client_budget_refill(ObClientBudget *b)
+{
+    const gint64 now = g_get_monotonic_time();
+
+    b->tokens += (gdouble)(now - b->time) * CLIENT_BUDGET_RATE /
+        G_USEC_PER_SEC;
+    b->tokens = MIN(b->tokens, CLIENT_BUDGET_BURST);
+    b->time = now;
+}
+
+static gboolean client_budget_timeout(gpointer data)
+{
+    ObClientBudget *b = data;
+    ObClient *client = b->client;
+    XEvent *e;
+
+    client_budget_refill(b);
+    while (b->tokens >= 1 && (e = g_queue_pop_head(&b->deferred))) {
+        b->tokens -= 1;
+
+        /* handle it as if it had just come from the X server, without
+           charging the client or counting it in the stats again */
+        client_budget_replaying = TRUE;
+        event_process(e, NULL);
+        client_budget_replaying = FALSE;
+        g_slice_free(XEvent, e);
+
+        /* the client may be gone now, and the budget with it */
+        if (g_hash_table_lookup(client_budgets, client) != b)
+            return FALSE; /* the timer was already removed */
     }
-    return FALSE;
+
+    if (g_queue_is_empty(&b->deferred)) {
+        ob_debug_type(OB_DEBUG_APP_BUGS,
+                      "Client %s is no longer being throttled. %u requests "
+                      "were deferred and %u ConfigureRequests were "
+                      "coalesced (%u and %u in total)",
+                      b->client->title, b->throttled, b->coalesced,
+                      b->total_throttled, b->total_coalesced);
+        b->throttled = b->coalesced = 0;
+        b->timer = 0;
+        return FALSE; /* caught up */
+    }
+    return TRUE; /* wait for more tokens */
+}
+
+/*! Merges a ConfigureRequest into an older one, so that it asks for the newer
+  geometry and stacking as well as anything else the older one asked for */
+static void client_budget_merge_configure(XConfigureRequestEvent *o,
+                                          const XConfigureRequestEvent *n)
+{
+    if (n->value_mask & CWX) o->x = n->x;
+    if (n->value_mask & CWY) o->y = n->y;
+    if (n->value_mask & CWWidth) o->width = n->width;
+    if (n->value_mask & CWHeight) o->height = n->height;
+    if (n->value_mask & CWBorderWidth) o->border_width = n->border_width;
+    if (n->value_mask & CWStackMode) {
+        /* the newest stacking request replaces the old one entirely */
+        o->value_mask &= ~CWSibling;
+        o->above = n->above;
+        o->detail = n->detail;
+    }
+    o->value_mask |= n->value_mask;
+}
+
+/*! Makes the client pay for the request it sent.  If it has sent too many
+  too quickly, then the event is saved to be handled later.
+  @return TRUE if the event was deferred, and should not be handled now.
+*/
+static gboolean client_budget_defer(ObClient *client, const XEvent *e)
+{
+    ObClientBudget *b;
+    XEvent *last;
+
+    if (e->type != ConfigureRequest && e->type != ClientMessage)
+        return FALSE;
+    /* it has been paid for already */
+    if (client_budget_replaying)
+        return FALSE;
+
+    if (!(b = g_hash_table_lookup(client_budgets, client))) {
+        b = g_slice_new0(ObClientBudget);
+        b->client = client;
+        b->tokens = CLIENT_BUDGET_BURST;
+        b->time = g_get_monotonic_time();
+        g_queue_init(&b->deferred);
+        g_hash_table_insert(client_budgets, client, b);
+    }
+
+    client_budget_refill(b);
+    /* if older requests are waiting, this one has to wait behind them so
+       they are handled in order */
+    if (g_queue_is_empty(&b->deferred) && b->tokens >= 1) {
+        b->tokens -= 1;
+        return FALSE;
+    }
+
+    if (!b->timer) {
+        ob_debug_type(OB_DEBUG_APP_BUGS,
+                      "Client %s is sending requests faster than %d per "
+                      "second, throttling it", client->title,
+                      CLIENT_BUDGET_RATE);
+        b->timer = g_timeout_add_full(G_PRIORITY_DEFAULT,
+                                      1000 / CLIENT_BUDGET_RATE,
+                                      client_budget_timeout, b, NULL);
+    }
+
+    /* only the newest geometry matters, but a ConfigureRequest can't move
+       past any other request from the client, which might change what it
+       does */
+    last = g_queue_peek_tail(&b->deferred);
+    if (last && last->type == ConfigureRequest && e->type == ConfigureRequest)
+    {
+        client_budget_merge_configure(&last->xconfigurerequest,
+                                      &e->xconfigurerequest);
+        ++b->coalesced;
+        ++b->total_coalesced;
+    }
+    else {
+        g_queue_push_tail(&b->deferred, g_slice_dup(XEvent, e));
+        ++b->throttled;
+        ++b->total_throttled;
+    }
+    return TRUE;
 }
 
 static void event_handle_client(ObClient *client, XEvent *e)
@@ -1616,13 +1791,27 @@ static void event_handle_client(ObClient *client, XEvent *e)
         msgtype = e->xproperty.atom;
 
         /* ignore changes to some properties if there is another change
-           coming in the queue */
+           coming in the queue, so each one is only read once for its
+           newest value */
         {
-            struct ObSkipPropertyChange s;
-            s.window = client->window;
-            s.prop = msgtype;
-            if (xqueue_exists_local(skip_property_change, &s))
-                break;
+            /* the names are all updated together */
+            const Atom names[4] = {
+                OBT_PROP_ATOM(NET_WM_NAME),
+                OBT_PROP_ATOM(WM_NAME),
+                OBT_PROP_ATOM(NET_WM_ICON_NAME),
+                OBT_PROP_ATOM(WM_ICON_NAME)
+            };
+
+            if (msgtype == names[0] || msgtype == names[1] ||
+                msgtype == names[2] || msgtype == names[3])
+            {
+                if (xqueue_pending_property(client->window, names, 4))
+                    break;
+            }
+            else if (msgtype == OBT_PROP_ATOM(NET_WM_ICON)) {
+                if (xqueue_pending_property(client->window, &msgtype, 1))
+                    break;
+            }
         }
 
         msgtype = e->xproperty.atom;
@@ -2237,7 +2426,7 @@ void event_cancel_all_key_grabs(void)
     else
         ungrab_passive_key();
 
-    XSync(obt_display, FALSE);
+    obt_display_sync();
 }
 
 gboolean event_time_after(guint32 t1, guint32 t2)
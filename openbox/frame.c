@@ -27,6 +27,7 @@
 #include "focus_cycle.h"
 #include "focus_cycle_indicator.h"
 #include "moveresize.h"
+#include "resist.h"
 #include "screen.h"
 #include "obrender/theme.h"
 #include "obt/display.h"
@@ -47,6 +48,8 @@
 
 static void flash_done(gpointer data);
 static gboolean flash_timeout(gpointer data);
+static void title_done(gpointer data);
+static gboolean title_timeout(gpointer data);
 
 static void layout_title(ObFrame *self);
 static void set_theme_statics(ObFrame *self);
@@ -83,17 +86,282 @@ static Visual *check_32bit_client(ObClient *c)
     return NULL;
 }
 
-ObFrame *frame_new(ObClient *client)
+/*! The windows in a frame, other than its buttons, which are all made when
+  the frame is */
+static const glong frame_windows[] = {
+    G_STRUCT_OFFSET(ObFrame, window),
+    G_STRUCT_OFFSET(ObFrame, backback),
+    G_STRUCT_OFFSET(ObFrame, backfront),
+    G_STRUCT_OFFSET(ObFrame, innerleft),
+    G_STRUCT_OFFSET(ObFrame, innertop),
+    G_STRUCT_OFFSET(ObFrame, innerright),
+    G_STRUCT_OFFSET(ObFrame, innerbottom),
+    G_STRUCT_OFFSET(ObFrame, innerblb),
+    G_STRUCT_OFFSET(ObFrame, innerbrb),
+    G_STRUCT_OFFSET(ObFrame, innerbll),
+    G_STRUCT_OFFSET(ObFrame, innerbrr),
+    G_STRUCT_OFFSET(ObFrame, title),
+    G_STRUCT_OFFSET(ObFrame, titleleft),
+    G_STRUCT_OFFSET(ObFrame, titletop),
+    G_STRUCT_OFFSET(ObFrame, titletopleft),
+    G_STRUCT_OFFSET(ObFrame, titletopright),
+    G_STRUCT_OFFSET(ObFrame, titleright),
+    G_STRUCT_OFFSET(ObFrame, titlebottom),
+    G_STRUCT_OFFSET(ObFrame, topresize),
+    G_STRUCT_OFFSET(ObFrame, tltresize),
+    G_STRUCT_OFFSET(ObFrame, tllresize),
+    G_STRUCT_OFFSET(ObFrame, trtresize),
+    G_STRUCT_OFFSET(ObFrame, trrresize),
+    G_STRUCT_OFFSET(ObFrame, left),
+    G_STRUCT_OFFSET(ObFrame, right),
+    G_STRUCT_OFFSET(ObFrame, label),
+    G_STRUCT_OFFSET(ObFrame, handle),
+    G_STRUCT_OFFSET(ObFrame, lgrip),
+    G_STRUCT_OFFSET(ObFrame, rgrip),
+    G_STRUCT_OFFSET(ObFrame, handleleft),
+    G_STRUCT_OFFSET(ObFrame, handleright),
+    G_STRUCT_OFFSET(ObFrame, handletop),
+    G_STRUCT_OFFSET(ObFrame, handlebottom),
+    G_STRUCT_OFFSET(ObFrame, lgripleft),
+    G_STRUCT_OFFSET(ObFrame, lgriptop),
+    G_STRUCT_OFFSET(ObFrame, lgripbottom),
+    G_STRUCT_OFFSET(ObFrame, rgripright),
+    G_STRUCT_OFFSET(ObFrame, rgriptop),
+    G_STRUCT_OFFSET(ObFrame, rgripbottom)
+};
+
+/*! The buttons in the titlebar, which are made when they are first shown */
+static const glong frame_buttons[] = {
+    G_STRUCT_OFFSET(ObFrame, max),
+    G_STRUCT_OFFSET(ObFrame, close),
+    G_STRUCT_OFFSET(ObFrame, desk),
+    G_STRUCT_OFFSET(ObFrame, shade),
+    G_STRUCT_OFFSET(ObFrame, icon),
+    G_STRUCT_OFFSET(ObFrame, iconify)
+};
+
+#define FRAME_WINDOW(f, off) G_STRUCT_MEMBER(Window, f, off)
+
+/*! The most frames which are kept, with their windows, once their clients
+  are unmanaged, so that new clients can use them instead of making all the
+  windows again */
+#define FRAME_POOL_SIZE 8
+
+/*! Frames which are not being used, oldest first */
+static GQueue frame_pool;
+
+#define FRAME_NUM_ELEMENTS \
+    (G_N_ELEMENTS(frame_windows) + G_N_ELEMENTS(frame_buttons))
+
+/*! Where one of the frame's windows was last put, and whether it was mapped.
+  Requests which would not change these are not sent to the server. */
+struct _ObFrameElement {
+    gint     x, y, width, height;
+    gboolean mapped;
+};
+
+/*! The index in the frame's elements for each of its windows, by the offset
+  of the window in the ObFrame divided by the size of a Window */
+static guint8 element_index[sizeof(ObFrame) / sizeof(Window)];
+
+/*! The number of requests to place the frames' windows that were sent, and
+  that were not needed, since frame_log_requests() was last called */
+static guint requests_sent;
+static guint requests_skipped;
+
+void frame_startup(gboolean reconfig)
+{
+    guint i;
+
+    if (reconfig) return;
+
+    g_queue_init(&frame_pool);
+
+    for (i = 0; i < G_N_ELEMENTS(frame_windows); ++i)
+        element_index[frame_windows[i] / sizeof(Window)] = i;
+    for (i = 0; i < G_N_ELEMENTS(frame_buttons); ++i)
+        element_index[frame_buttons[i] / sizeof(Window)] =
+            G_N_ELEMENTS(frame_windows) + i;
+}
+
+void frame_shutdown(gboolean reconfig)
 {
-    XSetWindowAttributes attrib;
-    gulong mask;
     ObFrame *self;
-    Visual *visual;
 
+    if (reconfig) return;
+
+    while ((self = g_queue_pop_head(&frame_pool))) {
+        XDestroyWindow(obt_display, self->window);
+        g_free(self->elements);
+        g_slice_free(ObFrame, self);
+    }
+}
+
+void frame_log_requests(void)
+{
+    ob_debug("Frame window requests: %u sent, %u not needed",
+             requests_sent, requests_skipped);
+    requests_sent = requests_skipped = 0;
+}
+
+/*! Sets the element for a window the way XCreateWindow leaves it */
+static void elem_reset(ObFrameElement *e)
+{
+    e->x = e->y = 0;
+    e->width = e->height = 1;
+    e->mapped = FALSE;
+}
+
+static ObFrameElement* elem_find(ObFrame *self, Window *w)
+{
+    const glong off = (gchar*)w - (gchar*)self;
+
+    g_assert(*w != None);
+    return &self->elements[element_index[off / sizeof(Window)]];
+}
+
+/*! Configures one of the frame's windows, with only the values in @mask
+  that are different from what it has now */
+static void elem_configure(ObFrame *self, Window *w, guint mask,
+                           gint x, gint y, gint width, gint height)
+{
+    ObFrameElement *e = elem_find(self, w);
+    XWindowChanges c;
+
+    if (e->x == x) mask &= ~CWX;
+    if (e->y == y) mask &= ~CWY;
+    if (e->width == width) mask &= ~CWWidth;
+    if (e->height == height) mask &= ~CWHeight;
+
+    if (!mask) {
+        ++requests_skipped;
+        return;
+    }
+    ++requests_sent;
+
+    c.x = e->x = (mask & CWX ? x : e->x);
+    c.y = e->y = (mask & CWY ? y : e->y);
+    c.width = e->width = (mask & CWWidth ? width : e->width);
+    c.height = e->height = (mask & CWHeight ? height : e->height);
+    XConfigureWindow(obt_display, *w, mask, &c);
+}
+
+static void elem_move_resize(ObFrame *self, Window *w,
+                             gint x, gint y, gint width, gint height)
+{
+    elem_configure(self, w, CWX | CWY | CWWidth | CWHeight,
+                   x, y, width, height);
+}
+
+static void elem_move(ObFrame *self, Window *w, gint x, gint y)
+{
+    elem_configure(self, w, CWX | CWY, x, y, 0, 0);
+}
+
+static void elem_resize(ObFrame *self, Window *w, gint width, gint height)
+{
+    elem_configure(self, w, CWWidth | CWHeight, 0, 0, width, height);
+}
+
+static void elem_show(ObFrame *self, Window *w, gboolean map)
+{
+    ObFrameElement *e = elem_find(self, w);
+
+    if (e->mapped == map) {
+        ++requests_skipped;
+        return;
+    }
+    ++requests_sent;
+
+    e->mapped = map;
+    if (map)
+        XMapWindow(obt_display, *w);
+    else
+        XUnmapWindow(obt_display, *w);
+}
+
+#define elem_map(self, w) elem_show(self, w, TRUE)
+#define elem_unmap(self, w) elem_show(self, w, FALSE)
+
+/*! Is the event for one of the frame's windows? */
+static gboolean pooled_frame_event(XEvent *e, gpointer data)
+{
+    ObFrame *self = data;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(frame_windows); ++i)
+        if (e->xany.window == FRAME_WINDOW(self, frame_windows[i]))
+            return TRUE;
+    for (i = 0; i < G_N_ELEMENTS(frame_buttons); ++i)
+        if (e->xany.window == FRAME_WINDOW(self, frame_buttons[i]))
+            return TRUE;
+    return FALSE;
+}
+
+/*! Takes the windows from the oldest frame in the pool for a new frame.
+  @return NULL if there are no frames in the pool that can be used yet
+*/
+static ObFrame* frame_from_pool(void)
+{
+    ObFrame *old, *self;
+    guint i;
+
+    if (!(old = g_queue_peek_head(&frame_pool)))
+        return NULL;
+
+    /* events from when the windows belonged to the last client must not be
+       mistaken for events on the new one.  once the server has seen the
+       frame go in the pool, any such events have been read, so they can be
+       found in the queue */
+    if ((glong)(LastKnownRequestProcessed(obt_display) - old->pool_serial) < 0
+        || xqueue_exists_local(pooled_frame_event, old))
+        return NULL;
+
+    g_queue_pop_head(&frame_pool);
     self = g_slice_new0(ObFrame);
-    self->client = client;
+    for (i = 0; i < G_N_ELEMENTS(frame_windows); ++i)
+        FRAME_WINDOW(self, frame_windows[i]) =
+            FRAME_WINDOW(old, frame_windows[i]);
+    for (i = 0; i < G_N_ELEMENTS(frame_buttons); ++i)
+        FRAME_WINDOW(self, frame_buttons[i]) =
+            FRAME_WINDOW(old, frame_buttons[i]);
+    /* the windows are still where the last frame put them */
+    self->elements = old->elements;
+    self->reused = TRUE;
+    g_slice_free(ObFrame, old);
+    return self;
+}
 
-    visual = check_32bit_client(client);
+/*! Puts the frame's windows back the way they were made, and keeps them to
+  be used by another client */
+static void frame_to_pool(ObFrame *self)
+{
+    XUnmapWindow(obt_display, self->window);
+    XSelectInput(obt_display, self->window, NoEventMask);
+    OBT_PROP_ERASE(self->window, NET_WM_WINDOW_OPACITY);
+#ifdef SHAPE
+    XShapeCombineMask(obt_display, self->window, ShapeBounding, 0, 0,
+                      None, ShapeSet);
+#ifdef ShapeInput
+    XShapeCombineMask(obt_display, self->window, ShapeInput, 0, 0,
+                      None, ShapeSet);
+#endif
+#endif
+
+    self->client = NULL;
+    self->pool_serial = NextRequest(obt_display);
+    g_queue_push_tail(&frame_pool, self);
+}
+
+static void frame_create_windows(ObFrame *self, Visual *visual)
+{
+    XSetWindowAttributes attrib;
+    gulong mask;
+    guint i;
+
+    self->elements = g_new(ObFrameElement, FRAME_NUM_ELEMENTS);
+    for (i = 0; i < FRAME_NUM_ELEMENTS; ++i)
+        elem_reset(&self->elements[i]);
 
     /* create the non-visible decor windows */
 
@@ -153,12 +421,6 @@ ObFrame *frame_new(ObClient *client)
     self->right = createWindow(self->window, NULL, mask, &attrib);
 
     self->label = createWindow(self->title, NULL, mask, &attrib);
-    self->max = createWindow(self->title, NULL, mask, &attrib);
-    self->close = createWindow(self->title, NULL, mask, &attrib);
-    self->desk = createWindow(self->title, NULL, mask, &attrib);
-    self->shade = createWindow(self->title, NULL, mask, &attrib);
-    self->icon = createWindow(self->title, NULL, mask, &attrib);
-    self->iconify = createWindow(self->title, NULL, mask, &attrib);
 
     self->handle = createWindow(self->window, NULL, mask, &attrib);
     self->lgrip = createWindow(self->handle, NULL, mask, &attrib);
@@ -176,12 +438,52 @@ ObFrame *frame_new(ObClient *client)
     self->rgriptop = createWindow(self->window, NULL, mask, &attrib);
     self->rgripbottom = createWindow(self->window, NULL, mask, &attrib);
 
-    self->focused = FALSE;
-
     /* the other stuff is shown based on decor settings */
-    XMapWindow(obt_display, self->label);
-    XMapWindow(obt_display, self->backback);
-    XMapWindow(obt_display, self->backfront);
+    elem_map(self, &self->label);
+    elem_map(self, &self->backback);
+    elem_map(self, &self->backfront);
+}
+
+/*! Makes a button in the titlebar the first time that it is shown */
+static void frame_create_button(ObFrame *self, Window *button, gint size)
+{
+    XSetWindowAttributes attrib;
+    gulong mask;
+
+    if (*button) return;
+
+    mask = CWEventMask;
+    attrib.event_mask = ELEMENT_EVENTMASK;
+    if (self->colormap) {
+        /* client has a 32-bit visual */
+        mask |= CWColormap | CWBackPixel | CWBorderPixel;
+        attrib.colormap = RrColormap(ob_rr_inst);
+        attrib.background_pixel = BlackPixel(obt_display, ob_screen);
+        attrib.border_pixel = BlackPixel(obt_display, ob_screen);
+    }
+    *button = createWindow(self->title, NULL, mask, &attrib);
+    elem_reset(elem_find(self, button));
+    elem_resize(self, button, size, size);
+
+    if (self->grabbed)
+        window_add(button, CLIENT_AS_WINDOW(self->client));
+}
+
+ObFrame *frame_new(ObClient *client)
+{
+    ObFrame *self;
+    Visual *visual;
+
+    visual = check_32bit_client(client);
+
+    /* the pool only has frames made with the default visual */
+    if (visual || !(self = frame_from_pool())) {
+        self = g_slice_new0(ObFrame);
+        frame_create_windows(self, visual);
+    }
+    self->client = client;
+
+    self->focused = FALSE;
 
     self->max_press = self->close_press = self->desk_press =
         self->iconify_press = self->shade_press = FALSE;
@@ -199,27 +501,26 @@ ObFrame *frame_new(ObClient *client)
 
 static void set_theme_statics(ObFrame *self)
 {
+    guint i;
+
     /* set colors/appearance/sizes for stuff that doesn't change */
-    XResizeWindow(obt_display, self->max,
-                  ob_rr_theme->button_size, ob_rr_theme->button_size);
-    XResizeWindow(obt_display, self->iconify,
-                  ob_rr_theme->button_size, ob_rr_theme->button_size);
-    XResizeWindow(obt_display, self->icon,
-                  ob_rr_theme->button_size + 2, ob_rr_theme->button_size + 2);
-    XResizeWindow(obt_display, self->close,
-                  ob_rr_theme->button_size, ob_rr_theme->button_size);
-    XResizeWindow(obt_display, self->desk,
-                  ob_rr_theme->button_size, ob_rr_theme->button_size);
-    XResizeWindow(obt_display, self->shade,
-                  ob_rr_theme->button_size, ob_rr_theme->button_size);
-    XResizeWindow(obt_display, self->tltresize,
-                  ob_rr_theme->grip_width, ob_rr_theme->paddingy + 1);
-    XResizeWindow(obt_display, self->trtresize,
-                  ob_rr_theme->grip_width, ob_rr_theme->paddingy + 1);
-    XResizeWindow(obt_display, self->tllresize,
-                  ob_rr_theme->paddingx + 1, ob_rr_theme->title_height);
-    XResizeWindow(obt_display, self->trrresize,
-                  ob_rr_theme->paddingx + 1, ob_rr_theme->title_height);
+    for (i = 0; i < G_N_ELEMENTS(frame_buttons); ++i) {
+        Window *b = &FRAME_WINDOW(self, frame_buttons[i]);
+        const gint size = ob_rr_theme->button_size +
+            (frame_buttons[i] == G_STRUCT_OFFSET(ObFrame, icon) ? 2 : 0);
+
+        /* the rest are made with the right size when they are shown */
+        if (*b)
+            elem_resize(self, b, size, size);
+    }
+    elem_resize(self, &self->tltresize,
+                ob_rr_theme->grip_width, ob_rr_theme->paddingy + 1);
+    elem_resize(self, &self->trtresize,
+                ob_rr_theme->grip_width, ob_rr_theme->paddingy + 1);
+    elem_resize(self, &self->tllresize,
+                ob_rr_theme->paddingx + 1, ob_rr_theme->title_height);
+    elem_resize(self, &self->trrresize,
+                ob_rr_theme->paddingx + 1, ob_rr_theme->title_height);
 }
 
 static void free_theme_statics(ObFrame *self)
@@ -228,13 +529,21 @@ static void free_theme_statics(ObFrame *self)
 
 void frame_free(ObFrame *self)
 {
+    resist_remove_client(self->client);
     free_theme_statics(self);
+    if (self->label_look)
+        g_string_free(self->label_look, TRUE);
 
-    XDestroyWindow(obt_display, self->window);
-    if (self->colormap)
-        XFreeColormap(obt_display, self->colormap);
+    if (!self->colormap && frame_pool.length < FRAME_POOL_SIZE)
+        frame_to_pool(self);
+    else {
+        XDestroyWindow(obt_display, self->window);
+        if (self->colormap)
+            XFreeColormap(obt_display, self->colormap);
+        g_free(self->elements);
 
-    g_slice_free(ObFrame, self);
+        g_slice_free(ObFrame, self);
+    }
 }
 
 void frame_show(ObFrame *self)
@@ -406,90 +715,90 @@ void frame_adjust_area(ObFrame *self, gboolean moved,
                 ob_rr_theme->grip_width - self->size.bottom;
 
             if (self->cbwidth_l) {
-                XMoveResizeWindow(obt_display, self->innerleft,
-                                  self->size.left - self->cbwidth_l,
-                                  self->size.top,
-                                  self->cbwidth_l, self->client->area.height);
+                elem_move_resize(self, &self->innerleft,
+                                 self->size.left - self->cbwidth_l,
+                                 self->size.top,
+                                 self->cbwidth_l, self->client->area.height);
 
-                XMapWindow(obt_display, self->innerleft);
+                elem_map(self, &self->innerleft);
             } else
-                XUnmapWindow(obt_display, self->innerleft);
+                elem_unmap(self, &self->innerleft);
 
             if (self->cbwidth_l && innercornerheight > 0) {
-                XMoveResizeWindow(obt_display, self->innerbll,
-                                  0,
-                                  self->client->area.height - 
-                                  (ob_rr_theme->grip_width -
-                                   self->size.bottom),
-                                  self->cbwidth_l,
-                                  ob_rr_theme->grip_width - self->size.bottom);
-
-                XMapWindow(obt_display, self->innerbll);
+                elem_move_resize(self, &self->innerbll,
+                                 0,
+                                 self->client->area.height - 
+                                 (ob_rr_theme->grip_width -
+                                  self->size.bottom),
+                                 self->cbwidth_l,
+                                 ob_rr_theme->grip_width - self->size.bottom);
+
+                elem_map(self, &self->innerbll);
             } else
-                XUnmapWindow(obt_display, self->innerbll);
+                elem_unmap(self, &self->innerbll);
 
             if (self->cbwidth_r) {
-                XMoveResizeWindow(obt_display, self->innerright,
-                                  self->size.left + self->client->area.width,
-                                  self->size.top,
-                                  self->cbwidth_r, self->client->area.height);
+                elem_move_resize(self, &self->innerright,
+                                 self->size.left + self->client->area.width,
+                                 self->size.top,
+                                 self->cbwidth_r, self->client->area.height);
 
-                XMapWindow(obt_display, self->innerright);
+                elem_map(self, &self->innerright);
             } else
-                XUnmapWindow(obt_display, self->innerright);
+                elem_unmap(self, &self->innerright);
 
             if (self->cbwidth_r && innercornerheight > 0) {
-                XMoveResizeWindow(obt_display, self->innerbrr,
-                                  0,
-                                  self->client->area.height - 
-                                  (ob_rr_theme->grip_width -
-                                   self->size.bottom),
-                                  self->cbwidth_r,
-                                  ob_rr_theme->grip_width - self->size.bottom);
-
-                XMapWindow(obt_display, self->innerbrr);
+                elem_move_resize(self, &self->innerbrr,
+                                 0,
+                                 self->client->area.height - 
+                                 (ob_rr_theme->grip_width -
+                                  self->size.bottom),
+                                 self->cbwidth_r,
+                                 ob_rr_theme->grip_width - self->size.bottom);
+
+                elem_map(self, &self->innerbrr);
             } else
-                XUnmapWindow(obt_display, self->innerbrr);
+                elem_unmap(self, &self->innerbrr);
 
             if (self->cbwidth_t) {
-                XMoveResizeWindow(obt_display, self->innertop,
-                                  self->size.left - self->cbwidth_l,
-                                  self->size.top - self->cbwidth_t,
-                                  self->client->area.width +
-                                  self->cbwidth_l + self->cbwidth_r,
-                                  self->cbwidth_t);
-
-                XMapWindow(obt_display, self->innertop);
+                elem_move_resize(self, &self->innertop,
+                                 self->size.left - self->cbwidth_l,
+                                 self->size.top - self->cbwidth_t,
+                                 self->client->area.width +
+                                 self->cbwidth_l + self->cbwidth_r,
+                                 self->cbwidth_t);
+
+                elem_map(self, &self->innertop);
             } else
-                XUnmapWindow(obt_display, self->innertop);
+                elem_unmap(self, &self->innertop);
 
             if (self->cbwidth_b) {
-                XMoveResizeWindow(obt_display, self->innerbottom,
-                                  self->size.left - self->cbwidth_l,
-                                  self->size.top + self->client->area.height,
-                                  self->client->area.width +
-                                  self->cbwidth_l + self->cbwidth_r,
-                                  self->cbwidth_b);
-
-                XMoveResizeWindow(obt_display, self->innerblb,
-                                  0, 0,
-                                  ob_rr_theme->grip_width + self->bwidth,
-                                  self->cbwidth_b);
-                XMoveResizeWindow(obt_display, self->innerbrb,
-                                  self->client->area.width +
-                                  self->cbwidth_l + self->cbwidth_r -
-                                  (ob_rr_theme->grip_width + self->bwidth),
-                                  0,
-                                  ob_rr_theme->grip_width + self->bwidth,
-                                  self->cbwidth_b);
-
-                XMapWindow(obt_display, self->innerbottom);
-                XMapWindow(obt_display, self->innerblb);
-                XMapWindow(obt_display, self->innerbrb);
+                elem_move_resize(self, &self->innerbottom,
+                                 self->size.left - self->cbwidth_l,
+                                 self->size.top + self->client->area.height,
+                                 self->client->area.width +
+                                 self->cbwidth_l + self->cbwidth_r,
+                                 self->cbwidth_b);
+
+                elem_move_resize(self, &self->innerblb,
+                                 0, 0,
+                                 ob_rr_theme->grip_width + self->bwidth,
+                                 self->cbwidth_b);
+                elem_move_resize(self, &self->innerbrb,
+                                 self->client->area.width +
+                                 self->cbwidth_l + self->cbwidth_r -
+                                 (ob_rr_theme->grip_width + self->bwidth),
+                                 0,
+                                 ob_rr_theme->grip_width + self->bwidth,
+                                 self->cbwidth_b);
+
+                elem_map(self, &self->innerbottom);
+                elem_map(self, &self->innerblb);
+                elem_map(self, &self->innerbrb);
             } else {
-                XUnmapWindow(obt_display, self->innerbottom);
-                XUnmapWindow(obt_display, self->innerblb);
-                XUnmapWindow(obt_display, self->innerbrb);
+                elem_unmap(self, &self->innerbottom);
+                elem_unmap(self, &self->innerblb);
+                elem_unmap(self, &self->innerbrb);
             }
 
             if (self->bwidth) {
@@ -498,103 +807,103 @@ void frame_adjust_area(ObFrame *self, gboolean moved,
                 /* height of titleleft and titleright */
                 titlesides = (!self->max_horz ? ob_rr_theme->grip_width : 0);
 
-                XMoveResizeWindow(obt_display, self->titletop,
-                                  ob_rr_theme->grip_width + self->bwidth, 0,
-                                  /* width + bwidth*2 - bwidth*2 - grips*2 */
-                                  self->width - ob_rr_theme->grip_width * 2,
-                                  self->bwidth);
-                XMoveResizeWindow(obt_display, self->titletopleft,
-                                  0, 0,
-                                  ob_rr_theme->grip_width + self->bwidth,
-                                  self->bwidth);
-                XMoveResizeWindow(obt_display, self->titletopright,
-                                  self->client->area.width +
-                                  self->size.left + self->size.right -
-                                  ob_rr_theme->grip_width - self->bwidth,
-                                  0,
-                                  ob_rr_theme->grip_width + self->bwidth,
-                                  self->bwidth);
+                elem_move_resize(self, &self->titletop,
+                                 ob_rr_theme->grip_width + self->bwidth, 0,
+                                 /* width + bwidth*2 - bwidth*2 - grips*2 */
+                                 self->width - ob_rr_theme->grip_width * 2,
+                                 self->bwidth);
+                elem_move_resize(self, &self->titletopleft,
+                                 0, 0,
+                                 ob_rr_theme->grip_width + self->bwidth,
+                                 self->bwidth);
+                elem_move_resize(self, &self->titletopright,
+                                 self->client->area.width +
+                                 self->size.left + self->size.right -
+                                 ob_rr_theme->grip_width - self->bwidth,
+                                 0,
+                                 ob_rr_theme->grip_width + self->bwidth,
+                                 self->bwidth);
 
                 if (titlesides > 0) {
-                    XMoveResizeWindow(obt_display, self->titleleft,
-                                      0, self->bwidth,
-                                      self->bwidth,
-                                      titlesides);
-                    XMoveResizeWindow(obt_display, self->titleright,
-                                      self->client->area.width +
-                                      self->size.left + self->size.right -
-                                      self->bwidth,
-                                      self->bwidth,
-                                      self->bwidth,
-                                      titlesides);
-
-                    XMapWindow(obt_display, self->titleleft);
-                    XMapWindow(obt_display, self->titleright);
+                    elem_move_resize(self, &self->titleleft,
+                                     0, self->bwidth,
+                                     self->bwidth,
+                                     titlesides);
+                    elem_move_resize(self, &self->titleright,
+                                     self->client->area.width +
+                                     self->size.left + self->size.right -
+                                     self->bwidth,
+                                     self->bwidth,
+                                     self->bwidth,
+                                     titlesides);
+
+                    elem_map(self, &self->titleleft);
+                    elem_map(self, &self->titleright);
                 } else {
-                    XUnmapWindow(obt_display, self->titleleft);
-                    XUnmapWindow(obt_display, self->titleright);
+                    elem_unmap(self, &self->titleleft);
+                    elem_unmap(self, &self->titleright);
                 }
 
-                XMapWindow(obt_display, self->titletop);
-                XMapWindow(obt_display, self->titletopleft);
-                XMapWindow(obt_display, self->titletopright);
+                elem_map(self, &self->titletop);
+                elem_map(self, &self->titletopleft);
+                elem_map(self, &self->titletopright);
 
                 if (self->decorations & OB_FRAME_DECOR_TITLEBAR) {
-                    XMoveResizeWindow(obt_display, self->titlebottom,
-                                      (self->max_horz ? 0 : self->bwidth),
-                                      ob_rr_theme->title_height + self->bwidth,
-                                      self->width,
-                                      self->bwidth);
+                    elem_move_resize(self, &self->titlebottom,
+                                     (self->max_horz ? 0 : self->bwidth),
+                                     ob_rr_theme->title_height + self->bwidth,
+                                     self->width,
+                                     self->bwidth);
 
-                    XMapWindow(obt_display, self->titlebottom);
+                    elem_map(self, &self->titlebottom);
                 } else
-                    XUnmapWindow(obt_display, self->titlebottom);
+                    elem_unmap(self, &self->titlebottom);
             } else {
-                XUnmapWindow(obt_display, self->titlebottom);
+                elem_unmap(self, &self->titlebottom);
 
-                XUnmapWindow(obt_display, self->titletop);
-                XUnmapWindow(obt_display, self->titletopleft);
-                XUnmapWindow(obt_display, self->titletopright);
-                XUnmapWindow(obt_display, self->titleleft);
-                XUnmapWindow(obt_display, self->titleright);
+                elem_unmap(self, &self->titletop);
+                elem_unmap(self, &self->titletopleft);
+                elem_unmap(self, &self->titletopright);
+                elem_unmap(self, &self->titleleft);
+                elem_unmap(self, &self->titleright);
             }
 
             if (self->decorations & OB_FRAME_DECOR_TITLEBAR) {
-                XMoveResizeWindow(obt_display, self->title,
-                                  (self->max_horz ? 0 : self->bwidth),
-                                  self->bwidth,
-                                  self->width, ob_rr_theme->title_height);
+                elem_move_resize(self, &self->title,
+                                 (self->max_horz ? 0 : self->bwidth),
+                                 self->bwidth,
+                                 self->width, ob_rr_theme->title_height);
 
-                XMapWindow(obt_display, self->title);
+                elem_map(self, &self->title);
 
                 if (self->decorations & OB_FRAME_DECOR_GRIPS) {
-                    XMoveResizeWindow(obt_display, self->topresize,
-                                      ob_rr_theme->grip_width,
-                                      0,
-                                      self->width - ob_rr_theme->grip_width *2,
-                                      ob_rr_theme->paddingy + 1);
-
-                    XMoveWindow(obt_display, self->tltresize, 0, 0);
-                    XMoveWindow(obt_display, self->tllresize, 0, 0);
-                    XMoveWindow(obt_display, self->trtresize,
-                                self->width - ob_rr_theme->grip_width, 0);
-                    XMoveWindow(obt_display, self->trrresize,
-                                self->width - ob_rr_theme->paddingx - 1, 0);
-
-                    XMapWindow(obt_display, self->topresize);
-                    XMapWindow(obt_display, self->tltresize);
-                    XMapWindow(obt_display, self->tllresize);
-                    XMapWindow(obt_display, self->trtresize);
-                    XMapWindow(obt_display, self->trrresize);
+                    elem_move_resize(self, &self->topresize,
+                                     ob_rr_theme->grip_width,
+                                     0,
+                                     self->width - ob_rr_theme->grip_width *2,
+                                     ob_rr_theme->paddingy + 1);
+
+                    elem_move(self, &self->tltresize, 0, 0);
+                    elem_move(self, &self->tllresize, 0, 0);
+                    elem_move(self, &self->trtresize,
+                              self->width - ob_rr_theme->grip_width, 0);
+                    elem_move(self, &self->trrresize,
+                              self->width - ob_rr_theme->paddingx - 1, 0);
+
+                    elem_map(self, &self->topresize);
+                    elem_map(self, &self->tltresize);
+                    elem_map(self, &self->tllresize);
+                    elem_map(self, &self->trtresize);
+                    elem_map(self, &self->trrresize);
                 } else {
-                    XUnmapWindow(obt_display, self->topresize);
-                    XUnmapWindow(obt_display, self->tltresize);
-                    XUnmapWindow(obt_display, self->tllresize);
-                    XUnmapWindow(obt_display, self->trtresize);
-                    XUnmapWindow(obt_display, self->trrresize);
+                    elem_unmap(self, &self->topresize);
+                    elem_unmap(self, &self->tltresize);
+                    elem_unmap(self, &self->tllresize);
+                    elem_unmap(self, &self->trtresize);
+                    elem_unmap(self, &self->trrresize);
                 }
             } else
-                XUnmapWindow(obt_display, self->title);
+                elem_unmap(self, &self->title);
         }
 
         if ((self->decorations & OB_FRAME_DECOR_TITLEBAR))
@@ -605,215 +914,215 @@ void frame_adjust_area(ObFrame *self, gboolean moved,
             gint sidebwidth = self->max_horz ? 0 : self->bwidth;
 
             if (self->bwidth && self->size.bottom) {
-                XMoveResizeWindow(obt_display, self->handlebottom,
-                                  ob_rr_theme->grip_width +
-                                  self->bwidth + sidebwidth,
-                                  self->size.top + self->client->area.height +
-                                  self->size.bottom - self->bwidth,
-                                  self->width - (ob_rr_theme->grip_width +
-                                                 sidebwidth) * 2,
-                                  self->bwidth);
+                elem_move_resize(self, &self->handlebottom,
+                                 ob_rr_theme->grip_width +
+                                 self->bwidth + sidebwidth,
+                                 self->size.top + self->client->area.height +
+                                 self->size.bottom - self->bwidth,
+                                 self->width - (ob_rr_theme->grip_width +
+                                                sidebwidth) * 2,
+                                 self->bwidth);
 
 
                 if (sidebwidth) {
-                    XMoveResizeWindow(obt_display, self->lgripleft,
-                                      0,
-                                      self->size.top +
-                                      self->client->area.height +
-                                      self->size.bottom -
-                                      (!self->max_horz ?
-                                       ob_rr_theme->grip_width :
-                                       self->size.bottom - self->cbwidth_b),
-                                      self->bwidth,
-                                      (!self->max_horz ?
-                                       ob_rr_theme->grip_width :
-                                       self->size.bottom - self->cbwidth_b));
-                    XMoveResizeWindow(obt_display, self->rgripright,
-                                  self->size.left +
-                                      self->client->area.width +
-                                      self->size.right - self->bwidth,
-                                      self->size.top +
-                                      self->client->area.height +
-                                      self->size.bottom -
-                                      (!self->max_horz ?
-                                       ob_rr_theme->grip_width :
-                                       self->size.bottom - self->cbwidth_b),
-                                      self->bwidth,
-                                      (!self->max_horz ?
-                                       ob_rr_theme->grip_width :
-                                       self->size.bottom - self->cbwidth_b));
-
-                    XMapWindow(obt_display, self->lgripleft);
-                    XMapWindow(obt_display, self->rgripright);
+                    elem_move_resize(self, &self->lgripleft,
+                                     0,
+                                     self->size.top +
+                                     self->client->area.height +
+                                     self->size.bottom -
+                                     (!self->max_horz ?
+                                      ob_rr_theme->grip_width :
+                                      self->size.bottom - self->cbwidth_b),
+                                     self->bwidth,
+                                     (!self->max_horz ?
+                                      ob_rr_theme->grip_width :
+                                      self->size.bottom - self->cbwidth_b));
+                    elem_move_resize(self, &self->rgripright,
+                                 self->size.left +
+                                     self->client->area.width +
+                                     self->size.right - self->bwidth,
+                                     self->size.top +
+                                     self->client->area.height +
+                                     self->size.bottom -
+                                     (!self->max_horz ?
+                                      ob_rr_theme->grip_width :
+                                      self->size.bottom - self->cbwidth_b),
+                                     self->bwidth,
+                                     (!self->max_horz ?
+                                      ob_rr_theme->grip_width :
+                                      self->size.bottom - self->cbwidth_b));
+
+                    elem_map(self, &self->lgripleft);
+                    elem_map(self, &self->rgripright);
                 } else {
-                    XUnmapWindow(obt_display, self->lgripleft);
-                    XUnmapWindow(obt_display, self->rgripright);
+                    elem_unmap(self, &self->lgripleft);
+                    elem_unmap(self, &self->rgripright);
                 }
 
-                XMoveResizeWindow(obt_display, self->lgripbottom,
-                                  sidebwidth,
-                                  self->size.top + self->client->area.height +
-                                  self->size.bottom - self->bwidth,
-                                  ob_rr_theme->grip_width + self->bwidth,
-                                  self->bwidth);
-                XMoveResizeWindow(obt_display, self->rgripbottom,
-                                  self->size.left + self->client->area.width +
-                                  self->size.right - self->bwidth - sidebwidth-
-                                  ob_rr_theme->grip_width,
-                                  self->size.top + self->client->area.height +
-                                  self->size.bottom - self->bwidth,
-                                  ob_rr_theme->grip_width + self->bwidth,
-                                  self->bwidth);
-
-                XMapWindow(obt_display, self->handlebottom);
-                XMapWindow(obt_display, self->lgripbottom);
-                XMapWindow(obt_display, self->rgripbottom);
+                elem_move_resize(self, &self->lgripbottom,
+                                 sidebwidth,
+                                 self->size.top + self->client->area.height +
+                                 self->size.bottom - self->bwidth,
+                                 ob_rr_theme->grip_width + self->bwidth,
+                                 self->bwidth);
+                elem_move_resize(self, &self->rgripbottom,
+                                 self->size.left + self->client->area.width +
+                                 self->size.right - self->bwidth - sidebwidth-
+                                 ob_rr_theme->grip_width,
+                                 self->size.top + self->client->area.height +
+                                 self->size.bottom - self->bwidth,
+                                 ob_rr_theme->grip_width + self->bwidth,
+                                 self->bwidth);
+
+                elem_map(self, &self->handlebottom);
+                elem_map(self, &self->lgripbottom);
+                elem_map(self, &self->rgripbottom);
 
                 if (self->decorations & OB_FRAME_DECOR_HANDLE &&
                     ob_rr_theme->handle_height > 0)
                 {
-                    XMoveResizeWindow(obt_display, self->handletop,
-                                      ob_rr_theme->grip_width +
-                                      self->bwidth + sidebwidth,
-                                      FRAME_HANDLE_Y(self),
-                                      self->width - (ob_rr_theme->grip_width +
-                                                     sidebwidth) * 2,
-                                      self->bwidth);
-                    XMapWindow(obt_display, self->handletop);
+                    elem_move_resize(self, &self->handletop,
+                                     ob_rr_theme->grip_width +
+                                     self->bwidth + sidebwidth,
+                                     FRAME_HANDLE_Y(self),
+                                     self->width - (ob_rr_theme->grip_width +
+                                                    sidebwidth) * 2,
+                                     self->bwidth);
+                    elem_map(self, &self->handletop);
 
                     if (self->decorations & OB_FRAME_DECOR_GRIPS) {
-                        XMoveResizeWindow(obt_display, self->handleleft,
-                                          ob_rr_theme->grip_width,
-                                          0,
-                                          self->bwidth,
-                                          ob_rr_theme->handle_height);
-                        XMoveResizeWindow(obt_display, self->handleright,
-                                          self->width -
-                                          ob_rr_theme->grip_width -
-                                          self->bwidth,
-                                          0,
-                                          self->bwidth,
-                                          ob_rr_theme->handle_height);
-
-                        XMoveResizeWindow(obt_display, self->lgriptop,
-                                          sidebwidth,
-                                          FRAME_HANDLE_Y(self),
-                                          ob_rr_theme->grip_width +
-                                          self->bwidth,
-                                          self->bwidth);
-                        XMoveResizeWindow(obt_display, self->rgriptop,
-                                          self->size.left +
-                                          self->client->area.width +
-                                          self->size.right - self->bwidth -
-                                          sidebwidth - ob_rr_theme->grip_width,
-                                          FRAME_HANDLE_Y(self),
-                                          ob_rr_theme->grip_width +
-                                          self->bwidth,
-                                          self->bwidth);
-
-                        XMapWindow(obt_display, self->handleleft);
-                        XMapWindow(obt_display, self->handleright);
-                        XMapWindow(obt_display, self->lgriptop);
-                        XMapWindow(obt_display, self->rgriptop);
+                        elem_move_resize(self, &self->handleleft,
+                                         ob_rr_theme->grip_width,
+                                         0,
+                                         self->bwidth,
+                                         ob_rr_theme->handle_height);
+                        elem_move_resize(self, &self->handleright,
+                                         self->width -
+                                         ob_rr_theme->grip_width -
+                                         self->bwidth,
+                                         0,
+                                         self->bwidth,
+                                         ob_rr_theme->handle_height);
+
+                        elem_move_resize(self, &self->lgriptop,
+                                         sidebwidth,
+                                         FRAME_HANDLE_Y(self),
+                                         ob_rr_theme->grip_width +
+                                         self->bwidth,
+                                         self->bwidth);
+                        elem_move_resize(self, &self->rgriptop,
+                                         self->size.left +
+                                         self->client->area.width +
+                                         self->size.right - self->bwidth -
+                                         sidebwidth - ob_rr_theme->grip_width,
+                                         FRAME_HANDLE_Y(self),
+                                         ob_rr_theme->grip_width +
+                                         self->bwidth,
+                                         self->bwidth);
+
+                        elem_map(self, &self->handleleft);
+                        elem_map(self, &self->handleright);
+                        elem_map(self, &self->lgriptop);
+                        elem_map(self, &self->rgriptop);
                     } else {
-                        XUnmapWindow(obt_display, self->handleleft);
-                        XUnmapWindow(obt_display, self->handleright);
-                        XUnmapWindow(obt_display, self->lgriptop);
-                        XUnmapWindow(obt_display, self->rgriptop);
+                        elem_unmap(self, &self->handleleft);
+                        elem_unmap(self, &self->handleright);
+                        elem_unmap(self, &self->lgriptop);
+                        elem_unmap(self, &self->rgriptop);
                     }
                 } else {
-                    XUnmapWindow(obt_display, self->handleleft);
-                    XUnmapWindow(obt_display, self->handleright);
-                    XUnmapWindow(obt_display, self->lgriptop);
-                    XUnmapWindow(obt_display, self->rgriptop);
+                    elem_unmap(self, &self->handleleft);
+                    elem_unmap(self, &self->handleright);
+                    elem_unmap(self, &self->lgriptop);
+                    elem_unmap(self, &self->rgriptop);
 
-                    XUnmapWindow(obt_display, self->handletop);
+                    elem_unmap(self, &self->handletop);
                 }
             } else {
-                XUnmapWindow(obt_display, self->handleleft);
-                XUnmapWindow(obt_display, self->handleright);
-                XUnmapWindow(obt_display, self->lgriptop);
-                XUnmapWindow(obt_display, self->rgriptop);
-
-                XUnmapWindow(obt_display, self->handletop);
-
-                XUnmapWindow(obt_display, self->handlebottom);
-                XUnmapWindow(obt_display, self->lgripleft);
-                XUnmapWindow(obt_display, self->rgripright);
-                XUnmapWindow(obt_display, self->lgripbottom);
-                XUnmapWindow(obt_display, self->rgripbottom);
+                elem_unmap(self, &self->handleleft);
+                elem_unmap(self, &self->handleright);
+                elem_unmap(self, &self->lgriptop);
+                elem_unmap(self, &self->rgriptop);
+
+                elem_unmap(self, &self->handletop);
+
+                elem_unmap(self, &self->handlebottom);
+                elem_unmap(self, &self->lgripleft);
+                elem_unmap(self, &self->rgripright);
+                elem_unmap(self, &self->lgripbottom);
+                elem_unmap(self, &self->rgripbottom);
             }
 
             if (self->decorations & OB_FRAME_DECOR_HANDLE &&
                 ob_rr_theme->handle_height > 0)
             {
-                XMoveResizeWindow(obt_display, self->handle,
-                                  sidebwidth,
-                                  FRAME_HANDLE_Y(self) + self->bwidth,
-                                  self->width, ob_rr_theme->handle_height);
-                XMapWindow(obt_display, self->handle);
+                elem_move_resize(self, &self->handle,
+                                 sidebwidth,
+                                 FRAME_HANDLE_Y(self) + self->bwidth,
+                                 self->width, ob_rr_theme->handle_height);
+                elem_map(self, &self->handle);
 
                 if (self->decorations & OB_FRAME_DECOR_GRIPS) {
-                    XMoveResizeWindow(obt_display, self->lgrip,
-                                      0, 0,
-                                      ob_rr_theme->grip_width,
-                                      ob_rr_theme->handle_height);
-                    XMoveResizeWindow(obt_display, self->rgrip,
-                                      self->width - ob_rr_theme->grip_width,
-                                      0,
-                                      ob_rr_theme->grip_width,
-                                      ob_rr_theme->handle_height);
-
-                    XMapWindow(obt_display, self->lgrip);
-                    XMapWindow(obt_display, self->rgrip);
+                    elem_move_resize(self, &self->lgrip,
+                                     0, 0,
+                                     ob_rr_theme->grip_width,
+                                     ob_rr_theme->handle_height);
+                    elem_move_resize(self, &self->rgrip,
+                                     self->width - ob_rr_theme->grip_width,
+                                     0,
+                                     ob_rr_theme->grip_width,
+                                     ob_rr_theme->handle_height);
+
+                    elem_map(self, &self->lgrip);
+                    elem_map(self, &self->rgrip);
                 } else {
-                    XUnmapWindow(obt_display, self->lgrip);
-                    XUnmapWindow(obt_display, self->rgrip);
+                    elem_unmap(self, &self->lgrip);
+                    elem_unmap(self, &self->rgrip);
                 }
             } else {
-                XUnmapWindow(obt_display, self->lgrip);
-                XUnmapWindow(obt_display, self->rgrip);
+                elem_unmap(self, &self->lgrip);
+                elem_unmap(self, &self->rgrip);
 
-                XUnmapWindow(obt_display, self->handle);
+                elem_unmap(self, &self->handle);
             }
 
             if (self->bwidth && !self->max_horz &&
                 (self->client->area.height + self->size.top +
                  self->size.bottom) > ob_rr_theme->grip_width * 2)
             {
-                XMoveResizeWindow(obt_display, self->left,
-                                  0,
-                                  self->bwidth + ob_rr_theme->grip_width,
-                                  self->bwidth,
-                                  self->client->area.height +
-                                  self->size.top + self->size.bottom -
-                                  ob_rr_theme->grip_width * 2);
-
-                XMapWindow(obt_display, self->left);
+                elem_move_resize(self, &self->left,
+                                 0,
+                                 self->bwidth + ob_rr_theme->grip_width,
+                                 self->bwidth,
+                                 self->client->area.height +
+                                 self->size.top + self->size.bottom -
+                                 ob_rr_theme->grip_width * 2);
+
+                elem_map(self, &self->left);
             } else
-                XUnmapWindow(obt_display, self->left);
+                elem_unmap(self, &self->left);
 
             if (self->bwidth && !self->max_horz &&
                 (self->client->area.height + self->size.top +
                  self->size.bottom) > ob_rr_theme->grip_width * 2)
             {
-                XMoveResizeWindow(obt_display, self->right,
-                                  self->client->area.width + self->cbwidth_l +
-                                  self->cbwidth_r + self->bwidth,
-                                  self->bwidth + ob_rr_theme->grip_width,
-                                  self->bwidth,
-                                  self->client->area.height +
-                                  self->size.top + self->size.bottom -
-                                  ob_rr_theme->grip_width * 2);
-
-                XMapWindow(obt_display, self->right);
+                elem_move_resize(self, &self->right,
+                                 self->client->area.width + self->cbwidth_l +
+                                 self->cbwidth_r + self->bwidth,
+                                 self->bwidth + ob_rr_theme->grip_width,
+                                 self->bwidth,
+                                 self->client->area.height +
+                                 self->size.top + self->size.bottom -
+                                 ob_rr_theme->grip_width * 2);
+
+                elem_map(self, &self->right);
             } else
-                XUnmapWindow(obt_display, self->right);
+                elem_unmap(self, &self->right);
 
-            XMoveResizeWindow(obt_display, self->backback,
-                              self->size.left, self->size.top,
-                              self->client->area.width,
-                              self->client->area.height);
+            elem_move_resize(self, &self->backback,
+                             self->size.left, self->size.top,
+                             self->client->area.width,
+                             self->client->area.height);
         }
     }
 
@@ -834,6 +1143,9 @@ void frame_adjust_area(ObFrame *self, gboolean moved,
         frame_client_gravity(self, &self->area.x, &self->area.y);
     }
 
+    /* keep the edges which other windows snap to up to date */
+    resist_update_client(self->client);
+
     if (!fake) {
         if (!frame_iconify_animating(self))
             /* move and resize the top level frame.
@@ -882,14 +1194,15 @@ void frame_adjust_area(ObFrame *self, gboolean moved,
     if (resized && (self->decorations & OB_FRAME_DECOR_TITLEBAR) &&
         self->label_width)
     {
-        XResizeWindow(obt_display, self->label, self->label_width,
-                      ob_rr_theme->label_height);
+        elem_resize(self, &self->label, self->label_width,
+                    ob_rr_theme->label_height);
     }
 }
 
 static void frame_adjust_cursors(ObFrame *self)
 {
-    if ((self->functions & OB_CLIENT_FUNC_RESIZE) !=
+    if (self->reused ||
+        (self->functions & OB_CLIENT_FUNC_RESIZE) !=
         (self->client->functions & OB_CLIENT_FUNC_RESIZE) ||
         self->max_horz != self->client->max_horz ||
         self->max_vert != self->client->max_vert ||
@@ -901,6 +1214,8 @@ static void frame_adjust_cursors(ObFrame *self)
         gboolean sh = self->client->shaded;
         XSetWindowAttributes a;
 
+        self->reused = FALSE;
+
         /* these ones turn off when max vert, and some when shaded */
         a.cursor = ob_cursor(r && topbot && !sh ?
                              OB_CURSOR_NORTH : OB_CURSOR_NONE);
@@ -955,9 +1270,9 @@ static void frame_adjust_cursors(ObFrame *self)
 void frame_adjust_client_area(ObFrame *self)
 {
     /* adjust the window which is there to prevent flashing on unmap */
-    XMoveResizeWindow(obt_display, self->backfront, 0, 0,
-                      self->client->area.width,
-                      self->client->area.height);
+    elem_move_resize(self, &self->backfront, 0, 0,
+                     self->client->area.width,
+                     self->client->area.height);
 }
 
 void frame_adjust_state(ObFrame *self)
@@ -977,10 +1292,73 @@ void frame_adjust_focus(ObFrame *self, gboolean hilite)
     XFlush(obt_display);
 }
 
+/*! Draws the client's current title in the label */
+static void render_title(ObFrame *self)
+{
+    self->title_time = g_get_monotonic_time();
+
+    if (!self->need_render && self->label_on) {
+        RrAppearance *a;
+        GString *look;
+
+        a = (self->focused ?
+             ob_rr_theme->a_focused_label : ob_rr_theme->a_unfocused_label);
+        a->texture[0].data.text.string = self->client->title;
+        look = RrTextLook(a, self->label_width, ob_rr_theme->label_height);
+
+        /* if it would be drawn the same as it is already, such as when only
+           the part of the title which is ellipsized away changed, then
+           there is nothing to do */
+        if (self->label_look && g_string_equal(look, self->label_look)) {
+            g_string_free(look, TRUE);
+            return;
+        }
+
+        self->need_render = TRUE;
+        framerender_frame(self);
+
+        /* framerender_frame() dropped the old look when it drew the label */
+        if (self->label_look)
+            g_string_free(self->label_look, TRUE);
+        self->label_look = look;
+    }
+    else {
+        self->need_render = TRUE;
+        framerender_frame(self);
+    }
+}
+
+static void title_done(gpointer data)
+{
+    ObFrame *self = data;
+
+    self->title_timer = 0;
+}
+
+static gboolean title_timeout(gpointer data)
+{
+    render_title(data);
+    return FALSE; /* don't repeat */
+}
+
 void frame_adjust_title(ObFrame *self)
 {
-    self->need_render = TRUE;
-    framerender_frame(self);
+    gint64 wait;
+
+    /* the newest title is drawn when the timer fires */
+    if (self->title_timer) return;
+
+    /* clients like terminals showing build output can change their title
+       many times a second, so don't redraw it more often than this */
+    wait = self->title_time + config_title_update_interval * 1000 -
+        g_get_monotonic_time();
+    if (wait > 0)
+        self->title_timer = g_timeout_add_full(G_PRIORITY_DEFAULT,
+                                               (wait + 999) / 1000,
+                                               title_timeout, self,
+                                               title_done);
+    else
+        render_title(self);
 }
 
 void frame_adjust_icon(ObFrame *self)
@@ -1026,12 +1404,18 @@ void frame_grab_client(ObFrame *self)
     window_add(&self->innerbrr, CLIENT_AS_WINDOW(self->client));
     window_add(&self->title, CLIENT_AS_WINDOW(self->client));
     window_add(&self->label, CLIENT_AS_WINDOW(self->client));
-    window_add(&self->max, CLIENT_AS_WINDOW(self->client));
-    window_add(&self->close, CLIENT_AS_WINDOW(self->client));
-    window_add(&self->desk, CLIENT_AS_WINDOW(self->client));
-    window_add(&self->shade, CLIENT_AS_WINDOW(self->client));
-    window_add(&self->icon, CLIENT_AS_WINDOW(self->client));
-    window_add(&self->iconify, CLIENT_AS_WINDOW(self->client));
+    if (self->max)
+        window_add(&self->max, CLIENT_AS_WINDOW(self->client));
+    if (self->close)
+        window_add(&self->close, CLIENT_AS_WINDOW(self->client));
+    if (self->desk)
+        window_add(&self->desk, CLIENT_AS_WINDOW(self->client));
+    if (self->shade)
+        window_add(&self->shade, CLIENT_AS_WINDOW(self->client));
+    if (self->icon)
+        window_add(&self->icon, CLIENT_AS_WINDOW(self->client));
+    if (self->iconify)
+        window_add(&self->iconify, CLIENT_AS_WINDOW(self->client));
     window_add(&self->handle, CLIENT_AS_WINDOW(self->client));
     window_add(&self->lgrip, CLIENT_AS_WINDOW(self->client));
     window_add(&self->rgrip, CLIENT_AS_WINDOW(self->client));
@@ -1058,6 +1442,8 @@ void frame_grab_client(ObFrame *self)
     window_add(&self->rgripright, CLIENT_AS_WINDOW(self->client));
     window_add(&self->rgriptop, CLIENT_AS_WINDOW(self->client));
     window_add(&self->rgripbottom, CLIENT_AS_WINDOW(self->client));
+
+    self->grabbed = TRUE;
 }
 
 static gboolean find_reparent(XEvent *e, gpointer data)
@@ -1098,12 +1484,12 @@ void frame_release_client(ObFrame *self)
     window_remove(self->innerbrr);
     window_remove(self->title);
     window_remove(self->label);
-    window_remove(self->max);
-    window_remove(self->close);
-    window_remove(self->desk);
-    window_remove(self->shade);
-    window_remove(self->icon);
-    window_remove(self->iconify);
+    if (self->max) window_remove(self->max);
+    if (self->close) window_remove(self->close);
+    if (self->desk) window_remove(self->desk);
+    if (self->shade) window_remove(self->shade);
+    if (self->icon) window_remove(self->icon);
+    if (self->iconify) window_remove(self->iconify);
     window_remove(self->handle);
     window_remove(self->lgrip);
     window_remove(self->rgrip);
@@ -1130,8 +1516,10 @@ void frame_release_client(ObFrame *self)
     window_remove(self->rgripright);
     window_remove(self->rgriptop);
     window_remove(self->rgripbottom);
+    self->grabbed = FALSE;
 
     if (self->flash_timer) g_source_remove(self->flash_timer);
+    if (self->title_timer) g_source_remove(self->title_timer);
 }
 
 /* is there anything present between us and the label? */
@@ -1249,53 +1637,59 @@ static void layout_title(ObFrame *self)
 
     /* position and map the elements */
     if (self->icon_on) {
-        XMapWindow(obt_display, self->icon);
-        XMoveWindow(obt_display, self->icon, self->icon_x,
-                    ob_rr_theme->paddingy);
-    } else
-        XUnmapWindow(obt_display, self->icon);
+        frame_create_button(self, &self->icon, ob_rr_theme->button_size + 2);
+        elem_map(self, &self->icon);
+        elem_move(self, &self->icon, self->icon_x,
+                  ob_rr_theme->paddingy);
+    } else if (self->icon)
+        elem_unmap(self, &self->icon);
 
     if (self->desk_on) {
-        XMapWindow(obt_display, self->desk);
-        XMoveWindow(obt_display, self->desk, self->desk_x,
-                    ob_rr_theme->paddingy + 1);
-    } else
-        XUnmapWindow(obt_display, self->desk);
+        frame_create_button(self, &self->desk, ob_rr_theme->button_size);
+        elem_map(self, &self->desk);
+        elem_move(self, &self->desk, self->desk_x,
+                  ob_rr_theme->paddingy + 1);
+    } else if (self->desk)
+        elem_unmap(self, &self->desk);
 
     if (self->shade_on) {
-        XMapWindow(obt_display, self->shade);
-        XMoveWindow(obt_display, self->shade, self->shade_x,
-                    ob_rr_theme->paddingy + 1);
-    } else
-        XUnmapWindow(obt_display, self->shade);
+        frame_create_button(self, &self->shade, ob_rr_theme->button_size);
+        elem_map(self, &self->shade);
+        elem_move(self, &self->shade, self->shade_x,
+                  ob_rr_theme->paddingy + 1);
+    } else if (self->shade)
+        elem_unmap(self, &self->shade);
 
     if (self->iconify_on) {
-        XMapWindow(obt_display, self->iconify);
-        XMoveWindow(obt_display, self->iconify, self->iconify_x,
-                    ob_rr_theme->paddingy + 1);
-    } else
-        XUnmapWindow(obt_display, self->iconify);
+        frame_create_button(self, &self->iconify, ob_rr_theme->button_size);
+        elem_map(self, &self->iconify);
+        elem_move(self, &self->iconify, self->iconify_x,
+                  ob_rr_theme->paddingy + 1);
+    } else if (self->iconify)
+        elem_unmap(self, &self->iconify);
 
     if (self->max_on) {
-        XMapWindow(obt_display, self->max);
-        XMoveWindow(obt_display, self->max, self->max_x,
-                    ob_rr_theme->paddingy + 1);
-    } else
-        XUnmapWindow(obt_display, self->max);
+        frame_create_button(self, &self->max, ob_rr_theme->button_size);
+        elem_map(self, &self->max);
+        elem_move(self, &self->max, self->max_x,
+                  ob_rr_theme->paddingy + 1);
+    } else if (self->max)
+        elem_unmap(self, &self->max);
 
     if (self->close_on) {
-        XMapWindow(obt_display, self->close);
-        XMoveWindow(obt_display, self->close, self->close_x,
-                    ob_rr_theme->paddingy + 1);
-    } else
-        XUnmapWindow(obt_display, self->close);
+        frame_create_button(self, &self->close, ob_rr_theme->button_size);
+        elem_map(self, &self->close);
+        elem_move(self, &self->close, self->close_x,
+                  ob_rr_theme->paddingy + 1);
+    } else if (self->close)
+        elem_unmap(self, &self->close);
 
     if (self->label_on && self->label_width > 0) {
-        XMapWindow(obt_display, self->label);
-        XMoveWindow(obt_display, self->label, self->label_x,
-                    ob_rr_theme->paddingy);
+        elem_map(self, &self->label);
+        elem_move(self, &self->label, self->label_x,
+                  ob_rr_theme->paddingy);
     } else
-        XUnmapWindow(obt_display, self->label);
+        elem_unmap(self, &self->label);
 }
 
 gboolean frame_next_context_from_string(gchar *names, ObFrameContext *cx)
@@ -24,6 +24,7 @@
 #include "obrender/render.h"
 
 typedef struct _ObFrame ObFrame;
+typedef struct _ObFrameElement ObFrameElement;
 
 struct _ObClient;
 
@@ -95,6 +96,7 @@ struct _ObFrame
 
     Window    title;
     Window    label;
+    /* The buttons are None until the title layout first shows them */
     Window    max;
     Window    close;
     Window    desk;
@@ -145,6 +147,21 @@ struct _ObFrame
 
     Colormap  colormap;
 
+    /*! How each of the windows above was last placed, so that they are only
+      configured when that changes.  These go with the windows when the frame
+      goes in the frame pool. */
+    ObFrameElement *elements;
+
+    /*! The client is reparented into the frame, and the frame's windows are
+      in the window map */
+    gboolean  grabbed;
+    /*! The windows were taken from the frame pool, and still have the
+      cursors that the last frame to use them gave them */
+    gboolean  reused;
+    /*! The serial of the first request made after the frame was put in the
+      frame pool */
+    gulong    pool_serial;
+
     gint      icon_on;    /* if the window icon button is on */
     gint      label_on;   /* if the window title is on */
     gint      iconify_on; /* if the window iconify button is on */
@@ -194,6 +211,15 @@ struct _ObFrame
     gint64    flash_end;
     guint     flash_timer;
 
+    /*! What the label looked like when the title was last drawn, see
+      RrTextLook.  NULL when the label has been drawn some other way since. */
+    GString  *label_look;
+    /*! When the title was last drawn, in microseconds */
+    gint64    title_time;
+    /*! Draws the newest title once the config_title_update_interval since it
+      was last drawn has passed */
+    guint     title_timer;
+
     /*! Is the frame currently in an animation for iconify or restore.
       0 means that it is not animating. > 0 means it is animating an iconify.
       < 0 means it is animating a restore.
@@ -203,6 +229,13 @@ struct _ObFrame
     gint64    iconify_animation_end;
 };
 
+void frame_startup(gboolean reconfig);
+void frame_shutdown(gboolean reconfig);
+
+/*! Writes how many requests for placing the frames' windows have been sent
+  and left out, since the last time this was called, to the debug output */
+void frame_log_requests(void);
+
 ObFrame *frame_new(struct _ObClient *c);
 void frame_free(ObFrame *self);
 
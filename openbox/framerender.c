@@ -22,6 +22,7 @@
 #include "screen.h"
 #include "client.h"
 #include "framerender.h"
+#include "stats.h"
 #include "obrender/theme.h"
 
 static void framerender_label(ObFrame *self, RrAppearance *a);
@@ -34,6 +35,8 @@ static void framerender_close(ObFrame *self, RrAppearance *a);
 
 void framerender_frame(ObFrame *self)
 {
+    gint64 stats_time;
+
     if (frame_iconify_animating(self))
         return; /* delay redrawing until the animation is done */
     if (!self->need_render)
@@ -41,6 +44,7 @@ void framerender_frame(ObFrame *self)
     if (!self->visible)
         return;
     self->need_render = FALSE;
+    stats_time = stats_start();
 
     {
         gulong px;
@@ -346,11 +350,18 @@ void framerender_frame(ObFrame *self)
     }
 
     XFlush(obt_display);
+
+    stats_section(OB_STATS_FRAME_RENDER, stats_time);
 }
 
 static void framerender_label(ObFrame *self, RrAppearance *a)
 {
     if (!self->label_on) return;
+    /* whatever it looked like before is replaced */
+    if (self->label_look) {
+        g_string_free(self->label_look, TRUE);
+        self->label_look = NULL;
+    }
     /* set the texture's text! */
     a->texture[0].data.text.string = self->client->title;
     RrPaint(a, self->label, self->label_width, ob_rr_theme->label_height);
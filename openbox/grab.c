@@ -139,7 +139,7 @@ gint grab_server(gboolean grab)
     if (grab) {
         if (sgrabs++ == 0) {
             XGrabServer(obt_display);
-            XSync(obt_display, FALSE);
+            obt_display_sync();
         }
     } else if (sgrabs > 0) {
         if (--sgrabs == 0) {
@@ -188,14 +188,14 @@ void grab_button_full(guint button, guint state, Window win, guint mask,
                       gint pointer_mode, ObCursor cur)
 {
     guint i;
+    ObtXErrorTrap *trap;
 
     /* can get BadAccess from these */
-    obt_display_ignore_errors(TRUE);
+    trap = obt_display_trap_begin();
     for (i = 0; i < MASK_LIST_SIZE; ++i)
         XGrabButton(obt_display, button, state | mask_list[i], win, False,
                     mask, pointer_mode, GrabModeAsync, None, ob_cursor(cur));
-    obt_display_ignore_errors(FALSE);
-    if (obt_display_error_occured)
+    if (obt_display_trap_check(trap))
         ob_debug("Failed to grab button %d modifiers %d", button, state);
 }
 
@@ -210,14 +210,14 @@ void ungrab_button(guint button, guint state, Window win)
 void grab_key(guint keycode, guint state, Window win, gint keyboard_mode)
 {
     guint i;
+    ObtXErrorTrap *trap;
 
     /* can get BadAccess' from these */
-    obt_display_ignore_errors(TRUE);
+    trap = obt_display_trap_begin();
     for (i = 0; i < MASK_LIST_SIZE; ++i)
         XGrabKey(obt_display, keycode, state | mask_list[i], win, FALSE,
                  GrabModeAsync, keyboard_mode);
-    obt_display_ignore_errors(FALSE);
-    if (obt_display_error_occured)
+    if (obt_display_trap_check(trap))
         ob_debug("Failed to grab keycode %d modifiers %d", keycode, state);
 }
 
@@ -34,9 +34,17 @@
 #include "client_list_menu.h"
 #include "client_list_combined_menu.h"
 #include "gettext.h"
+#include "stats.h"
+#include "trace.h"
 #include "obt/xml.h"
 #include "obt/paths.h"
 
+#include <errno.h>
+
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
 typedef struct _ObMenuParseState ObMenuParseState;
 
 struct _ObMenuParseState
@@ -45,6 +53,19 @@ struct _ObMenuParseState
     ObMenu *pipe_creator;
 };
 
+/*! A running pipe-menu command */
+struct _ObMenuPipe
+{
+    ObMenu *menu;
+    gint fd;
+    guint watch_id;
+    guint timeout_id;
+    /*! The command's output is parsed as it is read */
+    ObtXmlStream *stream;
+    /*! The entry shown in the menu while the command is running */
+    ObMenuEntry *loading;
+};
+
 static GHashTable *menu_hash = NULL;
 static ObtXmlInst *menu_parse_inst;
 static ObMenuParseState menu_parse_state;
@@ -82,6 +103,8 @@ void menu_startup(gboolean reconfig)
                        parse_menu_separator, &menu_parse_state);
 
     for (it = config_menu_files; it; it = g_slist_next(it)) {
+        const gint64 trace_time = trace_start();
+
         if (obt_xml_load_config_file(menu_parse_inst,
                                      "openbox",
                                      it->data,
@@ -102,8 +125,11 @@ void menu_startup(gboolean reconfig)
         else
             g_message(_("Unable to find a valid menu file \"%s\""),
                       (const gchar*)it->data);
+        trace_phase_arg("menu", "parse menu", trace_time, "file", it->data);
     }
     if (!loaded) {
+        const gint64 trace_time = trace_start();
+
         if (obt_xml_load_config_file(menu_parse_inst,
                                      "openbox",
                                      "menu.xml",
@@ -114,6 +140,7 @@ void menu_startup(gboolean reconfig)
         } else
             g_message(_("Unable to find a valid menu file \"%s\""),
                       "menu.xml");
+        trace_phase_arg("menu", "parse menu", trace_time, "file", "menu.xml");
     }
 
     g_assert(menu_parse_state.parent == NULL);
@@ -133,56 +160,199 @@ void menu_shutdown(gboolean reconfig)
     menu_hash = NULL;
 }
 
-static gboolean menu_pipe_submenu(gpointer key, gpointer val, gpointer data)
+/*! Returns TRUE if the pipe-menu's entries are too old to be shown again, and
+  it should run its command again */
+static gboolean menu_pipe_expired(ObMenu *self)
 {
-    ObMenu *menu = val;
-    return menu->pipe_creator != NULL;
+    GTimeVal now;
+
+    if (self->pipe)
+        return FALSE; /* it is being rebuilt right now */
+
+    g_get_current_time(&now);
+    /* also expire them if the clock went backwards */
+    return (now.tv_sec < self->pipe_time ||
+            now.tv_sec - self->pipe_time >= self->pipe_cache_time);
+}
+
+static void menu_pipe_submenu(gpointer key, gpointer val, gpointer data)
+{
+    ObMenu *menu = val, *creator;
+    GSList **expired = data;
+
+    /* a pipe-menu's submenus go away when any pipe-menu that created them is
+       rebuilt */
+    for (creator = menu->pipe_creator; creator; creator = creator->pipe_creator)
+        if (menu_pipe_expired(creator)) {
+            *expired = g_slist_prepend(*expired, menu->name);
+            break;
+        }
 }
 
 static void clear_cache(gpointer key, gpointer val, gpointer data)
 {
     ObMenu *menu = val;
-    if (menu->execute)
+    if (menu->execute && menu_pipe_expired(menu))
         menu_clear_entries(menu);
 }
 
 void menu_clear_pipe_caches(void)
 {
-    /* delete any pipe menus' submenus */
-    g_hash_table_foreach_remove(menu_hash, menu_pipe_submenu, NULL);
-    /* empty the top level pipe menus */
+    GSList *expired = NULL;
+
+    /* delete any expired pipe menus' submenus.  find them all first, as they
+       point to their creators, which might be deleted too */
+    g_hash_table_foreach(menu_hash, menu_pipe_submenu, &expired);
+    while (expired) {
+        g_hash_table_remove(menu_hash, expired->data);
+        expired = g_slist_delete_link(expired, expired);
+    }
+    /* empty the expired top level pipe menus */
     g_hash_table_foreach(menu_hash, clear_cache, NULL);
 }
 
+/*! Stops reading a pipe-menu command and frees it.  If the command is still
+  running, it is not killed, as the SIGCHLD handler reaps it when it exits and
+  its pid could belong to another process by then.  Closing the pipe makes
+  its next write fail instead. */
+static void menu_pipe_free(ObMenuPipe *p)
+{
+    if (p->watch_id) g_source_remove(p->watch_id);
+    if (p->timeout_id) g_source_remove(p->timeout_id);
+    close(p->fd);
+    obt_xml_stream_free(p->stream);
+
+    p->menu->pipe = NULL;
+    g_slice_free(ObMenuPipe, p);
+}
+
+/*! Replaces the loading entry in a pipe-menu with the command's output.
+  @param ok FALSE if the command failed, and its output should be ignored
+*/
+static void menu_pipe_done(ObMenuPipe *p, gboolean ok)
+{
+    ObMenu *self = p->menu;
+    ObtXmlStream *stream = p->stream;
+
+    /* the stream is given to the parser */
+    p->stream = NULL;
+
+    menu_entry_remove(p->loading);
+    menu_pipe_free(p);
+
+    if (!ok)
+        obt_xml_stream_free(stream);
+    else if (obt_xml_load_stream(menu_parse_inst, stream,
+                                 "openbox_pipe_menu"))
+    {
+        menu_parse_state.pipe_creator = self;
+        menu_parse_state.parent = self;
+        obt_xml_tree_from_root(menu_parse_inst);
+        obt_xml_close(menu_parse_inst);
+        menu_parse_state.pipe_creator = NULL;
+        menu_parse_state.parent = NULL;
+    } else {
+        g_message(_("Invalid output from pipe-menu \"%s\""), self->execute);
+    }
+
+    {
+        GTimeVal now;
+        g_get_current_time(&now);
+        self->pipe_time = now.tv_sec;
+    }
+
+    /* show the new entries if the menu is open */
+    menu_frame_refresh(self);
+}
+
+static gboolean menu_pipe_read(GIOChannel *source, GIOCondition cond,
+                               gpointer data)
+{
+    ObMenuPipe *p = data;
+    gchar buf[4096];
+    gssize r;
+    gboolean more;
+    const gint64 stats_time = stats_start();
+
+    r = read(p->fd, buf, sizeof(buf));
+    if (r < 0 && (errno == EINTR || errno == EAGAIN))
+        more = TRUE; /* try again */
+    else if (r > 0 && obt_xml_stream_push(p->stream, buf, r))
+        more = TRUE; /* wait for more */
+    else {
+        if (r > 0) {
+            /* the output is broken already, so don't wait for the rest */
+            g_message(_("Invalid output from pipe-menu \"%s\""),
+                      p->menu->execute);
+            menu_pipe_done(p, FALSE);
+        }
+        else {
+            /* the command closed its output, or it can't be read anymore */
+            if (r == 0) p->watch_id = 0;
+            menu_pipe_done(p, r == 0);
+        }
+        more = FALSE; /* the watch was removed already, or is done */
+    }
+
+    stats_section(OB_STATS_PIPE_MENU, stats_time);
+    return more;
+}
+
+static gboolean menu_pipe_timeout(gpointer data)
+{
+    ObMenuPipe *p = data;
+
+    g_message(_("Pipe-menu \"%s\" did not finish after %u ms"),
+              p->menu->execute, config_menu_pipe_timeout);
+    p->timeout_id = 0;
+    menu_pipe_done(p, FALSE);
+    return FALSE; /* don't repeat */
+}
+
 void menu_pipe_execute(ObMenu *self)
 {
-    gchar *output;
+    gchar **argv = NULL;
+    gint fd;
     GError *err = NULL;
+    GIOChannel *chan;
+    ObMenuPipe *p;
 
     if (!self->execute)
         return;
-    if (self->entries) /* the entries are already created and cached */
+    if (self->entries) /* the entries are already created and cached, or the
+                          command is running */
         return;
 
-    if (!g_spawn_command_line_sync(self->execute, &output, NULL, NULL, &err)) {
+    if (!g_shell_parse_argv(self->execute, NULL, &argv, &err) ||
+        !g_spawn_async_with_pipes(NULL, argv, NULL,
+                                  G_SPAWN_SEARCH_PATH,
+                                  NULL, NULL, NULL, NULL, &fd, NULL, &err))
+    {
         g_message(_("Failed to execute command for pipe-menu \"%s\": %s"),
                   self->execute, err->message);
         g_error_free(err);
+        g_strfreev(argv);
         return;
     }
+    g_strfreev(argv);
 
-    if (obt_xml_load_mem(menu_parse_inst, output, strlen(output),
-                         "openbox_pipe_menu"))
-    {
-        menu_parse_state.pipe_creator = self;
-        menu_parse_state.parent = self;
-        obt_xml_tree_from_root(menu_parse_inst);
-        obt_xml_close(menu_parse_inst);
-    } else {
-        g_message(_("Invalid output from pipe-menu \"%s\""), self->execute);
-    }
+    p = g_slice_new(ObMenuPipe);
+    p->menu = self;
+    p->fd = fd;
+    p->stream = obt_xml_stream_new();
+    p->loading = menu_add_normal(self, -1, _("Loading..."), NULL, FALSE);
+    p->loading->data.normal.enabled = FALSE;
+    self->pipe = p;
+
+    /* the output is read as it arrives from the main loop, rather than
+       making the whole window manager wait for the command */
+    chan = g_io_channel_unix_new(fd);
+    p->watch_id = g_io_add_watch(chan, G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                 menu_pipe_read, p);
+    g_io_channel_unref(chan);
 
-    g_free(output);
+    p->timeout_id = config_menu_pipe_timeout ?
+        g_timeout_add(config_menu_pipe_timeout, menu_pipe_timeout, p) : 0;
 }
 
 static ObMenu* menu_from_name(gchar *name)
@@ -350,6 +520,9 @@ static void parse_menu(xmlNodePtr node, gpointer data)
             menu->pipe_creator = state->pipe_creator;
             if (obt_xml_attr_string(node, "execute", &script)) {
                 menu->execute = obt_paths_expand_tilde(script);
+                if (!obt_xml_attr_int(node, "cacheTime",
+                                      &menu->pipe_cache_time))
+                    menu->pipe_cache_time = config_menu_pipe_cache_time;
             } else {
                 ObMenu *old;
 
@@ -434,6 +607,8 @@ static void menu_destroy_hash_value(ObMenu *self)
     if (self->destroy_func)
         self->destroy_func(self, self->data);
 
+    if (self->pipe)
+        menu_pipe_free(self->pipe);
     menu_clear_entries(self);
     g_free(self->name);
     g_free(self->title);
@@ -477,7 +652,7 @@ void menu_show(gchar *name, const GravityPoint *pos, gint monitor,
 
     menu_frame_hide_all();
 
-    /* clear the pipe menus when showing a new menu */
+    /* clear the expired pipe menus when showing a new menu */
     menu_clear_pipe_caches();
 
     frame = menu_frame_new(self, 0, client);
@@ -34,6 +34,7 @@ typedef struct _ObMenuEntry ObMenuEntry;
 typedef struct _ObNormalMenuEntry ObNormalMenuEntry;
 typedef struct _ObSubmenuMenuEntry ObSubmenuMenuEntry;
 typedef struct _ObSeparatorMenuEntry ObSeparatorMenuEntry;
+typedef struct _ObMenuPipe ObMenuPipe;
 
 typedef void (*ObMenuShowFunc)(struct _ObMenuFrame *frame, gpointer data);
 typedef void (*ObMenuHideFunc)(struct _ObMenuFrame *frame, gpointer data);
@@ -74,6 +75,13 @@ struct _ObMenu
 
     /* Command to execute to rebuild the menu */
     gchar *execute;
+    /* The running command which is rebuilding the menu, or NULL */
+    ObMenuPipe *pipe;
+    /* When the command last finished, in seconds */
+    glong pipe_time;
+    /* How long the command's output is kept, in seconds, before it is run
+       again */
+    gint pipe_cache_time;
 
     /* ObMenuEntry list */
     GList *entries;
@@ -174,9 +182,10 @@ ObMenu* menu_new(const gchar *name, const gchar *title,
                  gboolean allow_shortcut_selection, gpointer data);
 void menu_free(ObMenu *menu);
 
-/*! Repopulate a pipe-menu by running its command */
+/*! Repopulate a pipe-menu by running its command.  This returns right away,
+  and the menu shows a placeholder entry until the command finishes */
 void menu_pipe_execute(ObMenu *self);
-/*! Clear a pipe-menu's entries */
+/*! Clear the entries of the pipe-menus whose output has expired */
 void menu_clear_pipe_caches(void);
 
 void menu_show_all_shortcuts(ObMenu *self, gboolean show);
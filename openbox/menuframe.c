@@ -1129,6 +1129,38 @@ static void menu_frame_hide(ObMenuFrame *self)
         menu->cleanup_func(menu, menu->data);
 }
 
+void menu_frame_refresh(ObMenu *menu)
+{
+    GList *it;
+
+    for (it = menu_frame_visible; it; it = g_list_next(it)) {
+        ObMenuFrame *f = it->data;
+        gboolean selected;
+        gint dx, dy;
+
+        if (f->menu != menu) continue;
+
+        /* the menu's entries were replaced, so throw away the old entry
+           frames rather than trying to reuse them */
+        selected = f->selected != NULL;
+        f->selected = NULL;
+        while (f->entries) {
+            menu_entry_frame_free(f->entries->data);
+            f->entries = g_list_delete_link(f->entries, f->entries);
+        }
+
+        menu_frame_update(f);
+
+        /* it may have grown off the screen */
+        menu_frame_move_on_screen(f, f->area.x, f->area.y, &dx, &dy);
+        menu_frame_move(f, f->area.x + dx, f->area.y + dy);
+
+        /* keep the keyboard focus in the menu if it had it */
+        if (selected)
+            menu_frame_select_first(f);
+    }
+}
+
 void menu_frame_hide_all(void)
 {
     GList *it;
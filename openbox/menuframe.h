@@ -126,6 +126,10 @@ gboolean menu_frame_show_topmenu(ObMenuFrame *self, const GravityPoint *pos,
 gboolean menu_frame_show_submenu(ObMenuFrame *self, ObMenuFrame *parent,
                                  ObMenuEntryFrame *parent_entry);
 
+/*! Rebuilds any visible frames for the menu after its entries change while
+  it is being shown */
+void menu_frame_refresh(struct _ObMenu *menu);
+
 void menu_frame_hide_all(void);
 void menu_frame_hide_all_client(struct _ObClient *client);
 
@@ -281,11 +281,12 @@ gboolean mouse_event(ObClient *client, XEvent *e)
             gint junk1, junk2;
             Window wjunk;
             guint ujunk, b, w, h;
+            ObtXErrorTrap *trap;
             /* this can cause errors to occur when the window closes */
-            obt_display_ignore_errors(TRUE);
+            trap = obt_display_trap_begin();
             junk1 = XGetGeometry(obt_display, e->xbutton.window,
                                  &wjunk, &junk1, &junk2, &w, &h, &b, &ujunk);
-            obt_display_ignore_errors(FALSE);
+            obt_display_trap_end(trap);
             if (junk1) {
                 if (e->xbutton.x >= (signed)-b &&
                     e->xbutton.y >= (signed)-b &&
@@ -311,6 +311,8 @@ void moveresize_start(ObClient *c, gint x, gint y, guint b, guint32 cnr)
 
 void moveresize_end(gboolean cancel)
 {
+    frame_log_requests();
+
     ungrab_keyboard();
     ungrab_pointer();
 
@@ -720,7 +722,7 @@ static void move_with_keys(KeySym sym, guint state)
     screen_pointer_pos(&opx, &opy);
     XWarpPointer(obt_display, None, None, 0, 0, 0, 0, dx, dy);
     /* steal the motion events this causes */
-    XSync(obt_display, FALSE);
+    obt_display_sync();
     {
         XEvent ce;
         while (xqueue_remove_local(&ce, xqueue_match_type,
@@ -912,7 +914,7 @@ static void resize_with_keys(KeySym sym, guint state)
     screen_pointer_pos(&opx, &opy);
     XWarpPointer(obt_display, None, None, 0, 0, 0, 0, pdx, pdy);
     /* steal the motion events this causes */
-    XSync(obt_display, FALSE);
+    obt_display_sync();
     {
         XEvent ce;
         while (xqueue_remove_local(&ce, xqueue_match_type,
@@ -42,6 +42,11 @@
 #include "config.h"
 #include "ping.h"
 #include "prompt.h"
+#include "resist.h"
+#include "stacking.h"
+#include "record.h"
+#include "stats.h"
+#include "trace.h"
 #include "gettext.h"
 #include "obrender/render.h"
 #include "obrender/theme.h"
@@ -93,6 +98,7 @@ gchar        *ob_sm_id = NULL;
 gchar        *ob_sm_save_file = NULL;
 gboolean      ob_sm_restore = TRUE;
 gboolean      ob_debug_xinerama = FALSE;
+gchar        *ob_record_file = NULL;
 const gchar  *ob_locale_msg = NULL;
 
 static ObState   state;
@@ -106,6 +112,7 @@ static guint     remote_control = 0;
 static gboolean  being_replaced = FALSE;
 static gchar    *config_file = NULL;
 static gchar    *startup_cmd = NULL;
+static gchar    *trace_file = NULL;
 
 static void signal_handler(gint signal, gpointer data);
 static void remove_args(gint *argc, gchar **argv, gint index, gint num);
@@ -114,9 +121,20 @@ static void parse_args(gint *argc, gchar **argv);
 static Cursor load_cursor(const gchar *name, guint fontval);
 static void run_startup_cmd(void);
 
+/*! Calls a module's startup function, and adds it to the startup trace */
+#define TRACE_STARTUP(func) \
+    {                                                    \
+        const gint64 startup_time = trace_start();       \
+        func(reconfigure);                               \
+        trace_phase("startup", #func, startup_time);     \
+    }
+
 gint main(gint argc, gchar **argv)
 {
     gchar *program_name;
+    GTimer *timer;
+    gint64 trace_time;
+    gboolean annexed;
 
     obt_signal_listen();
 
@@ -145,11 +163,24 @@ gint main(gint argc, gchar **argv)
     program_name = g_path_get_basename(argv[0]);
     g_set_prgname(program_name);
 
-    if (!remote_control)
+    if (trace_file && !remote_control)
+        trace_open(trace_file);
+
+    if (!remote_control) {
+        trace_time = trace_start();
         session_startup(argc, argv);
+        trace_phase("startup", "session_startup", trace_time);
+    }
 
+    timer = g_timer_new();
+    trace_time = trace_start();
     if (!obt_display_open(NULL))
         ob_exit_with_error(_("Failed to open the display from the DISPLAY environment variable."));
+    trace_phase("startup", "obt_display_open", trace_time);
+    /* this is mostly waiting on the server, for the extensions and atoms */
+    ob_debug("Opened the display and interned the atoms in %.1f ms",
+             g_timer_elapsed(timer, NULL) * 1000);
+    g_timer_destroy(timer);
 
     if (remote_control) {
         /* Send client message telling the OB process to:
@@ -177,9 +208,11 @@ gint main(gint argc, gchar **argv)
 
     ob_screen = DefaultScreen(obt_display);
 
+    trace_time = trace_start();
     ob_rr_inst = RrInstanceNew(obt_display, ob_screen);
     if (ob_rr_inst == NULL)
         ob_exit_with_error(_("Failed to initialize the obrender library."));
+    trace_phase("startup", "RrInstanceNew", trace_time);
     /* Saving 3 resizes of an RrImage makes a lot of sense for icons, as there
        are generally 3 icon sizes needed: the titlebar icon, the menu icon,
        and the alt-tab icon
@@ -199,6 +232,7 @@ gint main(gint argc, gchar **argv)
     g_setenv("DISPLAY", DisplayString(obt_display), TRUE);
 
     /* create available cursors */
+    trace_time = trace_start();
     cursors[OB_CURSOR_NONE] = None;
     cursors[OB_CURSOR_POINTER] = load_cursor("left_ptr", XC_left_ptr);
     cursors[OB_CURSOR_BUSYPOINTER] = load_cursor("left_ptr_watch",XC_left_ptr);
@@ -216,8 +250,13 @@ gint main(gint argc, gchar **argv)
     cursors[OB_CURSOR_WEST] = load_cursor("left_side", XC_left_side);
     cursors[OB_CURSOR_NORTHWEST] = load_cursor("top_left_corner",
                                                XC_top_left_corner);
+    trace_phase("startup", "load cursors", trace_time);
+
+    trace_time = trace_start();
+    annexed = screen_annex();
+    trace_phase("startup", "screen_annex", trace_time);
 
-    if (screen_annex()) { /* it will be ours! */
+    if (annexed) { /* it will be ours! */
 
         /* get a timestamp from after taking over as the WM.  if we use the
            old timestamp to set focus it can fail when replacing another WM. */
@@ -237,11 +276,14 @@ gint main(gint argc, gchar **argv)
                 i = obt_xml_instance_new();
 
                 /* register all the available actions */
-                actions_startup(reconfigure);
+                TRACE_STARTUP(actions_startup);
                 /* start up config which sets up with the parser */
+                trace_time = trace_start();
                 config_startup(i);
+                trace_phase("startup", "config_startup", trace_time);
 
                 /* parse/load user options */
+                trace_time = trace_start();
                 if ((config_file &&
                      obt_xml_load_file(i, config_file, "openbox_config")) ||
                     obt_xml_load_config_file(i, "openbox", "rc.xml",
@@ -254,6 +296,8 @@ gint main(gint argc, gchar **argv)
                     g_message(_("Unable to find a valid config file, using some simple defaults"));
                     config_file = NULL;
                 }
+                trace_phase_arg("config", "parse config", trace_time, "file",
+                                config_file ? config_file : "rc.xml");
 
                 if (config_file) {
                     gchar *p = g_filename_to_utf8(config_file, -1,
@@ -280,6 +324,8 @@ gint main(gint argc, gchar **argv)
             /* load the theme specified in the rc file */
             {
                 RrTheme *theme;
+
+                trace_time = trace_start();
                 if ((theme = RrThemeNew(ob_rr_inst, config_theme, TRUE,
                                         config_font_activewindow,
                                         config_font_inactivewindow,
@@ -293,6 +339,8 @@ gint main(gint argc, gchar **argv)
                 }
                 if (ob_rr_theme == NULL)
                     ob_exit_with_error(_("Unable to load a theme."));
+                trace_phase_arg("theme", "RrThemeNew", trace_time, "theme",
+                                ob_rr_theme->name);
 
                 OBT_PROP_SETS(obt_root(ob_screen), OB_THEME,
                               ob_rr_theme->name);
@@ -307,27 +355,32 @@ gint main(gint argc, gchar **argv)
                     frame_adjust_theme(c->frame);
                 }
             }
-            event_startup(reconfigure);
+            TRACE_STARTUP(stats_startup);
+            TRACE_STARTUP(record_startup);
+            TRACE_STARTUP(event_startup);
+            TRACE_STARTUP(stacking_startup);
+            TRACE_STARTUP(resist_startup);
             /* focus_backup is used for stacking, so this needs to come before
                anything that calls stacking_add */
-            sn_startup(reconfigure);
-            window_startup(reconfigure);
-            focus_startup(reconfigure);
-            focus_cycle_startup(reconfigure);
-            focus_cycle_indicator_startup(reconfigure);
-            focus_cycle_popup_startup(reconfigure);
-            screen_startup(reconfigure);
-            grab_startup(reconfigure);
-            group_startup(reconfigure);
-            ping_startup(reconfigure);
-            client_startup(reconfigure);
-            dock_startup(reconfigure);
-            moveresize_startup(reconfigure);
-            keyboard_startup(reconfigure);
-            mouse_startup(reconfigure);
-            menu_frame_startup(reconfigure);
-            menu_startup(reconfigure);
-            prompt_startup(reconfigure);
+            TRACE_STARTUP(sn_startup);
+            TRACE_STARTUP(window_startup);
+            TRACE_STARTUP(focus_startup);
+            TRACE_STARTUP(focus_cycle_startup);
+            TRACE_STARTUP(focus_cycle_indicator_startup);
+            TRACE_STARTUP(focus_cycle_popup_startup);
+            TRACE_STARTUP(screen_startup);
+            TRACE_STARTUP(grab_startup);
+            TRACE_STARTUP(group_startup);
+            TRACE_STARTUP(ping_startup);
+            TRACE_STARTUP(frame_startup);
+            TRACE_STARTUP(client_startup);
+            TRACE_STARTUP(dock_startup);
+            TRACE_STARTUP(moveresize_startup);
+            TRACE_STARTUP(keyboard_startup);
+            TRACE_STARTUP(mouse_startup);
+            TRACE_STARTUP(menu_frame_startup);
+            TRACE_STARTUP(menu_startup);
+            TRACE_STARTUP(prompt_startup);
 
             if (!reconfigure) {
                 /* do this after everything is started so no events will get
@@ -338,7 +391,9 @@ gint main(gint argc, gchar **argv)
                 ObWindow *w;
 
                 /* get all the existing windows */
+                trace_time = trace_start();
                 window_manage_all();
+                trace_phase("startup", "window_manage_all", trace_time);
 
                 /* focus what was focused if a wm was already running */
                 if (OBT_PROP_GET32(obt_root(ob_screen),
@@ -347,6 +402,9 @@ gint main(gint argc, gchar **argv)
                 {
                     client_focus(WINDOW_AS_CLIENT(w));
                 }
+
+                /* openbox has started */
+                trace_close();
             } else {
                 GList *it;
 
@@ -399,6 +457,7 @@ gint main(gint argc, gchar **argv)
             moveresize_shutdown(reconfigure);
             dock_shutdown(reconfigure);
             client_shutdown(reconfigure);
+            frame_shutdown(reconfigure);
             ping_shutdown(reconfigure);
             group_shutdown(reconfigure);
             grab_shutdown(reconfigure);
@@ -409,13 +468,17 @@ gint main(gint argc, gchar **argv)
             focus_shutdown(reconfigure);
             window_shutdown(reconfigure);
             sn_shutdown(reconfigure);
+            resist_shutdown(reconfigure);
+            stacking_shutdown(reconfigure);
             event_shutdown(reconfigure);
+            record_shutdown(reconfigure);
+            stats_shutdown(reconfigure);
             config_shutdown();
             actions_shutdown(reconfigure);
         } while (reconfigure);
     }
 
-    XSync(obt_display, FALSE);
+    obt_display_sync();
 
     RrThemeFree(ob_rr_theme);
     RrImageCacheUnref(ob_rr_icons);
@@ -425,6 +488,9 @@ gint main(gint argc, gchar **argv)
 
     obt_display_close();
 
+    /* if openbox never finished starting up */
+    trace_close();
+
     if (restart) {
         ob_debug_shutdown();
         obt_signal_stop();
@@ -550,6 +616,10 @@ static void print_help(void)
     g_print(_("  --debug-focus       Display debugging output for focus handling\n"));
     g_print(_("  --debug-session     Display debugging output for session management\n"));
     g_print(_("  --debug-xinerama    Split the display into fake xinerama screens\n"));
+    g_print(_("  --record-events FILE\n"
+              "                      Write the X events that are handled to FILE\n"));
+    g_print(_("  --trace-startup FILE\n"
+              "                      Write the time taken to start up to FILE\n"));
     g_print(_("\nPlease report bugs at %s\n"), PACKAGE_BUGREPORT);
 }
 
@@ -656,6 +726,26 @@ static void parse_args(gint *argc, gchar **argv)
         else if (!strcmp(argv[i], "--debug-xinerama")) {
             ob_debug_xinerama = TRUE;
         }
+        else if (!strcmp(argv[i], "--record-events")) {
+            if (i == *argc - 1) /* no args left */
+                g_printerr(_("%s requires an argument\n"), "--record-events");
+            else {
+                ob_record_file = g_strdup(argv[i+1]);
+                /* don't write over the trace when restarting */
+                remove_args(argc, argv, i, 2);
+                --i; /* this arg was removed so go back */
+            }
+        }
+        else if (!strcmp(argv[i], "--trace-startup")) {
+            if (i == *argc - 1) /* no args left */
+                g_printerr(_("%s requires an argument\n"), "--trace-startup");
+            else {
+                trace_file = g_strdup(argv[i+1]);
+                /* only trace the first time openbox starts */
+                remove_args(argc, argv, i, 2);
+                --i; /* this arg was removed so go back */
+            }
+        }
         else if (!strcmp(argv[i], "--reconfigure")) {
             remote_control = 1;
         }
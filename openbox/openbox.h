@@ -44,6 +44,8 @@ extern gchar   *ob_sm_save_file;
 extern gboolean ob_sm_restore;
 extern gboolean ob_replace_wm;
 extern gboolean ob_debug_xinerama;
+/*! The file to write a trace of the X events to, or NULL */
+extern gchar   *ob_record_file;
 
 /*! The current locale for the LC_MESSAGES category */
 extern const gchar *ob_locale_msg;
@@ -31,22 +31,63 @@ static void make_grid(const Rect* client_rects,
                       int* y_edges,
                       int max_edges);
 
-static int best_direction(const Point* grid_point,
-                          const Rect* client_rects,
-                          int n_client_rects,
+/* A position on the grid: the index of the last grid line at or before it,
+   or -1 if it is before all of them, and how far past that line it is. */
+typedef struct _GridPos {
+    int line;
+    int offset;
+} GridPos;
+
+/* A summed-area table over the grid.  sum[i * n_y + j] is the total area
+   of the client rects inside the monitor that lies between the first grid
+   lines and grid lines x_edges[i] and y_edges[j], counting an area once for
+   each rect that covers it.  The total overlap of any rect with the client
+   rects can be found from it in constant time, given where its edges fall
+   on the grid. */
+typedef struct _OverlapTable {
+    const int* x_edges;
+    const int* y_edges;
+    int n_x;
+    int n_y;
+    gint64* sum;
+} OverlapTable;
+
+static void overlap_table_init(OverlapTable* t,
+                               const Rect* client_rects,
+                               int n_client_rects,
+                               const Rect* monitor,
+                               const int* x_edges,
+                               const int* y_edges,
+                               int max_edges);
+
+static void overlap_table_free(OverlapTable* t);
+
+static void locate_shifted(const int* edges,
+                           int n_edges,
+                           int by,
+                           GridPos* pos);
+
+static int total_overlap(const OverlapTable* t,
+                         const GridPos* x0,
+                         const GridPos* y0,
+                         const GridPos* x1,
+                         const GridPos* y1);
+
+static int best_direction(int x_index,
+                          int y_index,
+                          const OverlapTable* t,
+                          const GridPos* x_plus,
+                          const GridPos* x_minus,
+                          const GridPos* y_plus,
+                          const GridPos* y_minus,
                           const Rect* monitor,
                           const Size* req_size,
                           Point* best_top_left);
 
-static int total_overlap(const Rect* client_rects,
-                         int n_client_rects,
-                         const Rect* proposed_rect);
-
 static void center_in_field(Point* grid_point,
                             const Size* req_size,
                             const Rect *monitor,
-                            const Rect* client_rects,
-                            int n_client_rects,
+                            const OverlapTable* t,
                             const int* x_edges,
                             const int* y_edges,
                             int max_edges);
@@ -67,19 +108,28 @@ void place_overlap_find_least_placement(const Rect* client_rects,
     int y_edges[max_edges];
     make_grid(client_rects, n_client_rects, monitor,
             x_edges, y_edges, max_edges);
+
+    OverlapTable table;
+    overlap_table_init(&table, client_rects, n_client_rects, monitor,
+                       x_edges, y_edges, max_edges);
+
+    /* Where the far edges of the rect fall, when it is placed with one edge
+       on each grid line. */
+    GridPos x_plus[table.n_x], x_minus[table.n_x];
+    GridPos y_plus[table.n_y], y_minus[table.n_y];
+    locate_shifted(x_edges, table.n_x, req_size->width, x_plus);
+    locate_shifted(x_edges, table.n_x, -req_size->width, x_minus);
+    locate_shifted(y_edges, table.n_y, req_size->height, y_plus);
+    locate_shifted(y_edges, table.n_y, -req_size->height, y_minus);
+
     int i;
-    for (i = 0; i < max_edges; ++i) {
-        if (x_edges[i] == G_MAXINT)
-            break;
+    for (i = 0; i < table.n_x; ++i) {
         int j;
-        for (j = 0; j < max_edges; ++j) {
-            if (y_edges[j] == G_MAXINT)
-                break;
-            Point grid_point = {.x = x_edges[i], .y = y_edges[j]};
+        for (j = 0; j < table.n_y; ++j) {
             Point best_top_left;
             int this_overlap =
-                best_direction(&grid_point, client_rects, n_client_rects,
-                        monitor, req_size, &best_top_left);
+                best_direction(i, j, &table, x_plus, x_minus, y_plus, y_minus,
+                               monitor, req_size, &best_top_left);
             if (this_overlap < overlap) {
                 overlap = this_overlap;
                 *result = best_top_left;
@@ -94,12 +144,13 @@ void place_overlap_find_least_placement(const Rect* client_rects,
         center_in_field(result,
                         req_size,
                         monitor,
-                        client_rects,
-                        n_client_rects,
+                        &table,
                         x_edges,
                         y_edges,
                         max_edges);
     }
+
+    overlap_table_free(&table);
 }
 
 static int compare_ints(const void* a,
@@ -156,20 +207,182 @@ static void make_grid(const Rect* client_rects,
     uniquify(y_edges, n_edges);
 }
 
-static int total_overlap(const Rect* client_rects,
-                         int n_client_rects,
-                         const Rect* proposed_rect)
+static int count_edges(const int* edges,
+                       int max_edges)
 {
-    int overlap = 0;
-    int i;
+    int n = 0;
+    while (n < max_edges && edges[n] != G_MAXINT)
+        ++n;
+    return n;
+}
+
+static int find_edge(int value,
+                     const int* edges,
+                     int n_edges)
+{
+    BSEARCH_SETUP();
+    BSEARCH(int, edges, 0, n_edges, value);
+    g_assert(BSEARCH_FOUND());
+    return BSEARCH_AT();
+}
+
+static void overlap_table_init(OverlapTable* t,
+                               const Rect* client_rects,
+                               int n_client_rects,
+                               const Rect* monitor,
+                               const int* x_edges,
+                               const int* y_edges,
+                               int max_edges)
+{
+    t->x_edges = x_edges;
+    t->y_edges = y_edges;
+    t->n_x = count_edges(x_edges, max_edges);
+    t->n_y = count_edges(y_edges, max_edges);
+    t->sum = g_new0(gint64, t->n_x * t->n_y);
+
+    const int n_y = t->n_y;
+    gint64* const sum = t->sum;
+
+    /* Mark the corners of each rect, so that after summing along each row
+       and column, sum holds how many rects cover the grid cell to the
+       right and below each grid point.  Rects which are outside the
+       monitor, and so have no edges in the grid, can't overlap anything
+       placed on it. */
+    int i, j;
     for (i = 0; i < n_client_rects; ++i) {
-        if (!RECT_INTERSECTS_RECT(*proposed_rect, client_rects[i]))
+        const Rect* r = &client_rects[i];
+        if (!RECT_INTERSECTS_RECT(*r, *monitor))
             continue;
-        Rect rtemp;
-        RECT_SET_INTERSECTION(rtemp, *proposed_rect, client_rects[i]);
-        overlap += RECT_AREA(rtemp);
+        const int l = find_edge(r->x, x_edges, t->n_x);
+        const int rt = find_edge(r->x + r->width, x_edges, t->n_x);
+        const int tp = find_edge(r->y, y_edges, t->n_y);
+        const int b = find_edge(r->y + r->height, y_edges, t->n_y);
+        ++sum[l * n_y + tp];
+        --sum[rt * n_y + tp];
+        --sum[l * n_y + b];
+        ++sum[rt * n_y + b];
+    }
+    for (i = 0; i < t->n_x; ++i)
+        for (j = 1; j < n_y; ++j)
+            sum[i * n_y + j] += sum[i * n_y + j - 1];
+    for (i = 1; i < t->n_x; ++i)
+        for (j = 0; j < n_y; ++j)
+            sum[i * n_y + j] += sum[(i - 1) * n_y + j];
+
+    /* Turn the count for each cell into its area, and sum those up, in
+       place.  Walking backwards, each cell's count is read before it is
+       replaced. */
+    for (i = t->n_x - 1; i >= 0; --i)
+        for (j = n_y - 1; j >= 0; --j) {
+            sum[i * n_y + j] = (i == 0 || j == 0) ? 0 :
+                sum[(i - 1) * n_y + j - 1] *
+                (x_edges[i] - x_edges[i - 1]) *
+                (y_edges[j] - y_edges[j - 1]);
+        }
+    for (i = 0; i < t->n_x; ++i)
+        for (j = 1; j < n_y; ++j)
+            sum[i * n_y + j] += sum[i * n_y + j - 1];
+    for (i = 1; i < t->n_x; ++i)
+        for (j = 0; j < n_y; ++j)
+            sum[i * n_y + j] += sum[(i - 1) * n_y + j];
+}
+
+static void overlap_table_free(OverlapTable* t)
+{
+    g_free(t->sum);
+    t->sum = NULL;
+}
+
+static GridPos grid_line(int line)
+{
+    GridPos pos = {.line = line, .offset = 0};
+    return pos;
+}
+
+static GridPos locate(int value,
+                      const int* edges,
+                      int n_edges)
+{
+    GridPos pos = {.line = -1, .offset = 0};
+
+    BSEARCH_SETUP();
+    BSEARCH(int, edges, 0, n_edges, value);
+    if (BSEARCH_FOUND())
+        pos.line = BSEARCH_AT();
+    else if (BSEARCH_FOUND_NEAREST_SMALLER())
+        pos.line = BSEARCH_AT();
+    if (pos.line >= 0)
+        pos.offset = value - edges[pos.line];
+    return pos;
+}
+
+static void locate_shifted(const int* edges,
+                           int n_edges,
+                           int by,
+                           GridPos* pos)
+{
+    /* The shifted edges are in order too, so walk along the grid with
+       them. */
+    int line = -1;
+    int i;
+    for (i = 0; i < n_edges; ++i) {
+        const int value = edges[i] + by;
+        while (line + 1 < n_edges && edges[line + 1] <= value)
+            ++line;
+        pos[i].line = line;
+        pos[i].offset = line < 0 ? 0 : value - edges[line];
     }
-    return overlap;
+}
+
+/* The area of the client rects between the first grid lines and the point
+   (x, y), counting an area once for each rect that covers it. */
+static gint64 area_before(const OverlapTable* t,
+                          const GridPos* x,
+                          const GridPos* y)
+{
+    if (x->line < 0 || y->line < 0)
+        return 0;
+
+    const int n_y = t->n_y;
+    const int i = x->line;
+    const int j = y->line;
+    const gint64* sum = t->sum;
+    gint64 area = sum[i * n_y + j];
+
+    /* Nothing covers anything past the last grid lines. */
+    const gboolean in_x = x->offset && i + 1 < t->n_x;
+    const gboolean in_y = y->offset && j + 1 < n_y;
+    if (in_x) {
+        /* The part of the column of cells that x is inside of. */
+        const int w = t->x_edges[i + 1] - t->x_edges[i];
+        area += (sum[(i + 1) * n_y + j] - sum[i * n_y + j]) / w * x->offset;
+    }
+    if (in_y) {
+        /* The part of the row of cells that y is inside of. */
+        const int h = t->y_edges[j + 1] - t->y_edges[j];
+        area += (sum[i * n_y + j + 1] - sum[i * n_y + j]) / h * y->offset;
+    }
+    if (in_x && in_y) {
+        /* The part of the cell that (x, y) is inside of. */
+        const int w = t->x_edges[i + 1] - t->x_edges[i];
+        const int h = t->y_edges[j + 1] - t->y_edges[j];
+        const gint64 cell = sum[(i + 1) * n_y + j + 1] -
+            sum[(i + 1) * n_y + j] - sum[i * n_y + j + 1] + sum[i * n_y + j];
+        area += cell / ((gint64)w * h) * x->offset * y->offset;
+    }
+    return area;
+}
+
+/* The total overlap of the client rects with the rect from (x0, y0) to
+   (x1, y1), counting an area once for each rect that covers it. */
+static int total_overlap(const OverlapTable* t,
+                         const GridPos* x0,
+                         const GridPos* y0,
+                         const GridPos* x1,
+                         const GridPos* y1)
+{
+    return (int)(area_before(t, x1, y1) - area_before(t, x0, y1) -
+                 area_before(t, x1, y0) + area_before(t, x0, y0));
 }
 
 static int find_first_grid_position_greater_or_equal(int search_value,
@@ -210,8 +423,7 @@ typedef struct _ExpandInfo {
     int orig_width;
     int orig_height;
     const Rect* monitor;
-    const Rect* client_rects;
-    int n_client_rects;
+    const OverlapTable* table;
     int max_edges;
 } ExpandInfo;
 
@@ -230,8 +442,15 @@ static int expand_field(int orig_edge_index,
     while (edge_index < i->max_edges - 1) {
         int next_edge_index = edge_index + 1;
         (*expand_by)(&field, edges[next_edge_index] - edges[edge_index]);
-        int overlap = total_overlap(i->client_rects, i->n_client_rects, &field);
-        if (overlap != 0 || !RECT_CONTAINS_RECT(*(i->monitor), field))
+        /* The table only knows about the inside of the monitor. */
+        if (!RECT_CONTAINS_RECT(*(i->monitor), field))
+            break;
+        const OverlapTable* t = i->table;
+        GridPos x0 = locate(field.x, t->x_edges, t->n_x);
+        GridPos y0 = locate(field.y, t->y_edges, t->n_y);
+        GridPos x1 = locate(field.x + field.width, t->x_edges, t->n_x);
+        GridPos y1 = locate(field.y + field.height, t->y_edges, t->n_y);
+        if (total_overlap(t, &x0, &y0, &x1, &y1) != 0)
             break;
         edge_index = next_edge_index;
     }
@@ -251,8 +470,7 @@ static int expand_field(int orig_edge_index,
 static void center_in_field(Point* top_left,
                             const Size* req_size,
                             const Rect *monitor,
-                            const Rect* client_rects,
-                            int n_client_rects,
+                            const OverlapTable* t,
                             const int* x_edges,
                             const int* y_edges,
                             int max_edges)
@@ -269,8 +487,7 @@ static void center_in_field(Point* top_left,
         .orig_width = x_edges[orig_right_edge_index] - top_left->x,
         .orig_height = y_edges[orig_bottom_edge_index] - top_left->y,
         .monitor = monitor,
-        .client_rects = client_rects,
-        .n_client_rects = n_client_rects,
+        .table = t,
         .max_edges = max_edges};
     /* Try extending width. */
     int right_edge_index =
@@ -301,9 +518,13 @@ static void center_in_field(Point* top_left,
 
 #define NUM_DIRECTIONS 4
 
-static int best_direction(const Point* grid_point,
-                          const Rect* client_rects,
-                          int n_client_rects,
+static int best_direction(int x_index,
+                          int y_index,
+                          const OverlapTable* t,
+                          const GridPos* x_plus,
+                          const GridPos* x_minus,
+                          const GridPos* y_plus,
+                          const GridPos* y_minus,
                           const Rect* monitor,
                           const Size* req_size,
                           Point* best_top_left)
@@ -311,18 +532,32 @@ static int best_direction(const Point* grid_point,
     static const Size directions[NUM_DIRECTIONS] = {
         {0, 0}, {0, -1}, {-1, 0}, {-1, -1}
     };
+    const Point grid_point = {
+        .x = t->x_edges[x_index], .y = t->y_edges[y_index]
+    };
+    const GridPos at_x = grid_line(x_index);
+    const GridPos at_y = grid_line(y_index);
     int overlap = G_MAXINT;
     int i;
     for (i = 0; i < NUM_DIRECTIONS; ++i) {
         Point pt = {
-            .x = grid_point->x + (req_size->width * directions[i].width),
-            .y = grid_point->y + (req_size->height * directions[i].height)
+            .x = grid_point.x + (req_size->width * directions[i].width),
+            .y = grid_point.y + (req_size->height * directions[i].height)
         };
         Rect r;
         RECT_SET(r, pt.x, pt.y, req_size->width, req_size->height);
         if (!RECT_CONTAINS_RECT(*monitor, r))
             continue;
-        int this_overlap = total_overlap(client_rects, n_client_rects, &r);
+        /* The rect is either to the right of/below the grid point, or to
+           the left of/above it. */
+        const gboolean left = directions[i].width != 0;
+        const gboolean up = directions[i].height != 0;
+        int this_overlap =
+            total_overlap(t,
+                          left ? &x_minus[x_index] : &at_x,
+                          up ? &y_minus[y_index] : &at_y,
+                          left ? &at_x : &x_plus[x_index],
+                          up ? &at_y : &y_plus[y_index]);
         if (this_overlap < overlap) {
             overlap = this_overlap;
             *best_top_left = pt;
@@ -0,0 +1,284 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   record.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "record.h"
+#include "openbox.h"
+#include "gettext.h"
+#include "obt/display.h"
+#include "obt/prop.h"
+
+#include <X11/Xatom.h>
+#include <stdio.h>
+#include <string.h>
+
+/*! The longest property that is saved, in 32 bit units */
+#define MAX_PROPERTY_LENGTH (1024 * 1024)
+
+static FILE *trace = NULL;
+static gint64 trace_start;
+/*! The atoms which have been named in the trace */
+static GHashTable *named_atoms = NULL;
+
+static void write_entry(ObRecordType type, gconstpointer data, gsize len,
+                        gconstpointer more, gsize more_len);
+static void name_atom(Atom a);
+static void save_window(Window w);
+static void save_property(Window w, Atom a);
+static gboolean own_property(Atom a);
+
+void record_startup(gboolean reconfig)
+{
+    ObRecordHeader h;
+
+    if (reconfig || !ob_record_file) return;
+
+    if (!(trace = fopen(ob_record_file, "wb"))) {
+        g_message(_("Unable to write the event trace to \"%s\""),
+                  ob_record_file);
+        return;
+    }
+
+    h.magic = OB_RECORD_MAGIC;
+    h.version = OB_RECORD_VERSION;
+    h.event_size = sizeof(XEvent);
+    h.screen_width = WidthOfScreen(ScreenOfDisplay(obt_display, ob_screen));
+    h.screen_height = HeightOfScreen(ScreenOfDisplay(obt_display, ob_screen));
+    h.pad = 0;
+    h.root = obt_root(ob_screen);
+    fwrite(&h, sizeof(h), 1, trace);
+
+    trace_start = g_get_monotonic_time();
+    named_atoms = g_hash_table_new(g_direct_hash, g_direct_equal);
+}
+
+void record_shutdown(gboolean reconfig)
+{
+    if (reconfig || !trace) return;
+
+    if (fclose(trace) != 0)
+        g_message(_("Unable to write the event trace to \"%s\""),
+                  ob_record_file);
+    trace = NULL;
+    g_hash_table_destroy(named_atoms);
+    named_atoms = NULL;
+}
+
+static void write_entry(ObRecordType type, gconstpointer data, gsize len,
+                        gconstpointer more, gsize more_len)
+{
+    static const gchar pad[8] = { 0 };
+    ObRecordEntry en;
+
+    en.type = type;
+    en.length = len + more_len;
+    en.time = g_get_monotonic_time() - trace_start;
+    fwrite(&en, sizeof(en), 1, trace);
+    fwrite(data, len, 1, trace);
+    if (more_len)
+        fwrite(more, more_len, 1, trace);
+    if (OB_RECORD_PAD(en.length) > en.length)
+        fwrite(pad, OB_RECORD_PAD(en.length) - en.length, 1, trace);
+}
+
+/*! Atoms are different on every X server, so the name of each one is saved
+  the first time that it is used */
+static void name_atom(Atom a)
+{
+    ObtXErrorTrap *trap;
+    ObRecordAtom ra;
+    gchar *name;
+
+    if (a == None || g_hash_table_lookup(named_atoms, GUINT_TO_POINTER(a)))
+        return;
+    g_hash_table_insert(named_atoms, GUINT_TO_POINTER(a),
+                        GUINT_TO_POINTER(1));
+
+    trap = obt_display_trap_begin();
+    ++obt_display_round_trips;
+    name = XGetAtomName(obt_display, a);
+    obt_display_trap_end(trap);
+
+    if (name) {
+        ra.atom = a;
+        write_entry(OB_RECORD_ATOM, &ra, sizeof(ra), name, strlen(name));
+        XFree(name);
+    }
+}
+
+/*! Saves the window's geometry, and all of its properties, so that a window
+  just like it can be made when the trace is replayed */
+static void save_window(Window w)
+{
+    ObtXErrorTrap *trap;
+    XWindowAttributes attrib;
+    ObRecordWindow rw;
+    Atom *props;
+    gint i, n;
+
+    trap = obt_display_trap_begin();
+    ++obt_display_round_trips;
+    if (!XGetWindowAttributes(obt_display, w, &attrib)) {
+        obt_display_trap_end(trap);
+        return;
+    }
+    ++obt_display_round_trips;
+    props = XListProperties(obt_display, w, &n);
+    obt_display_trap_end(trap);
+
+    rw.window = w;
+    rw.x = attrib.x;
+    rw.y = attrib.y;
+    rw.width = attrib.width;
+    rw.height = attrib.height;
+    rw.border = attrib.border_width;
+    write_entry(OB_RECORD_WINDOW, &rw, sizeof(rw), NULL, 0);
+
+    for (i = 0; i < n; ++i)
+        save_property(w, props[i]);
+    if (props) XFree(props);
+}
+
+static void save_property(Window w, Atom a)
+{
+    ObtXErrorTrap *trap;
+    ObRecordProperty rp;
+    Atom type;
+    gint format, result;
+    gulong nitems, left, i;
+    guchar *xdata = NULL;
+    gpointer data;
+    gsize size;
+
+    trap = obt_display_trap_begin();
+    ++obt_display_round_trips;
+    result = XGetWindowProperty(obt_display, w, a, 0, MAX_PROPERTY_LENGTH,
+                                FALSE, AnyPropertyType, &type, &format,
+                                &nitems, &left, &xdata);
+    obt_display_trap_end(trap);
+    if (result != Success || type == None) {
+        if (xdata) XFree(xdata);
+        return;
+    }
+
+    name_atom(a);
+    name_atom(type);
+
+    /* Xlib gives back longs for 32 bit properties */
+    size = nitems * format / 8;
+    if (format == 32) {
+        guint32 *d32 = g_new(guint32, nitems);
+        const gulong *xd32 = (const gulong*)xdata;
+
+        for (i = 0; i < nitems; ++i) {
+            d32[i] = xd32[i];
+            if (type == XA_ATOM)
+                name_atom(xd32[i]);
+        }
+        data = d32;
+    }
+    else if (format == 16) {
+        guint16 *d16 = g_new(guint16, nitems);
+        const gushort *xd16 = (const gushort*)xdata;
+
+        for (i = 0; i < nitems; ++i)
+            d16[i] = xd16[i];
+        data = d16;
+    }
+    else
+        data = g_memdup2(xdata, size);
+    XFree(xdata);
+
+    rp.window = w;
+    rp.atom = a;
+    rp.type = type;
+    rp.format = format;
+    rp.nitems = nitems;
+    write_entry(OB_RECORD_PROPERTY, &rp, sizeof(rp), data, size);
+    g_free(data);
+}
+
+/*! Returns TRUE for the properties which openbox sets on client windows, as
+  a client would not change these itself */
+static gboolean own_property(Atom a)
+{
+    return (a == OBT_PROP_ATOM(WM_STATE) ||
+            a == OBT_PROP_ATOM(NET_WM_STATE) ||
+            a == OBT_PROP_ATOM(NET_WM_DESKTOP) ||
+            a == OBT_PROP_ATOM(NET_WM_ALLOWED_ACTIONS) ||
+            a == OBT_PROP_ATOM(NET_WM_VISIBLE_NAME) ||
+            a == OBT_PROP_ATOM(NET_WM_VISIBLE_ICON_NAME) ||
+            a == OBT_PROP_ATOM(NET_FRAME_EXTENTS) ||
+            a == OBT_PROP_ATOM(KDE_NET_WM_FRAME_STRUT) ||
+            a == OBT_PROP_ATOM(OB_APP_ROLE) ||
+            a == OBT_PROP_ATOM(OB_APP_NAME) ||
+            a == OBT_PROP_ATOM(OB_APP_CLASS) ||
+            a == OBT_PROP_ATOM(OB_APP_GROUP_NAME) ||
+            a == OBT_PROP_ATOM(OB_APP_GROUP_CLASS) ||
+            a == OBT_PROP_ATOM(OB_APP_TITLE) ||
+            a == OBT_PROP_ATOM(OB_APP_TYPE));
+}
+
+gint64 record_start(const XEvent *e)
+{
+    if (!trace) return 0;
+
+    /* save what is needed to replay the event as it was before openbox
+       handled it and changed anything */
+    switch (e->type) {
+    case MapRequest:
+        save_window(e->xmaprequest.window);
+        break;
+    case PropertyNotify:
+        if (e->xproperty.state == PropertyNewValue &&
+            e->xproperty.window != obt_root(ob_screen) &&
+            !own_property(e->xproperty.atom))
+            save_property(e->xproperty.window, e->xproperty.atom);
+        break;
+    }
+    return g_get_monotonic_time();
+}
+
+void record_event(const XEvent *e, gint64 start)
+{
+    ObRecordEvent re;
+
+    if (!trace) return;
+
+    re.handled = MAX(g_get_monotonic_time() - start, 0);
+    re.flags = 0;
+    re.pad = 0;
+    re.event = *e;
+
+    switch (e->type) {
+    case PropertyNotify:
+        name_atom(e->xproperty.atom);
+        if (own_property(e->xproperty.atom))
+            re.flags |= OB_RECORD_FLAG_OWN;
+        break;
+    case ClientMessage:
+        name_atom(e->xclient.message_type);
+        /* the states being changed are atoms too */
+        if (e->xclient.message_type == OBT_PROP_ATOM(NET_WM_STATE)) {
+            name_atom(e->xclient.data.l[1]);
+            name_atom(e->xclient.data.l[2]);
+        }
+        break;
+    }
+
+    write_entry(OB_RECORD_EVENT, &re, sizeof(re), NULL, 0);
+}
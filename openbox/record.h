@@ -0,0 +1,128 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   record.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __record_h
+#define __record_h
+
+#include <X11/Xlib.h>
+#include <glib.h>
+
+/* This file describes the event trace written with --record-events as well,
+   and is used by tests/eventreplay to read it, so it doesn't depend on
+   anything else in openbox. */
+
+#define OB_RECORD_MAGIC   0x5245424fu /* "OBER" */
+#define OB_RECORD_VERSION 1
+
+typedef enum {
+    /*! An ObRecordAtom, which names an atom used in the entries after it */
+    OB_RECORD_ATOM,
+    /*! An ObRecordWindow, for a window that was mapped by a client */
+    OB_RECORD_WINDOW,
+    /*! An ObRecordProperty, with the contents of a client's property */
+    OB_RECORD_PROPERTY,
+    /*! An ObRecordEvent, for an event that openbox handled */
+    OB_RECORD_EVENT
+} ObRecordType;
+
+/*! Events about something that openbox did itself, such as changing a
+  property which it owns on a client window */
+#define OB_RECORD_FLAG_OWN (1 << 0)
+
+typedef struct _ObRecordHeader   ObRecordHeader;
+typedef struct _ObRecordEntry    ObRecordEntry;
+typedef struct _ObRecordAtom     ObRecordAtom;
+typedef struct _ObRecordWindow   ObRecordWindow;
+typedef struct _ObRecordProperty ObRecordProperty;
+typedef struct _ObRecordEvent    ObRecordEvent;
+
+/*! The start of the file.  Xlib's XEvent is written as it is, so the trace
+  can only be read on the same kind of machine that it was written on. */
+struct _ObRecordHeader {
+    guint32 magic;
+    guint32 version;
+    /*! sizeof(XEvent) for the machine which wrote the trace */
+    guint32 event_size;
+    /*! The size of the screen when the trace was recorded */
+    guint32 screen_width;
+    guint32 screen_height;
+    guint32 pad;
+    /*! The root window when the trace was recorded */
+    guint64 root;
+};
+
+/*! The bytes that an entry's data takes up in the file.  Entries are padded
+  so that each one starts on an 8 byte boundary. */
+#define OB_RECORD_PAD(length) (((length) + 7) & ~7u)
+
+/*! Each entry in the file starts with this */
+struct _ObRecordEntry {
+    /*! An ObRecordType */
+    guint32 type;
+    /*! The number of bytes after this which are part of the entry, not
+      counting the padding after them */
+    guint32 length;
+    /*! When the entry was written, in microseconds since the recording
+      started */
+    guint64 time;
+};
+
+/*! The atom's name follows this, without a '\0' on the end */
+struct _ObRecordAtom {
+    guint64 atom;
+};
+
+struct _ObRecordWindow {
+    guint64 window;
+    gint32 x, y;
+    guint32 width, height;
+    guint32 border;
+};
+
+/*! The property's data follows this.  Each item is 8, 16 or 32 bits long,
+  as given by the format. */
+struct _ObRecordProperty {
+    guint64 window;
+    guint64 atom;
+    guint64 type;
+    guint32 format;
+    guint32 nitems;
+};
+
+struct _ObRecordEvent {
+    /*! The time that openbox took to handle the event, in microseconds */
+    guint64 handled;
+    /*! The OB_RECORD_FLAG_* flags for the event */
+    guint32 flags;
+    guint32 pad;
+    XEvent event;
+};
+
+void record_startup(gboolean reconfig);
+void record_shutdown(gboolean reconfig);
+
+/*! Call before the event is handled.  This saves any state from the X server
+  which is needed to replay it, such as a client's properties when it is
+  mapped.
+  @return The time to pass to record_event()
+*/
+gint64 record_start(const XEvent *e);
+/*! Writes the event to the trace, after it has been handled since @start */
+void record_event(const XEvent *e, gint64 start);
+
+#endif
@@ -27,6 +27,224 @@
 
 #include <glib.h>
 
+/*! The sides of the frames which are kept in the index */
+typedef enum {
+    EDGE_LEFT,
+    EDGE_RIGHT,
+    EDGE_TOP,
+    EDGE_BOTTOM,
+    NUM_EDGES
+} ObResistEdgeSide;
+
+typedef struct _ObResistEdge {
+    gint pos;
+    ObClient *client;
+} ObResistEdge;
+
+/*! The frame edges of the windows on one desktop, for each side, sorted by
+  their position */
+typedef struct _ObResistDesktop {
+    GSequence *edges[NUM_EDGES];
+} ObResistDesktop;
+
+/*! Where a client's edges are in the index */
+typedef struct _ObResistEntry {
+    guint desktop;
+    Rect area;
+    GSequenceIter *edge[NUM_EDGES];
+} ObResistEntry;
+
+/*! A range of positions to look for edges in, including both ends */
+typedef struct _ObResistRange {
+    gint lo;
+    gint hi;
+} ObResistRange;
+
+/*! Maps a desktop number (or DESKTOP_ALL) to its ObResistDesktop */
+static GHashTable *desktops = NULL;
+/*! Maps an ObClient* to its ObResistEntry */
+static GHashTable *entries = NULL;
+
+static void edge_free(ObResistEdge *e)
+{
+    g_slice_free(ObResistEdge, e);
+}
+
+static gint edge_cmp(gconstpointer a, gconstpointer b, gpointer data)
+{
+    const ObResistEdge *ea = a, *eb = b;
+
+    if (ea->pos != eb->pos)
+        return ea->pos < eb->pos ? -1 : 1;
+    if (ea->client != eb->client)
+        return ea->client < eb->client ? -1 : 1;
+    return 0;
+}
+
+static void desktop_free(ObResistDesktop *d)
+{
+    gint i;
+
+    for (i = 0; i < NUM_EDGES; ++i)
+        g_sequence_free(d->edges[i]);
+    g_slice_free(ObResistDesktop, d);
+}
+
+static void entry_remove_edges(ObResistEntry *e)
+{
+    gint i;
+
+    for (i = 0; i < NUM_EDGES; ++i)
+        g_sequence_remove(e->edge[i]);
+}
+
+static void entry_free(ObResistEntry *e)
+{
+    entry_remove_edges(e);
+    g_slice_free(ObResistEntry, e);
+}
+
+void resist_startup(gboolean reconfig)
+{
+    if (reconfig) return;
+
+    desktops = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                     (GDestroyNotify)desktop_free);
+    entries = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                    (GDestroyNotify)entry_free);
+}
+
+void resist_shutdown(gboolean reconfig)
+{
+    if (reconfig) return;
+
+    /* the entries point into the desktops' edges */
+    g_hash_table_destroy(entries);
+    entries = NULL;
+    g_hash_table_destroy(desktops);
+    desktops = NULL;
+}
+
+static ObResistDesktop* desktop_get(guint desktop, gboolean create)
+{
+    ObResistDesktop *d;
+    gint i;
+
+    d = g_hash_table_lookup(desktops, GUINT_TO_POINTER(desktop));
+    if (!d && create) {
+        d = g_slice_new(ObResistDesktop);
+        for (i = 0; i < NUM_EDGES; ++i)
+            d->edges[i] = g_sequence_new((GDestroyNotify)edge_free);
+        g_hash_table_insert(desktops, GUINT_TO_POINTER(desktop), d);
+    }
+    return d;
+}
+
+static GSequenceIter* edge_add(GSequence *edges, gint pos, ObClient *c)
+{
+    ObResistEdge *e = g_slice_new(ObResistEdge);
+
+    e->pos = pos;
+    e->client = c;
+    return g_sequence_insert_sorted(edges, e, edge_cmp, NULL);
+}
+
+void resist_update_client(ObClient *c)
+{
+    ObResistEntry *e;
+    ObResistDesktop *d;
+
+    e = g_hash_table_lookup(entries, c);
+    if (e) {
+        if (e->desktop == c->desktop && RECT_EQUAL(e->area, c->frame->area))
+            return;
+        entry_remove_edges(e);
+    }
+    else {
+        e = g_slice_new(ObResistEntry);
+        g_hash_table_insert(entries, c, e);
+    }
+
+    e->desktop = c->desktop;
+    e->area = c->frame->area;
+
+    d = desktop_get(c->desktop, TRUE);
+    e->edge[EDGE_LEFT] = edge_add(d->edges[EDGE_LEFT],
+                                  RECT_LEFT(e->area), c);
+    e->edge[EDGE_RIGHT] = edge_add(d->edges[EDGE_RIGHT],
+                                   RECT_RIGHT(e->area), c);
+    e->edge[EDGE_TOP] = edge_add(d->edges[EDGE_TOP],
+                                 RECT_TOP(e->area), c);
+    e->edge[EDGE_BOTTOM] = edge_add(d->edges[EDGE_BOTTOM],
+                                    RECT_BOTTOM(e->area), c);
+}
+
+void resist_remove_client(ObClient *c)
+{
+    g_hash_table_remove(entries, c);
+}
+
+/*! Returns TRUE if the client @c should be able to snap to @target */
+static gboolean resist_target_ok(ObClient *c, ObClient *target)
+{
+    /* don't snap to self or non-visibles */
+    if (!target->frame->visible || target == c)
+        return FALSE;
+    /* don't snap to windows set to below and skip_taskbar (desklets) */
+    if (target->below && !c->below && target->skip_taskbar)
+        return FALSE;
+    return TRUE;
+}
+
+/*! Finds the highest window in the stacking order below position @after
+  which has one of its sides in the given ranges, and that @c can snap to.
+  @after is set to the window's position.
+*/
+static ObClient* resist_next_target(ObClient *c,
+                                    const ObResistRange range[NUM_EDGES],
+                                    gint *after)
+{
+    const guint desks[2] = { screen_desktop, DESKTOP_ALL };
+    ObClient *best = NULL;
+    gint bestpos = G_MAXINT;
+    gint i, j;
+
+    for (i = 0; i < 2; ++i) {
+        ObResistDesktop *d = desktop_get(desks[i], FALSE);
+
+        if (!d) continue;
+        for (j = 0; j < NUM_EDGES; ++j) {
+            ObResistEdge probe;
+            GSequenceIter *it;
+
+            if (range[j].lo > range[j].hi) continue;
+
+            /* no client is less than NULL, so this finds the first edge at
+               or after lo */
+            probe.pos = range[j].lo;
+            probe.client = NULL;
+            for (it = g_sequence_search(d->edges[j], &probe, edge_cmp, NULL);
+                 !g_sequence_iter_is_end(it);
+                 it = g_sequence_iter_next(it))
+            {
+                ObResistEdge *e = g_sequence_get(it);
+                gint pos;
+
+                if (e->pos > range[j].hi) break;
+                if (!resist_target_ok(c, e->client)) continue;
+
+                pos = stacking_position(CLIENT_AS_WINDOW(e->client));
+                if (pos > *after && pos < bestpos) {
+                    best = e->client;
+                    bestpos = pos;
+                }
+            }
+        }
+    }
+    *after = bestpos;
+    return best;
+}
+
 static gboolean resist_move_window(Rect window,
                                    Rect target, gint resist,
                                    gint *x, gint *y)
@@ -101,32 +319,39 @@ static gboolean resist_move_window(Rect window,
 
 void resist_move_windows(ObClient *c, gint resist, gint *x, gint *y)
 {
-    GList *it;
+    ObClient *target;
+    ObResistRange range[NUM_EDGES];
+    gint after = -1;
     Rect dock_area;
 
     if (!resist) return;
 
     frame_client_gravity(c->frame, x, y);
 
+    /* go down the stacking order, only visiting the windows with a side close
+       enough for resist_move_window to snap to.  snapping moves the window,
+       so look for them around its new position each time */
+    do {
+        gint l, t, r, b; /* requested edges */
+
+        l = *x;
+        t = *y;
+        r = l + c->frame->area.width - 1;
+        b = t + c->frame->area.height - 1;
+
+        range[EDGE_LEFT].lo = r - resist + 1;
+        range[EDGE_LEFT].hi = r;
+        range[EDGE_RIGHT].lo = l;
+        range[EDGE_RIGHT].hi = l + resist - 1;
+        range[EDGE_TOP].lo = b - resist + 1;
+        range[EDGE_TOP].hi = b;
+        range[EDGE_BOTTOM].lo = t;
+        range[EDGE_BOTTOM].hi = t + resist - 1;
+
+        target = resist_next_target(c, range, &after);
+    } while (target && !resist_move_window(c->frame->area, target->frame->area,
+                                           resist, x, y));
 
-    for (it = stacking_list; it; it = g_list_next(it)) {
-        ObClient *target;
-
-        if (!WINDOW_IS_CLIENT(it->data))
-            continue;
-        target = it->data;
-
-        /* don't snap to self or non-visibles */
-        if (!target->frame->visible || target == c)
-            continue;
-        /* don't snap to windows set to below and skip_taskbar (desklets) */
-        if (target->below && !c->below && target->skip_taskbar)
-            continue;
-
-        if (resist_move_window(c->frame->area, target->frame->area,
-                               resist, x, y))
-            break;
-    }
     dock_get_area(&dock_area);
     resist_move_window(c->frame->area, dock_area, resist, x, y);
 
@@ -292,28 +517,36 @@ static gboolean resist_size_window(Rect window, Rect target, gint resist,
 void resist_size_windows(ObClient *c, gint resist, gint *w, gint *h,
                          ObDirection dir)
 {
-    GList *it;
     ObClient *target; /* target */
+    ObResistRange range[NUM_EDGES];
+    gint after = -1;
     Rect dock_area;
 
     if (!resist) return;
 
-    for (it = stacking_list; it; it = g_list_next(it)) {
-        if (!WINDOW_IS_CLIENT(it->data))
-            continue;
-        target = it->data;
-
-        /* don't snap to invisibles or ourself */
-        if (!target->frame->visible || target == c)
-            continue;
-        /* don't snap to windows set to below and skip_taskbar (desklets) */
-        if (target->below && !c->below && target->skip_taskbar)
-            continue;
+    /* like resist_move_windows, only visit the windows with a side close
+       enough to snap to, for any direction */
+    do {
+        gint dl, dt, dr, db; /* my destination sides */
+
+        dl = RECT_LEFT(c->frame->area) - *w + c->frame->area.width;
+        dt = RECT_TOP(c->frame->area) - *h + c->frame->area.height;
+        dr = RECT_RIGHT(c->frame->area) + *w - c->frame->area.width;
+        db = RECT_BOTTOM(c->frame->area) + *h - c->frame->area.height;
+
+        range[EDGE_LEFT].lo = dr - resist + 1;
+        range[EDGE_LEFT].hi = dr;
+        range[EDGE_RIGHT].lo = dl;
+        range[EDGE_RIGHT].hi = dl + resist - 1;
+        range[EDGE_TOP].lo = db - resist + 1;
+        range[EDGE_TOP].hi = db;
+        range[EDGE_BOTTOM].lo = dt;
+        range[EDGE_BOTTOM].hi = dt + resist - 1;
+
+        target = resist_next_target(c, range, &after);
+    } while (target && !resist_size_window(c->frame->area, target->frame->area,
+                                           resist, w, h, dir));
 
-        if (resist_size_window(c->frame->area, target->frame->area,
-                               resist, w, h, dir))
-            break;
-    }
     dock_get_area(&dock_area);
     resist_size_window(c->frame->area, dock_area,
                        resist, w, h, dir);
@@ -25,6 +25,15 @@
 
 struct _ObClient;
 
+void resist_startup(gboolean reconfig);
+void resist_shutdown(gboolean reconfig);
+
+/*! Updates the index of window edges for the client's frame area and
+  desktop.  Call this when either of them changes. */
+void resist_update_client(struct _ObClient *c);
+/*! Takes the client's edges out of the index */
+void resist_remove_client(struct _ObClient *c);
+
 /*! @x The client's x destination (in the client's coordinates, not the frame's
     @y The client's y destination (in the client's coordinates, not the frame's
 */
@@ -45,6 +45,7 @@
 #  include <unistd.h>
 #endif
 #include <assert.h>
+#include <string.h>
 
 /*! The event mask to grab on the root window */
 #define ROOT_EVENTMASK (StructureNotifyMask | PropertyChangeMask | \
@@ -79,6 +80,14 @@ static GSList *struts_left = NULL;
 static GSList *struts_right = NULL;
 static GSList *struts_bottom = NULL;
 
+/*! The work area for each desktop and monitor, as screen_area() finds it
+  with no search area.  Each desktop has a row, with DESKTOP_ALL last, and
+  each row has a Rect for each monitor and then SCREEN_AREA_ALL_MONITORS. */
+static Rect  *work_areas = NULL;
+/*! The number of desktops and monitors that work_areas was made for */
+static guint  work_areas_desktops = 0;
+static guint  work_areas_monitors = 0;
+
 static ObPagerPopup *desktop_popup;
 static guint         desktop_popup_timer = 0;
 static gboolean      desktop_popup_perm;
@@ -111,7 +120,7 @@ static gboolean replace_wm(void)
 
         /* We want to find out when the current selection owner dies */
         XSelectInput(obt_display, current_wm_sn_owner, StructureNotifyMask);
-        XSync(obt_display, FALSE);
+        obt_display_sync();
 
         obt_display_ignore_errors(FALSE);
         if (obt_display_error_occured)
@@ -478,6 +487,10 @@ void screen_shutdown(gboolean reconfig)
 
     g_strfreev(screen_desktop_names);
     screen_desktop_names = NULL;
+
+    g_free(work_areas);
+    work_areas = NULL;
+    work_areas_desktops = work_areas_monitors = 0;
 }
 
 void screen_resize(void)
@@ -1320,12 +1333,12 @@ void screen_install_colormap(ObClient *client, gboolean install)
         else
             XUninstallColormap(obt_display, RrColormap(ob_rr_inst));
     } else {
-        obt_display_ignore_errors(TRUE);
+        ObtXErrorTrap *trap = obt_display_trap_begin();
         if (install)
             XInstallColormap(obt_display, client->colormap);
         else
             XUninstallColormap(obt_display, client->colormap);
-        obt_display_ignore_errors(FALSE);
+        obt_display_trap_end(trap);
     }
 }
 
@@ -1415,31 +1428,10 @@ static void get_xinerama_screens(Rect **xin_areas, guint *nxin)
              (*xin_areas)[i].width, (*xin_areas)[i].height);
 }
 
-void screen_update_areas(void)
+/*! Finds the struts that affect each side of the screen again */
+static void collect_struts(void)
 {
-    guint i;
-    gulong *dims;
-    GList *it, *onscreen;
-
-    /* collect the clients that are on screen */
-    onscreen = NULL;
-    for (it = client_list; it; it = g_list_next(it)) {
-        if (client_monitor(it->data) != screen_num_monitors)
-            onscreen = g_list_prepend(onscreen, it->data);
-    }
-
-    g_free(monitor_area);
-    get_xinerama_screens(&monitor_area, &screen_num_monitors);
-
-    /* set up the user-specified margins */
-    config_margins.top_start = RECT_LEFT(monitor_area[screen_num_monitors]);
-    config_margins.top_end = RECT_RIGHT(monitor_area[screen_num_monitors]);
-    config_margins.bottom_start = RECT_LEFT(monitor_area[screen_num_monitors]);
-    config_margins.bottom_end = RECT_RIGHT(monitor_area[screen_num_monitors]);
-    config_margins.left_start = RECT_TOP(monitor_area[screen_num_monitors]);
-    config_margins.left_end = RECT_BOTTOM(monitor_area[screen_num_monitors]);
-    config_margins.right_start = RECT_TOP(monitor_area[screen_num_monitors]);
-    config_margins.right_end = RECT_BOTTOM(monitor_area[screen_num_monitors]);
+    GList *it;
 
     RESET_STRUT_LIST(struts_left);
     RESET_STRUT_LIST(struts_top);
@@ -1484,26 +1476,194 @@ void screen_update_areas(void)
                     monitor_area[screen_num_monitors].height / 2);
     VALIDATE_STRUTS(struts_bottom, bottom,
                     monitor_area[screen_num_monitors].height / 2);
+}
+
+static Rect* work_area(guint desktop, guint head)
+{
+    const guint d = (desktop == DESKTOP_ALL ? work_areas_desktops : desktop);
+    const guint h = (head == SCREEN_AREA_ALL_MONITORS ?
+                     work_areas_monitors : head);
+    return &work_areas[d * (work_areas_monitors + 1) + h];
+}
+
+static void compute_area(guint desktop, guint head, Rect *search, Rect *a);
+
+/*! Finds the work areas for one desktop's row in the table again */
+static void update_work_areas(guint desktop)
+{
+    guint i;
+
+    for (i = 0; i < screen_num_monitors; ++i)
+        compute_area(desktop, i, NULL, work_area(desktop, i));
+    compute_area(desktop, SCREEN_AREA_ALL_MONITORS, NULL,
+                 work_area(desktop, SCREEN_AREA_ALL_MONITORS));
+}
+
+/*! Sets the legacy workarea hint to the union of all the monitors */
+static void set_workarea_hint(void)
+{
+    guint i;
+    gulong *dims;
 
     dims = g_new(gulong, 4 * screen_num_desktops);
     for (i = 0; i < screen_num_desktops; ++i) {
-        Rect *area = screen_area(i, SCREEN_AREA_ALL_MONITORS, NULL);
+        const Rect *area = work_area(i, SCREEN_AREA_ALL_MONITORS);
         dims[i*4+0] = area->x;
         dims[i*4+1] = area->y;
         dims[i*4+2] = area->width;
         dims[i*4+3] = area->height;
-        g_slice_free(Rect, area);
     }
-
-    /* set the legacy workarea hint to the union of all the monitors */
     OBT_PROP_SETA32(obt_root(ob_screen), NET_WORKAREA, CARDINAL,
                     dims, 4 * screen_num_desktops);
+    g_free(dims);
+}
 
-    /* the area has changed, adjust all the windows if they need it */
-    for (it = onscreen; it; it = g_list_next(it))
-        client_reconfigure(it->data, FALSE);
+void screen_update_areas(void)
+{
+    guint i, old_num_monitors;
+    Rect *old_monitor_area, *old_work_areas;
+    gboolean changed;
+    GList *it, *onscreen;
 
-    g_free(dims);
+    /* collect the clients that are on screen */
+    onscreen = NULL;
+    for (it = client_list; it; it = g_list_next(it)) {
+        if (client_monitor(it->data) != screen_num_monitors)
+            onscreen = g_list_prepend(onscreen, it->data);
+    }
+
+    old_monitor_area = monitor_area;
+    old_num_monitors = screen_num_monitors;
+    get_xinerama_screens(&monitor_area, &screen_num_monitors);
+
+    /* set up the user-specified margins */
+    config_margins.top_start = RECT_LEFT(monitor_area[screen_num_monitors]);
+    config_margins.top_end = RECT_RIGHT(monitor_area[screen_num_monitors]);
+    config_margins.bottom_start = RECT_LEFT(monitor_area[screen_num_monitors]);
+    config_margins.bottom_end = RECT_RIGHT(monitor_area[screen_num_monitors]);
+    config_margins.left_start = RECT_TOP(monitor_area[screen_num_monitors]);
+    config_margins.left_end = RECT_BOTTOM(monitor_area[screen_num_monitors]);
+    config_margins.right_start = RECT_TOP(monitor_area[screen_num_monitors]);
+    config_margins.right_end = RECT_BOTTOM(monitor_area[screen_num_monitors]);
+
+    collect_struts();
+
+    /* build the whole table again, the monitors or desktops may have
+       changed */
+    old_work_areas = work_areas;
+    changed = (old_num_monitors != screen_num_monitors ||
+               work_areas_desktops != screen_num_desktops ||
+               !old_monitor_area || !old_work_areas ||
+               memcmp(old_monitor_area, monitor_area,
+                      sizeof(Rect) * (screen_num_monitors + 1)));
+    work_areas_desktops = screen_num_desktops;
+    work_areas_monitors = screen_num_monitors;
+    work_areas = g_new(Rect, (work_areas_desktops + 1) *
+                       (work_areas_monitors + 1));
+    for (i = 0; i < screen_num_desktops; ++i)
+        update_work_areas(i);
+    update_work_areas(DESKTOP_ALL);
+    if (!changed)
+        changed = memcmp(old_work_areas, work_areas,
+                         sizeof(Rect) * (work_areas_desktops + 1) *
+                         (work_areas_monitors + 1));
+    g_free(old_work_areas);
+    g_free(old_monitor_area);
+
+    set_workarea_hint();
+
+    /* the area has changed, adjust all the windows if they need it.  this
+       is called whenever the dock is configured, which usually doesn't
+       change anything */
+    if (changed)
+        for (it = onscreen; it; it = g_list_next(it))
+            client_reconfigure(it->data, FALSE);
+    g_list_free(onscreen);
+}
+
+/*! Finds the areas of the screen that a strut can cover, which are the only
+  places where it can change the work area.
+  @return The number of areas in @bands
+*/
+static guint strut_bands(const StrutPartial *s, Rect bands[4])
+{
+    const Rect *all = &monitor_area[screen_num_monitors];
+    guint n = 0;
+
+    if (s->left)
+        RECT_SET(bands[n++], RECT_LEFT(*all), s->left_start,
+                 s->left, s->left_end - s->left_start + 1);
+    if (s->right)
+        RECT_SET(bands[n++], RECT_RIGHT(*all) - s->right + 1,
+                 s->right_start,
+                 s->right, s->right_end - s->right_start + 1);
+    if (s->top)
+        RECT_SET(bands[n++], s->top_start, RECT_TOP(*all),
+                 s->top_end - s->top_start + 1, s->top);
+    if (s->bottom)
+        RECT_SET(bands[n++], s->bottom_start,
+                 RECT_BOTTOM(*all) - s->bottom + 1,
+                 s->bottom_end - s->bottom_start + 1, s->bottom);
+    return n;
+}
+
+void screen_update_client_strut(const StrutPartial *old_strut,
+                                guint old_desktop,
+                                const StrutPartial *new_strut,
+                                guint new_desktop)
+{
+    Rect bands[8];
+    guint i, nbands;
+    GList *it;
+
+    /* without a full table, there is nothing to update in place */
+    if (!work_areas || work_areas_desktops != screen_num_desktops ||
+        work_areas_monitors != screen_num_monitors)
+    {
+        screen_update_areas();
+        return;
+    }
+
+    collect_struts();
+
+    /* only the rows for the desktops the strut was on and is on now can
+       change, and the row for all desktops, which they are a part of */
+    if (old_desktop == DESKTOP_ALL || new_desktop == DESKTOP_ALL)
+        for (i = 0; i < screen_num_desktops; ++i)
+            update_work_areas(i);
+    else {
+        if (old_desktop < screen_num_desktops)
+            update_work_areas(old_desktop);
+        if (new_desktop != old_desktop && new_desktop < screen_num_desktops)
+            update_work_areas(new_desktop);
+    }
+    update_work_areas(DESKTOP_ALL);
+
+    set_workarea_hint();
+
+    /* adjust the windows on those desktops which are near enough to the
+       struts to be affected by them */
+    nbands = strut_bands(old_strut, bands);
+    nbands += strut_bands(new_strut, bands + nbands);
+    for (it = client_list; it; it = g_list_next(it)) {
+        ObClient *c = it->data;
+        guint m;
+
+        if (!(c->desktop == old_desktop || c->desktop == new_desktop ||
+              c->desktop == DESKTOP_ALL ||
+              old_desktop == DESKTOP_ALL || new_desktop == DESKTOP_ALL))
+            continue;
+        if ((m = client_monitor(c)) == screen_num_monitors)
+            continue; /* not on screen */
+
+        for (i = 0; i < nbands; ++i)
+            if (RECT_INTERSECTS_RECT(bands[i], c->frame->area) ||
+                RECT_INTERSECTS_RECT(bands[i], monitor_area[m]))
+            {
+                client_reconfigure(c, FALSE);
+                break;
+            }
+    }
 }
 
 #if 0
@@ -1562,16 +1722,31 @@ Rect* screen_area_all_monitors(guint desktop)
 Rect* screen_area(guint desktop, guint head, Rect *search)
 {
     Rect *a;
-    GSList *it;
-    gint l, r, t, b;
-    guint i, d;
-    gboolean us = search != NULL; /* user provided search */
 
     g_assert(desktop < screen_num_desktops || desktop == DESKTOP_ALL);
     g_assert(head < screen_num_monitors || head == SCREEN_AREA_ONE_MONITOR ||
              head == SCREEN_AREA_ALL_MONITORS);
     g_assert(!(head == SCREEN_AREA_ONE_MONITOR && search == NULL));
 
+    a = g_slice_new(Rect);
+    /* the table is out of date while the desktops or monitors are being
+       changed, until screen_update_areas() is called */
+    if (!search && work_areas &&
+        work_areas_desktops == screen_num_desktops &&
+        work_areas_monitors == screen_num_monitors)
+        *a = *work_area(desktop, head);
+    else
+        compute_area(desktop, head, search, a);
+    return a;
+}
+
+static void compute_area(guint desktop, guint head, Rect *search, Rect *a)
+{
+    GSList *it;
+    gint l, r, t, b;
+    guint i, d;
+    gboolean us = search != NULL; /* user provided search */
+
     /* find any struts for this monitor
        which will be affecting the search area.
     */
@@ -1664,12 +1839,10 @@ Rect* screen_area(guint desktop, guint head, Rect *search)
         }
     }
 
-    a = g_slice_new(Rect);
     a->x = l;
     a->y = t;
     a->width = r - l + 1;
     a->height = b - t + 1;
-    return a;
 }
 
 typedef struct {
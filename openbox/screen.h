@@ -112,8 +112,19 @@ void screen_update_desktop_names(void);
   it handles the root colormap. */
 void screen_install_colormap(struct _ObClient *client, gboolean install);
 
+/*! Finds the monitors and the work areas for all of them again, and adjusts
+  the windows if they changed */
 void screen_update_areas(void);
 
+/*! Updates the work areas when a client's strut changes, or it moves to
+  another desktop.  Only the work areas for the desktops it was and is on are
+  found again, and only the windows near the strut are adjusted.  Pass an
+  empty strut for a client which did not have one, or no longer does. */
+void screen_update_client_strut(const StrutPartial *old_strut,
+                                guint old_desktop,
+                                const StrutPartial *new_strut,
+                                guint new_desktop);
+
 const Rect* screen_physical_area_all_monitors(void);
 
 /*! Returns a Rect which is owned by the screen code and should not be freed */
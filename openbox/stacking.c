@@ -37,31 +37,248 @@ GList  *stacking_list_tail = NULL;
   raised during focus cycling */
 static gboolean pause_changes = FALSE;
 
-void stacking_set_list(void)
+/*! The position of a window in the stacking_list */
+typedef struct _ObStackingHandle {
+    GList *link;
+    /*! The layer the window was in when it was put in the stacking_list.  A
+      client's layer is changed before it is removed from the list, so this
+      is what must be used to keep the layer_top index correct */
+    ObStackingLayer layer;
+    /*! How many windows are above this one, valid when positions_valid is
+      TRUE */
+    gint position;
+} ObStackingHandle;
+
+/*! Maps an ObWindow* to its ObStackingHandle */
+static GHashTable *stacking_map = NULL;
+/*! The highest link in the stacking_list for each layer, or NULL if there is
+  nothing in the layer */
+static GList *layer_top[OB_NUM_STACKING_LAYERS];
+/*! Set to FALSE when the stacking order changes, and the positions in the
+  handles need to be counted again */
+static gboolean positions_valid = FALSE;
+/*! The _NET_CLIENT_LIST_STACKING property is written from a callback in the
+  main loop, so that many changes to the stacking order only set it once.
+  Like _NET_CLIENT_LIST, it has the same priority as the X events */
+static guint stacking_list_idle_id = 0;
+/*! The window ids last written to _NET_CLIENT_LIST_STACKING */
+static Window *stacking_windows = NULL;
+static guint stacking_windows_num = 0;
+static guint stacking_windows_size = 0;
+static gboolean stacking_windows_valid = FALSE;
+
+static void handle_free(ObStackingHandle *h)
+{
+    g_slice_free(ObStackingHandle, h);
+}
+
+void stacking_startup(gboolean reconfig)
+{
+    if (reconfig) return;
+
+    stacking_map = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                         NULL, (GDestroyNotify)handle_free);
+}
+
+void stacking_shutdown(gboolean reconfig)
+{
+    gint i;
+
+    if (reconfig) return;
+
+    /* the stacking order is not written on shutdown anyways */
+    if (stacking_list_idle_id) {
+        g_source_remove(stacking_list_idle_id);
+        stacking_list_idle_id = 0;
+    }
+
+    g_hash_table_destroy(stacking_map);
+    stacking_map = NULL;
+    g_list_free(stacking_list);
+    stacking_list = stacking_list_tail = NULL;
+    for (i = 0; i < OB_NUM_STACKING_LAYERS; ++i)
+        layer_top[i] = NULL;
+    positions_valid = FALSE;
+
+    g_free(stacking_windows);
+    stacking_windows = NULL;
+    stacking_windows_num = stacking_windows_size = 0;
+    stacking_windows_valid = FALSE;
+}
+
+/*! Returns the highest link in the given layer or any layer below it, which is
+  the position to insert before to be at the top of the layer */
+static GList* layer_start(gint layer)
+{
+    for (; layer >= 0; --layer)
+        if (layer_top[layer]) return layer_top[layer];
+    return NULL;
+}
+
+/*! Returns the lowest link in the given layer, or NULL if it is empty */
+static GList* layer_bottom(gint layer)
+{
+    GList *below;
+
+    if (!layer_top[layer]) return NULL;
+    below = layer_start(layer - 1);
+    return below ? g_list_previous(below) : stacking_list_tail;
+}
+
+/*! Puts the window into the stacking_list directly above the given link, or
+  at the bottom if before is NULL */
+static void stacking_link(ObWindow *win, GList *before)
+{
+    ObStackingHandle *h;
+    GList *link;
+
+    g_assert(g_hash_table_lookup(stacking_map, win) == NULL);
+
+    link = g_list_alloc();
+    link->data = win;
+    link->next = before;
+    if (before) {
+        link->prev = before->prev;
+        before->prev = link;
+    }
+    else {
+        link->prev = stacking_list_tail;
+        stacking_list_tail = link;
+    }
+    if (link->prev)
+        link->prev->next = link;
+    else
+        stacking_list = link;
+
+    h = g_slice_new(ObStackingHandle);
+    h->link = link;
+    h->layer = window_layer(win);
+    /* the layers are kept in order in the list, so the window is the new top
+       of its layer if it went directly above the old top */
+    if (!layer_top[h->layer] || layer_top[h->layer] == before)
+        layer_top[h->layer] = link;
+    g_hash_table_insert(stacking_map, win, h);
+    positions_valid = FALSE;
+}
+
+/*! Takes the window out of the stacking_list, returns FALSE if it was not
+  in it */
+static gboolean stacking_unlink(ObWindow *win)
+{
+    ObStackingHandle *h;
+    GList *link;
+
+    if (!(h = g_hash_table_lookup(stacking_map, win)))
+        return FALSE;
+    link = h->link;
+
+    if (layer_top[h->layer] == link) {
+        ObStackingHandle *next = NULL;
+
+        if (link->next)
+            next = g_hash_table_lookup(stacking_map, link->next->data);
+        layer_top[h->layer] =
+            (next && next->layer == h->layer) ? link->next : NULL;
+    }
+
+    if (link->prev)
+        link->prev->next = link->next;
+    else
+        stacking_list = link->next;
+    if (link->next)
+        link->next->prev = link->prev;
+    else
+        stacking_list_tail = link->prev;
+
+    g_list_free_1(link);
+    g_hash_table_remove(stacking_map, win);
+    positions_valid = FALSE;
+    return TRUE;
+}
+
+/*! Returns the link for the window in the stacking_list, or NULL */
+static GList* stacking_find(ObWindow *win)
+{
+    ObStackingHandle *h = g_hash_table_lookup(stacking_map, win);
+    return h ? h->link : NULL;
+}
+
+void stacking_remove(ObWindow *win)
+{
+    stacking_unlink(win);
+}
+
+gint stacking_position(ObWindow *win)
+{
+    ObStackingHandle *h;
+
+    if (!positions_valid) {
+        GList *it;
+        gint i;
+
+        for (it = stacking_list, i = 0; it; it = g_list_next(it), ++i) {
+            h = g_hash_table_lookup(stacking_map, it->data);
+            h->position = i;
+        }
+        positions_valid = TRUE;
+    }
+
+    h = g_hash_table_lookup(stacking_map, win);
+    return h ? h->position : -1;
+}
+
+static gboolean stacking_set_list_idle(gpointer data)
 {
-    Window *windows = NULL;
     GList *it;
-    guint i = 0;
+    guint i = 0, n;
+    gboolean changed;
+
+    stacking_list_idle_id = 0;
 
     /* on shutdown, don't update the properties, so that we can read it back
        in on startup and re-stack the windows as they were before we shut down
     */
-    if (ob_state() == OB_STATE_EXITING) return;
-
-    /* create an array of the window ids (from bottom to top,
-       reverse order!) */
-    if (stacking_list) {
-        windows = g_new(Window, g_list_length(stacking_list));
-        for (it = g_list_last(stacking_list); it; it = g_list_previous(it)) {
-            if (WINDOW_IS_CLIENT(it->data))
-                windows[i++] = WINDOW_AS_CLIENT(it->data)->window;
-        }
+    if (ob_state() == OB_STATE_EXITING) return FALSE;
+
+    /* make sure there is room for every window in the list */
+    n = g_hash_table_size(stacking_map);
+    if (n > stacking_windows_size) {
+        stacking_windows_size = MAX(n, stacking_windows_size * 2);
+        stacking_windows = g_renew(Window, stacking_windows,
+                                   stacking_windows_size);
     }
 
-    OBT_PROP_SETA32(obt_root(ob_screen), NET_CLIENT_LIST_STACKING, WINDOW,
-                    (gulong*)windows, i);
+    /* fill in the window ids (from bottom to top, reverse order!), and see
+       if they are any different from what was written last time */
+    changed = !stacking_windows_valid;
+    for (it = stacking_list_tail; it; it = g_list_previous(it)) {
+        if (WINDOW_IS_CLIENT(it->data)) {
+            Window w = WINDOW_AS_CLIENT(it->data)->window;
+            if (changed || stacking_windows[i] != w) {
+                stacking_windows[i] = w;
+                changed = TRUE;
+            }
+            ++i;
+        }
+    }
+    if (i != stacking_windows_num)
+        changed = TRUE;
+    stacking_windows_num = i;
+
+    if (changed) {
+        OBT_PROP_SETA32(obt_root(ob_screen), NET_CLIENT_LIST_STACKING, WINDOW,
+                        (gulong*)stacking_windows, i);
+        stacking_windows_valid = TRUE;
+    }
+    return FALSE; /* don't repeat */
+}
 
-    g_free(windows);
+void stacking_set_list(void)
+{
+    if (!stacking_list_idle_id)
+        stacking_list_idle_id = g_idle_add_full(G_PRIORITY_DEFAULT,
+                                                stacking_set_list_idle,
+                                                NULL, NULL);
 }
 
 static void do_restack(GList *wins, GList *before)
@@ -89,7 +306,7 @@ static void do_restack(GList *wins, GList *before)
     if (before == stacking_list)
         win[0] = screen_support_win;
     else if (!before)
-        win[0] = window_top(g_list_last(stacking_list)->data);
+        win[0] = window_top(stacking_list_tail->data);
     else
         win[0] = window_top(g_list_previous(before)->data);
 
@@ -97,7 +314,7 @@ static void do_restack(GList *wins, GList *before)
         win[i] = window_top(it->data);
         g_assert(win[i] != None); /* better not call stacking shit before
                                      setting your top level window value */
-        stacking_list = g_list_insert_before(stacking_list, before, it->data);
+        stacking_link(it->data, before);
     }
 
 #ifdef DEBUG
@@ -125,15 +342,11 @@ void stacking_temp_raise(ObWindow *window)
     /* don't use this for internal windows..! it would lower them.. */
     g_assert(window_layer(window) < OB_STACKING_LAYER_INTERNAL);
 
-    /* find the window to drop it underneath */
-    win[0] = screen_support_win;
-    for (it = stacking_list; it; it = g_list_next(it)) {
-        ObWindow *w = it->data;
-        if (window_layer(w) >= OB_STACKING_LAYER_INTERNAL)
-            win[0] = window_top(w);
-        else
-            break;
-    }
+    /* find the window to drop it underneath, the bottom internal window */
+    if ((it = layer_bottom(OB_STACKING_LAYER_INTERNAL)))
+        win[0] = window_top(it->data);
+    else
+        win[0] = screen_support_win;
 
     win[1] = window_top(window);
     start = event_start_ignore_all_enters();
@@ -175,15 +388,10 @@ static void do_raise(GList *wins)
         layer[l] = g_list_append(layer[l], it->data);
     }
 
-    it = stacking_list;
     for (i = OB_NUM_STACKING_LAYERS - 1; i >= 0; --i) {
         if (layer[i]) {
-            for (; it; it = g_list_next(it)) {
-                /* look for the top of the layer */
-                if (window_layer(it->data) <= (ObStackingLayer) i)
-                    break;
-            }
-            do_restack(layer[i], it);
+            /* go to the top of the layer */
+            do_restack(layer[i], layer_start(i));
             g_list_free(layer[i]);
         }
     }
@@ -202,15 +410,10 @@ static void do_lower(GList *wins)
         layer[l] = g_list_append(layer[l], it->data);
     }
 
-    it = stacking_list;
     for (i = OB_NUM_STACKING_LAYERS - 1; i >= 0; --i) {
         if (layer[i]) {
-            for (; it; it = g_list_next(it)) {
-                /* look for the top of the next layer down */
-                if (window_layer(it->data) < (ObStackingLayer) i)
-                    break;
-            }
-            do_restack(layer[i], it);
+            /* go to the top of the next layer down */
+            do_restack(layer[i], layer_start(i - 1));
             g_list_free(layer[i]);
         }
     }
@@ -218,7 +421,7 @@ static void do_lower(GList *wins)
 
 static void restack_windows(ObClient *selected, gboolean raise)
 {
-    GList *it, *last, *below, *above, *next;
+    GList *it, *below, *above, *next;
     GList *wins = NULL;
 
     GList *group_helpers = NULL;
@@ -226,6 +429,7 @@ static void restack_windows(ObClient *selected, gboolean raise)
     GList *group_trans = NULL;
     GList *modals = NULL;
     GList *trans = NULL;
+    gboolean removed;
 
     if (raise) {
         ObClient *p;
@@ -237,24 +441,25 @@ static void restack_windows(ObClient *selected, gboolean raise)
     }
 
     /* remove first so we can't run into ourself */
-    it = g_list_find(stacking_list, selected);
-    g_assert(it);
-    stacking_list = g_list_delete_link(stacking_list, it);
-
-    /* go from the bottom of the stacking list up. don't move any other windows
-       when lowering, we call this for each window independently */
-    if (raise) {
-        for (it = g_list_last(stacking_list); it; it = next) {
+    removed = stacking_unlink(CLIENT_AS_WINDOW(selected));
+    g_assert(removed);
+
+    /* go from the bottom of the selected window's layer up. don't move any
+       other windows when lowering, we call this for each window
+       independently.  only transients of the selected window are moved, so
+       there is nothing to look for if it has none */
+    if (raise && selected->transients) {
+        for (it = layer_bottom(selected->layer);
+             it && window_layer(it->data) == selected->layer; it = next)
+        {
             next = g_list_previous(it);
 
             if (WINDOW_IS_CLIENT(it->data)) {
                 ObClient *ch = it->data;
 
-                /* only move windows in the same stacking layer */
-                if (ch->layer == selected->layer &&
-                    /* looking for windows that are transients, and so would
-                       remain above the selected window */
-                    client_search_transient(selected, ch))
+                /* looking for windows that are transients, and so would
+                   remain above the selected window */
+                if (client_search_transient(selected, ch))
                 {
                     if (client_is_direct_child(selected, ch)) {
                         if (ch->modal)
@@ -275,7 +480,7 @@ static void restack_windows(ObClient *selected, gboolean raise)
                         else
                             group_trans = g_list_prepend(group_trans, ch);
                     }
-                    stacking_list = g_list_delete_link(stacking_list, it);
+                    stacking_unlink(it->data);
                 }
             }
         }
@@ -301,33 +506,14 @@ static void restack_windows(ObClient *selected, gboolean raise)
         group_trans = NULL;
     }
 
-    /* find where to put the selected window, start from bottom of list,
-       this is the window below everything we are re-adding to the list */
-    last = NULL;
-    for (it = g_list_last(stacking_list); it; it = g_list_previous(it))
-    {
-        if (window_layer(it->data) < selected->layer) {
-            last = it;
-            continue;
-        }
-        /* if lowering, stop at the beginning of the layer */
-        if (!raise)
-            break;
-        /* if raising, stop at the end of the layer */
-        if (window_layer(it->data) > selected->layer)
-            break;
-
-        last = it;
-    }
+    /* find where to put the selected window, this is the window below
+       everything we are re-adding to the list.  when raising it is the top of
+       the layer, and when lowering it is the top of the next layer down */
+    below = layer_start(raise ? selected->layer : selected->layer - 1);
 
-    /* save this position in the stacking list */
-    below = last;
-
-    /* find where to put the group transients, start from the top of list */
-    for (it = stacking_list; it; it = g_list_next(it)) {
-        /* skip past higher layers */
-        if (window_layer(it->data) > selected->layer)
-            continue;
+    /* find where to put the group transients, start from the top of the
+       layer */
+    for (it = layer_start(selected->layer); it; it = g_list_next(it)) {
         /* if we reach the end of the layer (how?) then don't go further */
         if (window_layer(it->data) < selected->layer)
             break;
@@ -350,17 +536,17 @@ static void restack_windows(ObClient *selected, gboolean raise)
        we actually want to save 1 position _above_ that, for for loops to work
        nicely, so move back one position in the list while saving it
     */
-    above = it ? g_list_previous(it) : g_list_last(stacking_list);
+    above = it ? g_list_previous(it) : stacking_list_tail;
 
     /* put the windows inside the gap to the other windows we're stacking
        into the restacking list, go from the bottom up so that we can use
        g_list_prepend */
     if (below) it = g_list_previous(below);
-    else       it = g_list_last(stacking_list);
+    else       it = stacking_list_tail;
     for (; it != above; it = next) {
         next = g_list_previous(it);
         wins = g_list_prepend(wins, it->data);
-        stacking_list = g_list_delete_link(stacking_list, it);
+        stacking_unlink(it->data);
     }
 
     /* group transients go above the rest of the stuff acquired to now */
@@ -379,7 +565,7 @@ static void restack_windows(ObClient *selected, gboolean raise)
         parents_copy = g_slist_copy(selected->parents);
 
         /* go thru stacking list backwards so we can use g_slist_prepend */
-        for (it = g_list_last(stacking_list); it && parents_copy;
+        for (it = stacking_list_tail; it && parents_copy;
              it = g_list_previous(it))
             if ((sit = g_slist_find(parents_copy, it->data))) {
                 reorder = g_slist_prepend(reorder, sit->data);
@@ -402,11 +588,10 @@ void stacking_raise(ObWindow *window)
     } else {
         GList *wins;
         wins = g_list_append(NULL, window);
-        stacking_list = g_list_remove(stacking_list, window);
+        stacking_unlink(window);
         do_raise(wins);
         g_list_free(wins);
     }
-    stacking_list_tail = g_list_last(stacking_list);
 }
 
 void stacking_lower(ObWindow *window)
@@ -418,11 +603,10 @@ void stacking_lower(ObWindow *window)
     } else {
         GList *wins;
         wins = g_list_append(NULL, window);
-        stacking_list = g_list_remove(stacking_list, window);
+        stacking_unlink(window);
         do_lower(wins);
         g_list_free(wins);
     }
-    stacking_list_tail = g_list_last(stacking_list);
 }
 
 void stacking_below(ObWindow *window, ObWindow *below)
@@ -433,11 +617,10 @@ void stacking_below(ObWindow *window, ObWindow *below)
         return;
 
     wins = g_list_append(NULL, window);
-    stacking_list = g_list_remove(stacking_list, window);
-    before = g_list_next(g_list_find(stacking_list, below));
+    stacking_unlink(window);
+    before = g_list_next(stacking_find(below));
     do_restack(wins, before);
     g_list_free(wins);
-    stacking_list_tail = g_list_last(stacking_list);
 }
 
 void stacking_add(ObWindow *win)
@@ -447,10 +630,9 @@ void stacking_add(ObWindow *win)
     /* don't add windows that are being unmanaged ! */
     if (WINDOW_IS_CLIENT(win)) g_assert(WINDOW_AS_CLIENT(win)->managed);
 
-    stacking_list = g_list_append(stacking_list, win);
+    stacking_link(win, NULL);
 
     stacking_raise(win);
-    /* stacking_list_tail set by stacking_raise() */
 }
 
 static GList *find_highest_relative(ObClient *client)
@@ -464,14 +646,16 @@ static GList *find_highest_relative(ObClient *client)
         /* get all top level relatives of this client */
         top = client_search_all_top_parents_layer(client);
 
-        /* go from the top of the stacking order down */
-        for (it = stacking_list; !ret && it; it = g_list_next(it)) {
+        /* go from the top of the client's layer down, only windows in the
+           same layer are looked at */
+        for (it = layer_top[client->layer];
+             !ret && it && window_layer(it->data) == client->layer;
+             it = g_list_next(it))
+        {
             if (WINDOW_IS_CLIENT(it->data)) {
                 ObClient *c = it->data;
-                /* only look at windows in the same layer and that are
-                   visible */
-                if (c->layer == client->layer &&
-                    !c->iconic &&
+                /* only look at windows that are visible */
+                if (!c->iconic &&
                     (c->desktop == client->desktop ||
                      c->desktop == DESKTOP_ALL ||
                      client->desktop == DESKTOP_ALL))
@@ -520,7 +704,7 @@ void stacking_add_nonintrusive(ObWindow *win)
         if (focus_client && client != focus_client &&
             focus_client->layer == client->layer)
         {
-            it_below = g_list_find(stacking_list, focus_client);
+            it_below = stacking_find(CLIENT_AS_WINDOW(focus_client));
             /* this can give NULL, but it means the focused window is on the
                bottom of the stacking order, so go to the bottom in that case,
                below it */
@@ -545,25 +729,21 @@ void stacking_add_nonintrusive(ObWindow *win)
     }
 
     /* make sure it's not in the wrong layer though ! */
-    for (; it_below; it_below = g_list_next(it_below)) {
-        /* stop when the window is not in a higher layer than the window
-           it is going above (it_below) */
-        if (client->layer >= window_layer(it_below->data))
-            break;
-    }
-    for (; it_below != stacking_list; it_below = it_above) {
-        /* stop when the window is not in a lower layer than the
-           window it is going under (it_above) */
-        it_above = it_below ?
-            g_list_previous(it_below) : g_list_last(stacking_list);
-        if (client->layer <= window_layer(it_above->data))
-            break;
+    if (it_below && client->layer < window_layer(it_below->data))
+        /* the window it is going above (it_below) is in a higher layer, so
+           go to the top of the window's own layer */
+        it_below = layer_start(client->layer);
+    else if (it_below != stacking_list) {
+        /* if the window it is going under (it_above) is in a lower layer,
+           then go to the top of the next layer down */
+        it_above = it_below ? g_list_previous(it_below) : stacking_list_tail;
+        if (client->layer > window_layer(it_above->data))
+            it_below = layer_start(client->layer - 1);
     }
 
     wins = g_list_append(NULL, win);
     do_restack(wins, it_below);
     g_list_free(wins);
-    stacking_list_tail = g_list_last(stacking_list);
 }
 
 /*! Returns TRUE if client is occluded by the sibling. If sibling is NULL it
@@ -582,7 +762,7 @@ static gboolean stacking_occluded(ObClient *client, ObWindow *sibling_win)
     if (sibling && client->layer != sibling->layer)
         return FALSE;
 
-    for (it = g_list_previous(g_list_find(stacking_list, client)); it;
+    for (it = g_list_previous(stacking_find(CLIENT_AS_WINDOW(client))); it;
          it = g_list_previous(it))
         if (WINDOW_IS_CLIENT(it->data)) {
             ObClient *c = it->data;
@@ -642,7 +822,7 @@ static gboolean stacking_occludes(ObClient *client, ObWindow *sibling_win)
     if (sibling && client->layer != sibling->layer)
         return FALSE;
 
-    for (it = g_list_next(g_list_find(stacking_list, client));
+    for (it = g_list_next(stacking_find(CLIENT_AS_WINDOW(client)));
          it; it = g_list_next(it))
         if (WINDOW_IS_CLIENT(it->data)) {
             ObClient *c = it->data;
@@ -38,18 +38,27 @@ typedef enum {
     OB_NUM_STACKING_LAYERS
 } ObStackingLayer;
 
+void stacking_startup(gboolean reconfig);
+void stacking_shutdown(gboolean reconfig);
+
 /* list of ObWindow*s in stacking order from highest to lowest */
 extern GList *stacking_list;
 /* list of ObWindow*s in stacking order from lowest to highest */
 extern GList *stacking_list_tail;
 
 /*! Sets the window stacking list on the root window from the
-  stacking_list */
+  stacking_list.  The property is written once the main loop is idle, and
+  only if the list has changed */
 void stacking_set_list(void);
 
 void stacking_add(struct _ObWindow *win);
 void stacking_add_nonintrusive(struct _ObWindow *win);
-#define stacking_remove(win) stacking_list = g_list_remove(stacking_list, win);
+void stacking_remove(struct _ObWindow *win);
+
+/*! Returns how many windows are above the window in the stacking_list, or -1
+  if it is not in the list.  The positions are only counted again after the
+  stacking order changes, so this is cheap to call many times in a row. */
+gint stacking_position(struct _ObWindow *win);
 
 /*! Raises a window above all others in its stacking layer */
 void stacking_raise(struct _ObWindow *window);
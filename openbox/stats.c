@@ -0,0 +1,181 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   stats.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "stats.h"
+#include "debug.h"
+#include "obt/display.h"
+#include "obt/paths.h"
+
+#include <string.h>
+#ifdef HAVE_SYS_TYPES_H
+#  include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#  include <sys/mman.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#  include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+/*! The stats file, mapped into memory.  NULL if it could not be made */
+static ObStatsFile *stats = NULL;
+static gchar *stats_path = NULL;
+/*! The serial of the first request openbox made */
+static gulong first_request;
+/*! The slot for each action in the stats file, by name */
+static GHashTable *action_slots = NULL;
+
+void stats_startup(gboolean reconfig)
+{
+#ifdef HAVE_SYS_MMAN_H
+    ObtPaths *p;
+    gchar *dir, *name, *c;
+    gint fd;
+    gpointer map;
+
+    if (reconfig) return;
+
+    p = obt_paths_new();
+    dir = g_build_filename(obt_paths_cache_home(p), "openbox", NULL);
+    obt_paths_unref(p);
+
+    /* the display name has a ':' in it, but not a '/' */
+    name = g_strconcat(OB_STATS_FILE_PREFIX, DisplayString(obt_display),
+                       NULL);
+    for (c = name; *c; ++c)
+        if (*c == '/') *c = '_';
+    stats_path = g_build_filename(dir, name, NULL);
+    g_free(name);
+
+    fd = -1;
+    map = MAP_FAILED;
+    if (obt_paths_mkdir_path(dir, 0700) &&
+        (fd = open(stats_path, O_RDWR | O_CREAT | O_TRUNC, 0600)) >= 0 &&
+        ftruncate(fd, sizeof(ObStatsFile)) == 0)
+    {
+        map = mmap(NULL, sizeof(ObStatsFile), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    }
+    if (fd >= 0) close(fd);
+    g_free(dir);
+
+    if (map == MAP_FAILED) {
+        ob_debug("Unable to make the stats file %s", stats_path);
+        g_free(stats_path);
+        stats_path = NULL;
+        return;
+    }
+
+    stats = map;
+    memset(stats, 0, sizeof(ObStatsFile));
+    stats->version = OB_STATS_VERSION;
+    stats->pid = getpid();
+    stats->start_time = g_get_real_time();
+    /* written last, so a reader never sees a file with only part of the
+       header */
+    stats->magic = OB_STATS_MAGIC;
+
+    first_request = NextRequest(obt_display);
+    action_slots = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                         g_free, NULL);
+#else
+    (void)reconfig;
+#endif
+}
+
+void stats_shutdown(gboolean reconfig)
+{
+    if (reconfig) return;
+
+#ifdef HAVE_SYS_MMAN_H
+    if (stats) {
+        munmap(stats, sizeof(ObStatsFile));
+        stats = NULL;
+        unlink(stats_path);
+        g_free(stats_path);
+        stats_path = NULL;
+        g_hash_table_destroy(action_slots);
+        action_slots = NULL;
+    }
+#endif
+}
+
+gint64 stats_start(void)
+{
+    return stats ? g_get_monotonic_time() : 0;
+}
+
+static void record(ObStatsHistogram *h, gint64 start)
+{
+    guint64 t;
+    guint b;
+
+    t = MAX(g_get_monotonic_time() - start, 0);
+
+    ++h->count;
+    h->total += t;
+    h->max = MAX(h->max, t);
+    /* find the bucket for the smallest power of 2 that is more than t */
+    for (b = 0; b < OB_STATS_BUCKETS - 1 && t >= (G_GUINT64_CONSTANT(1) << b);
+         ++b);
+    ++h->buckets[b];
+
+    stats->requests = NextRequest(obt_display) - first_request;
+    stats->round_trips = obt_display_round_trips;
+}
+
+void stats_event(gint type, gint64 start)
+{
+    if (!stats) return;
+
+    if (type < 0 || type >= OB_STATS_EVENTS)
+        type = 0;
+    record(&stats->events[type], start);
+}
+
+void stats_action(const gchar *name, gint64 start)
+{
+    gpointer slot;
+
+    if (!stats) return;
+
+    if (!g_hash_table_lookup_extended(action_slots, name, NULL, &slot)) {
+        /* the actions after the last slot are not recorded */
+        if (stats->num_actions == OB_STATS_ACTIONS)
+            return;
+
+        slot = GUINT_TO_POINTER(stats->num_actions);
+        g_strlcpy(stats->action_names[stats->num_actions], name,
+                  OB_STATS_NAME_LENGTH);
+        ++stats->num_actions;
+        g_hash_table_insert(action_slots, g_strdup(name), slot);
+    }
+    record(&stats->actions[GPOINTER_TO_UINT(slot)], start);
+}
+
+void stats_section(ObStatsSection section, gint64 start)
+{
+    if (!stats) return;
+
+    if (section == OB_STATS_FRAME_RENDER)
+        ++stats->renders;
+    record(&stats->sections[section], start);
+}
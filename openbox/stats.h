@@ -0,0 +1,101 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   stats.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __stats_h
+#define __stats_h
+
+#include <glib.h>
+
+/* This file describes the stats file as well, and is used by the obstats
+   tool to read it, so it doesn't depend on anything else in openbox. */
+
+/*! The stats file is written to this file in the cache directory, with the
+  display name after it */
+#define OB_STATS_FILE_PREFIX "stats-"
+
+#define OB_STATS_MAGIC   0x5453424fu /* "OBST" */
+#define OB_STATS_VERSION 1
+
+/*! Times are counted in the bucket for the smallest power of 2 microseconds
+  that they are less than, and the last bucket holds everything longer */
+#define OB_STATS_BUCKETS     20
+/*! X event types, extension events are all counted in slot 0, which X never
+  uses for an event */
+#define OB_STATS_EVENTS      64
+#define OB_STATS_ACTIONS     64
+#define OB_STATS_NAME_LENGTH 32
+
+typedef enum {
+    OB_STATS_CLIENT_MANAGE,
+    OB_STATS_CLIENT_UNMANAGE,
+    OB_STATS_FRAME_RENDER,
+    OB_STATS_PIPE_MENU,
+    OB_NUM_STATS_SECTIONS
+} ObStatsSection;
+
+typedef struct _ObStatsHistogram ObStatsHistogram;
+typedef struct _ObStatsFile      ObStatsFile;
+
+struct _ObStatsHistogram {
+    guint64 count;
+    /*! The time of all of them together, in microseconds */
+    guint64 total;
+    /*! The longest one, in microseconds */
+    guint64 max;
+    guint64 buckets[OB_STATS_BUCKETS];
+};
+
+/*! The contents of the stats file.  It is written while openbox runs, and
+  read with no locking, so the numbers can be slightly out of step. */
+struct _ObStatsFile {
+    guint32 magic;
+    guint32 version;
+    guint64 pid;
+    /*! When openbox started, in microseconds since the epoch */
+    guint64 start_time;
+
+    /*! The number of times a frame was drawn */
+    guint64 renders;
+    /*! The number of X requests that were made */
+    guint64 requests;
+    /*! The number of times openbox waited for the X server */
+    guint64 round_trips;
+
+    ObStatsHistogram sections[OB_NUM_STATS_SECTIONS];
+    ObStatsHistogram events[OB_STATS_EVENTS];
+
+    guint32 num_actions;
+    gchar action_names[OB_STATS_ACTIONS][OB_STATS_NAME_LENGTH];
+    ObStatsHistogram actions[OB_STATS_ACTIONS];
+};
+
+void stats_startup(gboolean reconfig);
+void stats_shutdown(gboolean reconfig);
+
+/*! Returns the time to pass to the other stats functions when the thing
+  being timed is done */
+gint64 stats_start(void);
+
+/*! Records the time taken to handle an X event since @start */
+void stats_event(gint type, gint64 start);
+/*! Records the time taken to run an action since @start */
+void stats_action(const gchar *name, gint64 start);
+/*! Records the time taken for part of openbox since @start */
+void stats_section(ObStatsSection section, gint64 start);
+
+#endif
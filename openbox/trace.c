@@ -0,0 +1,111 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   trace.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "trace.h"
+#include "gettext.h"
+
+#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+#  include <sys/types.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+static FILE *trace = NULL;
+static gchar *trace_path = NULL;
+static gulong pid;
+
+static void write_string(const gchar *s);
+
+void trace_open(const gchar *path)
+{
+    if (!(trace = fopen(path, "w"))) {
+        g_message(_("Unable to write the startup trace to \"%s\""), path);
+        return;
+    }
+    trace_path = g_strdup(path);
+    pid = getpid();
+
+    /* the JSON array format.  the trace viewer doesn't mind if the ']' is
+       missing at the end, so the trace is still useful if openbox fails to
+       start */
+    fprintf(trace, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,"
+            "\"tid\":1,\"args\":{\"name\":\"openbox\"}}", pid);
+}
+
+void trace_close(void)
+{
+    if (!trace) return;
+
+    fprintf(trace, "\n]\n");
+    if (fclose(trace) != 0)
+        g_message(_("Unable to write the startup trace to \"%s\""),
+                  trace_path);
+    trace = NULL;
+    g_free(trace_path);
+    trace_path = NULL;
+}
+
+gint64 trace_start(void)
+{
+    return trace ? g_get_monotonic_time() : 0;
+}
+
+/*! Writes a string as JSON, with quotes around it */
+static void write_string(const gchar *s)
+{
+    fputc('"', trace);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            fprintf(trace, "\\%c", *s);
+        else if ((guchar)*s < 0x20)
+            fprintf(trace, "\\u%04x", (guchar)*s);
+        else
+            fputc(*s, trace);
+    }
+    fputc('"', trace);
+}
+
+void trace_phase(const gchar *category, const gchar *name, gint64 start)
+{
+    trace_phase_arg(category, name, start, NULL, NULL);
+}
+
+void trace_phase_arg(const gchar *category, const gchar *name, gint64 start,
+                     const gchar *arg_name, const gchar *arg)
+{
+    if (!trace) return;
+
+    /* a complete event, with its start time and duration */
+    fprintf(trace, ",\n{\"name\":");
+    write_string(name);
+    fprintf(trace, ",\"cat\":");
+    write_string(category);
+    fprintf(trace, ",\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT
+            ",\"dur\":%" G_GINT64_FORMAT ",\"pid\":%lu,\"tid\":1",
+            start, g_get_monotonic_time() - start, pid);
+    if (arg_name && arg) {
+        fprintf(trace, ",\"args\":{");
+        write_string(arg_name);
+        fputc(':', trace);
+        write_string(arg);
+        fputc('}', trace);
+    }
+    fputc('}', trace);
+}
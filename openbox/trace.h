@@ -0,0 +1,44 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   trace.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __trace_h
+#define __trace_h
+
+#include <glib.h>
+
+/*! Starts writing a trace of openbox starting up to the file.  It is written
+  in Chrome's trace event format, which can be opened in chrome://tracing or
+  other trace viewers. */
+void trace_open(const gchar *path);
+/*! Finishes the trace, once openbox has started */
+void trace_close(void);
+
+/*! Returns the time to pass to trace_phase() when the phase is done, or 0 if
+  the startup is not being traced */
+gint64 trace_start(void);
+/*! Adds a phase of the startup which began at @start to the trace
+  @param category A group of phases that this one belongs to, such as
+    "startup" or "config"
+*/
+void trace_phase(const gchar *category, const gchar *name, gint64 start);
+/*! Adds a phase of the startup with a value which describes it, such as the
+  file which was read in it */
+void trace_phase_arg(const gchar *category, const gchar *name, gint64 start,
+                     const gchar *arg_name, const gchar *arg);
+
+#endif
@@ -0,0 +1,14 @@
+#include <glib.h>
+
+#include "obt/unittest_base.h"
+
+/* Add all test suites here. Keep them sorted. */
+extern void run_place_overlap_unittest();
+
+gint main(gint argc, gchar **argv)
+{
+    /* Add all test suites here. Keep them sorted. */
+    run_place_overlap_unittest();
+
+    return unittest_result();
+}
@@ -26,6 +26,7 @@
 #include "prompt.h"
 #include "debug.h"
 #include "grab.h"
+#include "obt/display.h"
 #include "obt/prop.h"
 #include "obt/xqueue.h"
 
@@ -104,12 +105,20 @@ void window_remove(Window xwin)
     g_hash_table_remove(window_map, &xwin);
 }
 
+/*! Stops watching a window which window_manage_all() is not going to manage */
+static void window_manage_skip(Window win)
+{
+    obt_prop_prefetch_end(win);
+    XSelectInput(obt_display, win, NoEventMask);
+}
+
 void window_manage_all(void)
 {
-    guint i, j, nchild;
-    Window w, *children;
+    guint i, j, n, nchild, nmanage;
+    Window w, *children, *manage;
     XWMHints *wmhints;
-    XWindowAttributes attrib;
+    gint *map_states;
+    const Atom wm_hints = OBT_PROP_ATOM(WM_HINTS);
 
     if (!XQueryTree(obt_display, RootWindow(obt_display, ob_screen),
                     &w, &w, &children, &nchild)) {
@@ -117,16 +126,33 @@ void window_manage_all(void)
         nchild = 0;
     }
 
+    /* skip our own windows, and hear about the properties of the rest
+       changing from before any of them are read, so that window_manage() can
+       tell if the values it has are out of date */
+    for (i = n = 0; i < nchild; ++i)
+        if (!window_find(children[i])) {
+            XSelectInput(obt_display, children[i], PropertyChangeMask);
+            children[n++] = children[i];
+        }
+    nchild = n;
+
+    /* ask about all of the windows at once, instead of waiting for the
+       server for each window in turn */
+    map_states = g_new(gint, nchild);
+    obt_display_get_map_states(children, nchild, map_states);
+    obt_prop_prefetch_windows(children, nchild, &wm_hints, 1);
+
     /* remove all icon windows from the list */
     for (i = 0; i < nchild; i++) {
         if (children[i] == None) continue;
-        wmhints = XGetWMHints(obt_display, children[i]);
+        wmhints = obt_prop_get_wm_hints(children[i]);
         if (wmhints) {
             if ((wmhints->flags & IconWindowHint) &&
                 (wmhints->icon_window != children[i]))
                 for (j = 0; j < nchild; j++)
                     if (children[j] == wmhints->icon_window) {
                         /* XXX watch the window though */
+                        window_manage_skip(children[j]);
                         children[j] = None;
                         break;
                     }
@@ -134,17 +160,30 @@ void window_manage_all(void)
         }
     }
 
+    manage = g_new(Window, nchild);
+    nmanage = 0;
     for (i = 0; i < nchild; ++i) {
         if (children[i] == None) continue;
-        if (window_find(children[i])) continue; /* skip our own windows */
-        if (XGetWindowAttributes(obt_display, children[i], &attrib)) {
-            if (attrib.map_state == IsUnmapped)
-                ;
-            else
-                window_manage(children[i]);
-        }
+        if (map_states[i] == IsUnmapped)
+            window_manage_skip(children[i]);
+        else
+            manage[nmanage++] = children[i];
     }
 
+    client_prefetch(manage, nmanage);
+
+    for (i = 0; i < nmanage; ++i) {
+        window_manage(manage[i]);
+        /* clients and dockapps choose their own events when they are
+           managed.  dockapps are not in window_map, but in the dock's */
+        if (window_find(manage[i]) || dock_find_dockapp(manage[i]))
+            obt_prop_prefetch_end(manage[i]);
+        else
+            window_manage_skip(manage[i]);
+    }
+
+    g_free(manage);
+    g_free(map_states);
     if (children) XFree(children);
 }
 
@@ -155,6 +194,12 @@ static gboolean check_unmap(XEvent *e, gpointer data)
             (e->type == UnmapNotify && e->xunmap.window == win));
 }
 
+static gboolean check_property(XEvent *e, gpointer data)
+{
+    const Window win = *(Window*)data;
+    return (e->type == PropertyNotify && e->xproperty.window == win);
+}
+
 void window_manage(Window win)
 {
     XWindowAttributes attrib;
@@ -175,9 +220,14 @@ void window_manage(Window win)
     else {
         XWMHints *wmhints;
 
+        /* the properties prefetched by window_manage_all() may have changed
+           since they were read, so read them again */
+        if (xqueue_exists_local(check_property, &win))
+            obt_prop_prefetch_end(win);
+
         /* is the window a docking app */
         is_dockapp = FALSE;
-        if ((wmhints = XGetWMHints(obt_display, win))) {
+        if ((wmhints = obt_prop_get_wm_hints(win))) {
             if ((wmhints->flags & StateHint) &&
                 wmhints->initial_state == WithdrawnState)
             {
@@ -0,0 +1,587 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   eventreplay.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+/* Replays a trace written by openbox --record-events against the openbox
+   running on $DISPLAY, or shows how long openbox took to handle the events
+   in a trace.  See eventreplay.sh to do both on an Xvfb server.
+
+   The clients in the trace are replaced by stand-in windows, which are given
+   the same size and properties that the clients had when they were mapped.
+   Only the things that a client or the user did are replayed, such as
+   mapping windows, changing their properties, sending messages to the root
+   window and pressing keys and buttons (with XTest).  Everything else which
+   openbox saw in the trace was caused by those, and happens again on its
+   own.
+
+   After each event is replayed, this waits for openbox to handle it, so the
+   events are always handled in the same order. */
+
+#include "../openbox/record.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#include <X11/extensions/XTest.h>
+#include <sys/select.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+/*! How long to wait for openbox, in seconds */
+#define TIMEOUT 10
+
+typedef gboolean (*EntryFunc)(const ObRecordEntry *en, gconstpointer data);
+
+static Display *display;
+static Window root, barrier_win;
+static Atom net_frame_extents, net_request_frame_extents, net_wm_state;
+static Atom ob_control;
+static ObRecordHeader header;
+/*! The names of the atoms in the trace, by their recorded value */
+static GHashTable *atom_names;
+/*! The atoms in the trace, by their recorded value */
+static GHashTable *atoms;
+/*! The stand-in windows, by the recorded window that they replace */
+static GHashTable *windows;
+static gboolean fast = FALSE;
+static gint64 replay_start;
+static guint replayed = 0;
+
+/*! The handling times for each event type, in microseconds */
+static GArray *handled[LASTEvent + 1];
+static guint barriers = 0;
+
+static const gchar *event_names[LASTEvent] = {
+    "Extension events", NULL, "KeyPress", "KeyRelease", "ButtonPress",
+    "ButtonRelease", "MotionNotify", "EnterNotify", "LeaveNotify", "FocusIn",
+    "FocusOut", "KeymapNotify", "Expose", "GraphicsExpose", "NoExpose",
+    "VisibilityNotify", "CreateNotify", "DestroyNotify", "UnmapNotify",
+    "MapNotify", "MapRequest", "ReparentNotify", "ConfigureNotify",
+    "ConfigureRequest", "GravityNotify", "ResizeRequest", "CirculateNotify",
+    "CirculateRequest", "PropertyNotify", "SelectionClear",
+    "SelectionRequest", "SelectionNotify", "ColormapNotify", "ClientMessage",
+    "MappingNotify", "GenericEvent"
+};
+
+static gint fail(const gchar *s)
+{
+    if (s)
+        fprintf(stderr, "%s\n", s);
+    else
+        fprintf
+            (stderr,
+             "Usage: eventreplay [OPTIONS] TRACE\n\n"
+             "Replays a trace from openbox --record-events against the "
+             "openbox on $DISPLAY.\n\n"
+             "Options:\n"
+             "    --help     Display this help and exit\n"
+             "    --fast     Don't wait as long between events as they "
+             "were recorded\n"
+             "    --report   Show how long openbox took to handle the "
+             "events in TRACE\n"
+             "    --screen   Show the size of the screen TRACE was "
+             "recorded on\n");
+    return 1;
+}
+
+/*! Reads the trace, and calls @func for each entry in it, if it is not
+  NULL */
+static gboolean read_trace(const gchar *path, EntryFunc func)
+{
+    gchar *contents;
+    gsize len, pos;
+    gboolean ok = TRUE;
+
+    if (!g_file_get_contents(path, &contents, &len, NULL)) {
+        fprintf(stderr, "Unable to read %s\n", path);
+        return FALSE;
+    }
+
+    if (len >= sizeof(ObRecordHeader))
+        memcpy(&header, contents, sizeof(ObRecordHeader));
+    if (len < sizeof(ObRecordHeader) || header.magic != OB_RECORD_MAGIC ||
+        header.version != OB_RECORD_VERSION)
+    {
+        fprintf(stderr, "%s is not an event trace from this version of "
+                "Openbox\n", path);
+        ok = FALSE;
+    }
+    else if (header.event_size != sizeof(XEvent)) {
+        fprintf(stderr, "%s was recorded on a different kind of machine\n",
+                path);
+        ok = FALSE;
+    }
+
+    for (pos = sizeof(ObRecordHeader); ok && func && pos < len;) {
+        const ObRecordEntry *en = (const ObRecordEntry*)(contents + pos);
+
+        if (len - pos < sizeof(ObRecordEntry) ||
+            len - pos - sizeof(ObRecordEntry) < en->length)
+        {
+            /* openbox didn't finish writing it */
+            fprintf(stderr, "%s ends part way through an event\n", path);
+            break;
+        }
+        ok = func(en, en + 1);
+        pos += sizeof(ObRecordEntry) + OB_RECORD_PAD(en->length);
+    }
+
+    g_free(contents);
+    return ok;
+}
+
+static Atom atom(guint64 recorded)
+{
+    gpointer a;
+    const gchar *name;
+
+    if (recorded == None) return None;
+    if (g_hash_table_lookup_extended(atoms, GUINT_TO_POINTER(recorded),
+                                     NULL, &a))
+        return GPOINTER_TO_UINT(a);
+
+    name = g_hash_table_lookup(atom_names, GUINT_TO_POINTER(recorded));
+    a = GUINT_TO_POINTER(name ? XInternAtom(display, name, FALSE) : None);
+    g_hash_table_insert(atoms, GUINT_TO_POINTER(recorded), a);
+    return GPOINTER_TO_UINT(a);
+}
+
+static Window standin(guint64 recorded)
+{
+    return GPOINTER_TO_UINT(g_hash_table_lookup(windows,
+                                                GUINT_TO_POINTER(recorded)));
+}
+
+/*! Waits for openbox to handle everything that was sent to it so far.  This
+  asks it for the frame extents of a window, which it always answers, and
+  handles events in the order that they arrive. */
+static gboolean barrier(void)
+{
+    XEvent ce;
+    gint64 end;
+
+    ce.xclient.type = ClientMessage;
+    ce.xclient.window = barrier_win;
+    ce.xclient.message_type = net_request_frame_extents;
+    ce.xclient.format = 32;
+    memset(ce.xclient.data.l, 0, sizeof(ce.xclient.data.l));
+    XDeleteProperty(display, barrier_win, net_frame_extents);
+    XSendEvent(display, root, FALSE,
+               SubstructureRedirectMask | SubstructureNotifyMask, &ce);
+    XFlush(display);
+
+    end = g_get_monotonic_time() + TIMEOUT * G_USEC_PER_SEC;
+    while (g_get_monotonic_time() < end) {
+        XEvent e;
+        fd_set fds;
+        struct timeval tv;
+
+        while (XCheckTypedWindowEvent(display, barrier_win, PropertyNotify,
+                                      &e))
+            if (e.xproperty.atom == net_frame_extents &&
+                e.xproperty.state == PropertyNewValue)
+                return TRUE;
+
+        FD_ZERO(&fds);
+        FD_SET(ConnectionNumber(display), &fds);
+        tv.tv_sec = 0;
+        tv.tv_usec = 100000;
+        select(ConnectionNumber(display) + 1, &fds, NULL, NULL, &tv);
+    }
+    fail("Openbox did not answer, is it running?");
+    return FALSE;
+}
+
+static void replay_window(const ObRecordWindow *rw)
+{
+    Window w;
+
+    if ((w = standin(rw->window)))
+        /* the client is mapping it again after withdrawing it */
+        XMoveResizeWindow(display, w, rw->x, rw->y, rw->width, rw->height);
+    else {
+        w = XCreateSimpleWindow(display, root, rw->x, rw->y,
+                                rw->width, rw->height, rw->border,
+                                BlackPixel(display, DefaultScreen(display)),
+                                WhitePixel(display, DefaultScreen(display)));
+        g_hash_table_insert(windows, GUINT_TO_POINTER(rw->window),
+                            GUINT_TO_POINTER(w));
+    }
+}
+
+static void replay_property(const ObRecordProperty *rp, gconstpointer data)
+{
+    Window w;
+    Atom a, type;
+    gpointer xdata;
+    guint32 i;
+
+    if (!(w = standin(rp->window)) || !(a = atom(rp->atom))) return;
+    type = atom(rp->type);
+
+    /* Xlib wants longs for 32 bit properties */
+    if (rp->format == 32) {
+        const guint32 *d32 = data;
+        glong *l = g_new(glong, rp->nitems);
+
+        for (i = 0; i < rp->nitems; ++i) {
+            if (type == XA_ATOM)
+                l[i] = atom(d32[i]);
+            else if (type == XA_WINDOW)
+                l[i] = standin(d32[i]);
+            else
+                l[i] = d32[i];
+        }
+        xdata = l;
+    }
+    else if (rp->format == 16) {
+        const guint16 *d16 = data;
+        gshort *s = g_new(gshort, rp->nitems);
+
+        for (i = 0; i < rp->nitems; ++i)
+            s[i] = d16[i];
+        xdata = s;
+    }
+    else
+        xdata = g_memdup2(data, rp->nitems);
+
+    XChangeProperty(display, w, a, type, rp->format, PropModeReplace,
+                    xdata, rp->nitems);
+    g_free(xdata);
+}
+
+static gboolean replay_client_message(const XClientMessageEvent *e)
+{
+    XEvent ce;
+    Window w;
+    gint i;
+
+    if (e->format != 32) return FALSE;
+
+    if (e->window == header.root)
+        w = root;
+    else if (!(w = standin(e->window)))
+        return FALSE;
+
+    ce.xclient = *e;
+    ce.xclient.display = display;
+    ce.xclient.window = w;
+    ce.xclient.message_type = atom(e->message_type);
+    /* don't let the trace tell openbox to exit or restart */
+    if (ce.xclient.message_type == None ||
+        ce.xclient.message_type == ob_control)
+        return FALSE;
+
+    for (i = 0; i < 5; ++i)
+        if ((w = standin(e->data.l[i])))
+            ce.xclient.data.l[i] = w;
+    if (ce.xclient.message_type == net_wm_state) {
+        ce.xclient.data.l[1] = atom(e->data.l[1]);
+        ce.xclient.data.l[2] = atom(e->data.l[2]);
+    }
+
+    XSendEvent(display, root, FALSE,
+               SubstructureRedirectMask | SubstructureNotifyMask, &ce);
+    return TRUE;
+}
+
+static gboolean replay_configure_request(const XConfigureRequestEvent *e)
+{
+    XWindowChanges xwc;
+    Window w;
+    guint mask = e->value_mask;
+
+    if (!(w = standin(e->window))) return FALSE;
+
+    xwc.x = e->x;
+    xwc.y = e->y;
+    xwc.width = e->width;
+    xwc.height = e->height;
+    xwc.border_width = e->border_width;
+    xwc.stack_mode = e->detail;
+    if (!(xwc.sibling = standin(e->above)))
+        mask &= ~CWSibling;
+    XConfigureWindow(display, w, mask, &xwc);
+    return TRUE;
+}
+
+/*! Does what made openbox see the event
+  @return TRUE if anything was done, FALSE if the event was a result of
+    something else, and doesn't need to be replayed
+*/
+static gboolean replay_event(const ObRecordEvent *re)
+{
+    const XEvent *e = &re->event;
+    Window w;
+
+    if (re->flags & OB_RECORD_FLAG_OWN) return FALSE;
+
+    switch (e->type) {
+    case MapRequest:
+        if (!(w = standin(e->xmaprequest.window))) return FALSE;
+        XMapWindow(display, w);
+        return TRUE;
+    case ConfigureRequest:
+        return replay_configure_request(&e->xconfigurerequest);
+    case UnmapNotify:
+        /* only the synthetic unmaps, which withdraw a window, are sure to
+           be from the client */
+        if (!e->xunmap.send_event || !(w = standin(e->xunmap.window)))
+            return FALSE;
+        XWithdrawWindow(display, w, DefaultScreen(display));
+        return TRUE;
+    case DestroyNotify:
+        if (!(w = standin(e->xdestroywindow.window))) return FALSE;
+        XDestroyWindow(display, w);
+        g_hash_table_remove(windows,
+                            GUINT_TO_POINTER(e->xdestroywindow.window));
+        return TRUE;
+    case PropertyNotify:
+        if (!(w = standin(e->xproperty.window))) return FALSE;
+        /* new values are set by the property entry before the event */
+        if (e->xproperty.state == PropertyDelete)
+            XDeleteProperty(display, w, atom(e->xproperty.atom));
+        return TRUE;
+    case ClientMessage:
+        return replay_client_message(&e->xclient);
+    case KeyPress:
+    case KeyRelease:
+        if (e->xkey.send_event) return FALSE;
+        XTestFakeKeyEvent(display, e->xkey.keycode, e->type == KeyPress, 0);
+        return TRUE;
+    case ButtonPress:
+    case ButtonRelease:
+        if (e->xbutton.send_event) return FALSE;
+        XTestFakeMotionEvent(display, DefaultScreen(display),
+                             e->xbutton.x_root, e->xbutton.y_root, 0);
+        XTestFakeButtonEvent(display, e->xbutton.button,
+                             e->type == ButtonPress, 0);
+        return TRUE;
+    case MotionNotify:
+        if (e->xmotion.send_event) return FALSE;
+        XTestFakeMotionEvent(display, DefaultScreen(display),
+                             e->xmotion.x_root, e->xmotion.y_root, 0);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean replay_entry(const ObRecordEntry *en, gconstpointer data)
+{
+    gint64 wait;
+
+    /* don't get ahead of the trace, so timeouts in openbox happen at the
+       same places */
+    wait = replay_start + en->time - g_get_monotonic_time();
+    if (!fast && wait > 0)
+        g_usleep(wait);
+
+    switch (en->type) {
+    case OB_RECORD_ATOM:
+    {
+        const ObRecordAtom *ra = data;
+
+        g_hash_table_insert(atom_names, GUINT_TO_POINTER(ra->atom),
+                            g_strndup((const gchar*)(ra + 1),
+                                      en->length - sizeof(ObRecordAtom)));
+        break;
+    }
+    case OB_RECORD_WINDOW:
+        replay_window(data);
+        break;
+    case OB_RECORD_PROPERTY:
+    {
+        const ObRecordProperty *rp = data;
+
+        replay_property(rp, rp + 1);
+        break;
+    }
+    case OB_RECORD_EVENT:
+        if (replay_event(data)) {
+            ++replayed;
+            return barrier();
+        }
+        break;
+    }
+    return TRUE;
+}
+
+static gboolean report_entry(const ObRecordEntry *en, gconstpointer data)
+{
+    if (en->type == OB_RECORD_ATOM) {
+        const ObRecordAtom *ra = data;
+        gchar *name = g_strndup((const gchar*)(ra + 1),
+                                en->length - sizeof(ObRecordAtom));
+
+        g_hash_table_insert(atom_names, GUINT_TO_POINTER(ra->atom), name);
+    }
+    else if (en->type == OB_RECORD_EVENT) {
+        const ObRecordEvent *re = data;
+        const gchar *name;
+        gint type = re->event.type;
+
+        if (type == ClientMessage &&
+            (name = g_hash_table_lookup
+             (atom_names, GUINT_TO_POINTER(re->event.xclient.message_type))) &&
+            !strcmp(name, "_NET_REQUEST_FRAME_EXTENTS"))
+        {
+            /* eventreplay's own requests */
+            ++barriers;
+            return TRUE;
+        }
+
+        if (type < 0 || type >= LASTEvent) type = LASTEvent;
+        if (!handled[type])
+            handled[type] = g_array_new(FALSE, FALSE, sizeof(guint64));
+        g_array_append_val(handled[type], re->handled);
+    }
+    return TRUE;
+}
+
+static gint cmp_time(gconstpointer a, gconstpointer b)
+{
+    const guint64 *ta = a, *tb = b;
+    return *ta < *tb ? -1 : (*ta > *tb ? 1 : 0);
+}
+
+static void report(void)
+{
+    gint i;
+    guint j;
+
+    printf("%-20s %8s %10s %8s %8s %8s %8s\n", "Event", "count", "total",
+           "average", "50%", "90%", "max");
+    for (i = 0; i <= LASTEvent; ++i) {
+        GArray *a = handled[i];
+        guint64 total = 0;
+        gchar num[32];
+        const gchar *name;
+
+        if (!a) continue;
+
+        g_array_sort(a, cmp_time);
+        for (j = 0; j < a->len; ++j)
+            total += g_array_index(a, guint64, j);
+
+        if (i < LASTEvent && event_names[i])
+            name = event_names[i];
+        else {
+            g_snprintf(num, sizeof(num), "Event %d", i);
+            name = i < LASTEvent ? num : "Other events";
+        }
+        printf("%-20s %8u %10" G_GUINT64_FORMAT " %8" G_GUINT64_FORMAT
+               " %8" G_GUINT64_FORMAT " %8" G_GUINT64_FORMAT
+               " %8" G_GUINT64_FORMAT "\n",
+               name, a->len, total, total / a->len,
+               g_array_index(a, guint64, a->len / 2),
+               g_array_index(a, guint64, a->len * 9 / 10),
+               g_array_index(a, guint64, a->len - 1));
+    }
+    printf("\nTimes are in microseconds.\n");
+    if (barriers)
+        printf("%u _NET_REQUEST_FRAME_EXTENTS messages from eventreplay are "
+               "not shown.\n", barriers);
+}
+
+/*! Waits for a window manager to be running */
+static gboolean wait_for_wm(void)
+{
+    gchar *name;
+    Atom wm_sn;
+    gint i;
+
+    name = g_strdup_printf("WM_S%d", DefaultScreen(display));
+    wm_sn = XInternAtom(display, name, FALSE);
+    g_free(name);
+
+    for (i = 0; i < TIMEOUT * 10; ++i) {
+        if (XGetSelectionOwner(display, wm_sn) != None)
+            return barrier();
+        g_usleep(G_USEC_PER_SEC / 10);
+    }
+    fail("There is no window manager running");
+    return FALSE;
+}
+
+int main(int argc, char **argv)
+{
+    gint i, ev, er, maj, min;
+    gboolean do_report = FALSE, do_screen = FALSE;
+    const gchar *path = NULL;
+
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help"))
+            return fail(NULL);
+        else if (!strcmp(argv[i], "--fast"))
+            fast = TRUE;
+        else if (!strcmp(argv[i], "--report"))
+            do_report = TRUE;
+        else if (!strcmp(argv[i], "--screen"))
+            do_screen = TRUE;
+        else if (!path)
+            path = argv[i];
+        else
+            return fail(NULL);
+    }
+    if (!path) return fail(NULL);
+
+    atom_names = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                       NULL, g_free);
+
+    if (do_screen) {
+        if (!read_trace(path, NULL))
+            return 1;
+        printf("%ux%u\n", header.screen_width, header.screen_height);
+        return 0;
+    }
+    if (do_report) {
+        if (!read_trace(path, report_entry))
+            return 1;
+        report();
+        return 0;
+    }
+
+    if (!(display = XOpenDisplay(NULL)))
+        return fail("Unable to open the display");
+    if (!XTestQueryExtension(display, &ev, &er, &maj, &min))
+        return fail("The XTest extension is needed to replay input events");
+
+    root = DefaultRootWindow(display);
+    net_frame_extents = XInternAtom(display, "_NET_FRAME_EXTENTS", FALSE);
+    net_request_frame_extents =
+        XInternAtom(display, "_NET_REQUEST_FRAME_EXTENTS", FALSE);
+    net_wm_state = XInternAtom(display, "_NET_WM_STATE", FALSE);
+    ob_control = XInternAtom(display, "_OB_CONTROL", FALSE);
+    atoms = g_hash_table_new(g_direct_hash, g_direct_equal);
+    windows = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    barrier_win = XCreateSimpleWindow(display, root, 0, 0, 1, 1, 0, 0, 0);
+    XSelectInput(display, barrier_win, PropertyChangeMask);
+
+    if (!wait_for_wm())
+        return 1;
+
+    replay_start = g_get_monotonic_time();
+    if (!read_trace(path, replay_entry))
+        return 1;
+
+    printf("Replayed %u events\n", replayed);
+    XCloseDisplay(display);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+
+# Replays an event trace from openbox --record-events against a new openbox
+# on an Xvfb server, and shows how long it took to handle each type of event.
+#
+# Usage: eventreplay.sh TRACE [OPENBOX [OPENBOX OPTIONS]]
+#
+# Use --config-file in the openbox options to use the same config each time.
+# The display to use can be set with REPLAY_DISPLAY, and is :97 by default.
+
+if [ -z "$1" ]; then
+    echo "Usage: $0 TRACE [OPENBOX [OPENBOX OPTIONS]]" >&2
+    exit 1
+fi
+
+trace="$1"
+shift
+openbox="${1:-openbox}"
+[ $# -gt 0 ] && shift
+
+dir=$(dirname "$0")
+replay="$dir/eventreplay"
+display="${REPLAY_DISPLAY:-:97}"
+
+size=$("$replay" --screen "$trace") || exit 1
+out=$(mktemp) || exit 1
+
+Xvfb "$display" -screen 0 "${size}x24" -nolisten tcp >/dev/null 2>&1 &
+xvfb=$!
+# wait for the server to be ready
+i=0
+while ! DISPLAY="$display" xprop -root >/dev/null 2>&1; do
+    i=$((i + 1))
+    if [ $i -gt 50 ]; then
+        echo "Xvfb did not start" >&2
+        kill $xvfb
+        rm -f "$out"
+        exit 1
+    fi
+    sleep 0.1
+done
+
+DISPLAY="$display" "$openbox" --sm-disable --record-events "$out" "$@" &
+ob=$!
+
+DISPLAY="$display" "$replay" "$trace"
+result=$?
+
+DISPLAY="$display" "$openbox" --exit
+wait $ob
+kill $xvfb
+wait $xvfb 2>/dev/null
+
+[ $result -eq 0 ] && "$replay" --report "$out"
+rm -f "$out"
+exit $result
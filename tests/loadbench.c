@@ -0,0 +1,561 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   loadbench.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox authors
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+/* Measures how openbox copes as the number of windows grows.  This makes
+   more and more windows, and at each count it times:
+
+   map        - from mapping a window until openbox has managed and mapped it
+   raise      - from raising the bottom window until the stacking order is
+                updated on the root window
+   lower      - the same for lowering the top window
+   desktop    - from asking to switch desktops until the desktop is changed
+   title      - changing the title of every window, until openbox has handled
+                all of them
+   reconfigure - from asking openbox to reconfigure until it handles requests
+                again
+
+   The results are written to stdout as CSV, one line for each count and
+   measurement.  See loadbench.sh to run it on an Xvfb server. */
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#include <sys/select.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+/*! How long to wait for openbox, in seconds */
+#define TIMEOUT 30
+#define ICON_SIZE 32
+
+typedef gboolean (*MatchFunc)(const XEvent *e, gpointer data);
+
+static Display *display;
+static Window root, barrier_win;
+static GArray *windows;
+static GArray *leaders;
+/*! The non-transient windows, which transients can be made for */
+static GArray *parents;
+static guint struts_made = 0;
+/*! The desktop that the windows are on */
+static glong home_desktop;
+static glong *icon;
+
+static Atom net_frame_extents, net_request_frame_extents;
+static Atom net_client_list_stacking, net_current_desktop;
+static Atom net_number_of_desktops, net_wm_name, net_wm_icon;
+static Atom net_wm_strut_partial, ob_control, utf8_string;
+
+/* options */
+static guint repeat = 20;
+static gdouble transients = 0;
+static guint groups = 0;
+static guint struts = 0;
+static gboolean icons = FALSE;
+
+static gint fail(const gchar *s)
+{
+    if (s)
+        fprintf(stderr, "%s\n", s);
+    else
+        fprintf
+            (stderr,
+             "Usage: loadbench [OPTIONS] COUNT...\n\n"
+             "Times openbox on $DISPLAY as the number of windows grows to "
+             "each COUNT.\n\n"
+             "Options:\n"
+             "    --help              Display this help and exit\n"
+             "    --repeat N          Time each thing N times at each count "
+             "(20)\n"
+             "    --transients F      Make fraction F of the windows "
+             "transient (0)\n"
+             "    --groups N          Put the windows in N groups (0)\n"
+             "    --struts N          Give N of the windows struts (0)\n"
+             "    --icons             Give the windows icons\n");
+    return 1;
+}
+
+/*! Waits for an event which @match returns TRUE for.  Other events are
+  thrown away. */
+static gboolean wait_for(MatchFunc match, gpointer data)
+{
+    gint64 end;
+
+    XFlush(display);
+    end = g_get_monotonic_time() + TIMEOUT * G_USEC_PER_SEC;
+    while (g_get_monotonic_time() < end) {
+        XEvent e;
+        fd_set fds;
+        struct timeval tv;
+
+        while (XPending(display)) {
+            XNextEvent(display, &e);
+            if (match(&e, data))
+                return TRUE;
+        }
+
+        FD_ZERO(&fds);
+        FD_SET(ConnectionNumber(display), &fds);
+        tv.tv_sec = 0;
+        tv.tv_usec = 100000;
+        select(ConnectionNumber(display) + 1, &fds, NULL, NULL, &tv);
+    }
+    fail("Openbox did not answer, is it running?");
+    return FALSE;
+}
+
+static gboolean match_property(const XEvent *e, gpointer data)
+{
+    return (e->type == PropertyNotify &&
+            e->xproperty.atom == GPOINTER_TO_UINT(data) &&
+            e->xproperty.state == PropertyNewValue);
+}
+
+static gboolean match_map(const XEvent *e, gpointer data)
+{
+    return (e->type == MapNotify &&
+            e->xmap.window == GPOINTER_TO_UINT(data));
+}
+
+static gboolean match_frame_extents(const XEvent *e, gpointer data)
+{
+    return (e->type == PropertyNotify &&
+            e->xproperty.window == barrier_win &&
+            e->xproperty.atom == net_frame_extents &&
+            e->xproperty.state == PropertyNewValue);
+}
+
+static void send_root_message(Window w, Atom type, glong l0, glong l1)
+{
+    XEvent ce;
+
+    memset(&ce, 0, sizeof(ce));
+    ce.xclient.type = ClientMessage;
+    ce.xclient.window = w;
+    ce.xclient.message_type = type;
+    ce.xclient.format = 32;
+    ce.xclient.data.l[0] = l0;
+    ce.xclient.data.l[1] = l1;
+    XSendEvent(display, root, FALSE,
+               SubstructureRedirectMask | SubstructureNotifyMask, &ce);
+}
+
+/*! Waits for openbox to handle everything that was sent to it so far.  This
+  asks it for the frame extents of a window, which it always answers, and
+  handles requests in the order that they arrive. */
+static gboolean barrier(void)
+{
+    XDeleteProperty(display, barrier_win, net_frame_extents);
+    send_root_message(barrier_win, net_request_frame_extents, 0, 0);
+    return wait_for(match_frame_extents, NULL);
+}
+
+static void set_title(Window w, guint n, guint serial)
+{
+    gchar *title = g_strdup_printf("loadbench window %u (%u)", n, serial);
+
+    XChangeProperty(display, w, net_wm_name, utf8_string, 8,
+                    PropModeReplace, (guchar*)title, strlen(title));
+    g_free(title);
+}
+
+static Window make_window(void)
+{
+    XSetWindowAttributes attrib;
+    XSizeHints size;
+    XWMHints hints;
+    Window w;
+    guint n = windows->len;
+
+    attrib.event_mask = StructureNotifyMask;
+    attrib.background_pixel = WhitePixel(display, DefaultScreen(display));
+    w = XCreateWindow(display, root, 0, 0, 200, 150, 0, CopyFromParent,
+                      InputOutput, CopyFromParent,
+                      CWEventMask | CWBackPixel, &attrib);
+
+    set_title(w, n, 0);
+
+    /* let openbox place it */
+    size.flags = PMinSize;
+    size.min_width = 50;
+    size.min_height = 50;
+    XSetWMNormalHints(display, w, &size);
+
+    hints.flags = InputHint;
+    hints.input = TRUE;
+    if (groups) {
+        hints.flags |= WindowGroupHint;
+        hints.window_group = g_array_index(leaders, Window, n % groups);
+    }
+    XSetWMHints(display, w, &hints);
+
+    /* spread the transients out evenly, each one for a window which was
+       made before it */
+    if (parents->len &&
+        (guint)((n + 1) * transients) > (guint)(n * transients))
+    {
+        XSetTransientForHint(display, w, g_array_index(parents, Window,
+                                                       n % parents->len));
+    }
+    else
+        g_array_append_val(parents, w);
+
+    if (struts_made < struts) {
+        glong strut[12];
+
+        /* a thin strut along the edge of the screen */
+        memset(strut, 0, sizeof(strut));
+        strut[struts_made % 4] = 1;
+        strut[4 + (struts_made % 4) * 2 + 1] =
+            (struts_made % 4 < 2 ?
+             DisplayHeight(display, DefaultScreen(display)) :
+             DisplayWidth(display, DefaultScreen(display))) - 1;
+        XChangeProperty(display, w, net_wm_strut_partial, XA_CARDINAL, 32,
+                        PropModeReplace, (guchar*)strut, 12);
+        ++struts_made;
+    }
+
+    if (icons)
+        XChangeProperty(display, w, net_wm_icon, XA_CARDINAL, 32,
+                        PropModeReplace, (guchar*)icon,
+                        2 + ICON_SIZE * ICON_SIZE);
+
+    g_array_append_val(windows, w);
+    return w;
+}
+
+static void add_time(GArray *times, gint64 start)
+{
+    gint64 t = g_get_monotonic_time() - start;
+    g_array_append_val(times, t);
+}
+
+static gint cmp_time(gconstpointer a, gconstpointer b)
+{
+    const gint64 *ta = a, *tb = b;
+    return *ta < *tb ? -1 : (*ta > *tb ? 1 : 0);
+}
+
+/*! Writes a line of results, and empties the times */
+static void result(guint count, const gchar *name, GArray *times)
+{
+    gint64 total = 0;
+    guint i;
+
+    if (!times->len) return;
+
+    g_array_sort(times, cmp_time);
+    for (i = 0; i < times->len; ++i)
+        total += g_array_index(times, gint64, i);
+
+    printf("%u,%s,%u,%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT ",%"
+           G_GINT64_FORMAT ",%" G_GINT64_FORMAT "\n",
+           count, name, times->len, total / times->len,
+           g_array_index(times, gint64, times->len / 2),
+           g_array_index(times, gint64, times->len * 9 / 10),
+           g_array_index(times, gint64, times->len - 1));
+    fflush(stdout);
+    g_array_set_size(times, 0);
+}
+
+/*! Makes windows until there are @count of them, timing each one being
+  managed */
+static gboolean grow(guint count, GArray *times)
+{
+    while (windows->len < count) {
+        Window w = make_window();
+        gint64 start = g_get_monotonic_time();
+
+        XMapWindow(display, w);
+        /* openbox maps the window after it reparents and places it */
+        if (!wait_for(match_map, GUINT_TO_POINTER(w)))
+            return FALSE;
+        add_time(times, start);
+    }
+    return TRUE;
+}
+
+/*! Reads the stacking order of the clients, bottom to top */
+static Window* get_stacking(gulong *n)
+{
+    Atom type;
+    gint format;
+    gulong left;
+    guchar *data = NULL;
+
+    if (XGetWindowProperty(display, root, net_client_list_stacking, 0,
+                           G_MAXINT32 / 4, FALSE, XA_WINDOW, &type,
+                           &format, n, &left, &data) != Success)
+    {
+        if (data) XFree(data);
+        *n = 0;
+        return NULL;
+    }
+    return (Window*)data;
+}
+
+/*! Waits until the stacking order has @w at the top, or at the bottom when
+  @top is FALSE.  Any change to the order could be left over from something
+  done before, so the new order is checked each time. */
+static gboolean wait_for_stacking(Window w, gboolean top)
+{
+    for (;;) {
+        Window *stack;
+        gulong n;
+        gboolean done;
+
+        if (!wait_for(match_property,
+                      GUINT_TO_POINTER(net_client_list_stacking)))
+            return FALSE;
+        stack = get_stacking(&n);
+        done = n && stack[top ? n-1 : 0] == w;
+        if (stack) XFree(stack);
+        if (done)
+            return TRUE;
+    }
+}
+
+static gboolean restack(GArray *raise_times, GArray *lower_times)
+{
+    guint i;
+
+    for (i = 0; i < repeat; ++i) {
+        Window *stack;
+        Window w;
+        gulong n;
+        gint64 start;
+
+        /* let openbox finish what it is doing, and drop the events from it,
+           so they aren't counted in the time for the restack */
+        if (!barrier())
+            return FALSE;
+        XSync(display, True);
+
+        stack = get_stacking(&n);
+        if (n < 2) {
+            if (stack) XFree(stack);
+            return TRUE;
+        }
+        w = stack[0];
+        XFree(stack);
+
+        /* the list is bottom to top, so raising the bottom window and then
+           lowering it again always change the order */
+        start = g_get_monotonic_time();
+        XRaiseWindow(display, w);
+        if (!wait_for_stacking(w, TRUE))
+            return FALSE;
+        add_time(raise_times, start);
+
+        start = g_get_monotonic_time();
+        XLowerWindow(display, w);
+        if (!wait_for_stacking(w, FALSE))
+            return FALSE;
+        add_time(lower_times, start);
+    }
+    return TRUE;
+}
+
+static gboolean switch_desktops(GArray *times)
+{
+    guint i;
+
+    for (i = 0; i < repeat * 2; ++i) {
+        gint64 start = g_get_monotonic_time();
+
+        /* go away from the windows, and back to them again */
+        send_root_message(root, net_current_desktop,
+                          i % 2 ? home_desktop : !home_desktop, CurrentTime);
+        if (!wait_for(match_property, GUINT_TO_POINTER(net_current_desktop)))
+            return FALSE;
+        add_time(times, start);
+    }
+    return TRUE;
+}
+
+static gboolean change_titles(GArray *times)
+{
+    static guint serial = 0;
+    guint i, j;
+
+    for (i = 0; i < repeat; ++i) {
+        gint64 start = g_get_monotonic_time();
+
+        ++serial;
+        for (j = 0; j < windows->len; ++j)
+            set_title(g_array_index(windows, Window, j), j, serial);
+        if (!barrier())
+            return FALSE;
+        add_time(times, start);
+    }
+    return TRUE;
+}
+
+static gboolean reconfigure(GArray *times)
+{
+    guint i;
+
+    for (i = 0; i < repeat; ++i) {
+        gint64 start = g_get_monotonic_time();
+
+        /* this is what openbox --reconfigure sends */
+        send_root_message(root, ob_control, 1, 0);
+        /* openbox handles requests again once it is done */
+        if (!barrier())
+            return FALSE;
+        add_time(times, start);
+    }
+    return TRUE;
+}
+
+static void make_icon(void)
+{
+    guint i;
+
+    icon = g_new(glong, 2 + ICON_SIZE * ICON_SIZE);
+    icon[0] = icon[1] = ICON_SIZE;
+    for (i = 0; i < ICON_SIZE * ICON_SIZE; ++i)
+        /* a different colour for each pixel, so it isn't simple to scale */
+        icon[2 + i] = 0xff000000 | (i * 0x010307 & 0xffffff);
+}
+
+static glong get_cardinal(Window w, Atom a)
+{
+    Atom type;
+    gint format;
+    gulong n, left;
+    guchar *data = NULL;
+    glong v = 0;
+
+    if (XGetWindowProperty(display, w, a, 0, 1, FALSE, XA_CARDINAL, &type,
+                           &format, &n, &left, &data) == Success && n == 1)
+        v = *(glong*)data;
+    if (data) XFree(data);
+    return v;
+}
+
+/*! Makes sure there is another desktop to switch to */
+static gboolean setup_desktops(void)
+{
+    home_desktop = get_cardinal(root, net_current_desktop);
+    if (get_cardinal(root, net_number_of_desktops) < 2) {
+        send_root_message(root, net_number_of_desktops, 2, 0);
+        return wait_for(match_property,
+                        GUINT_TO_POINTER(net_number_of_desktops));
+    }
+    return TRUE;
+}
+
+int main(int argc, char **argv)
+{
+    GArray *counts, *times[6];
+    gint i;
+    guint j;
+
+    counts = g_array_new(FALSE, FALSE, sizeof(guint));
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help"))
+            return fail(NULL);
+        else if (!strcmp(argv[i], "--repeat") && i + 1 < argc)
+            repeat = MAX(atoi(argv[++i]), 1);
+        else if (!strcmp(argv[i], "--transients") && i + 1 < argc)
+            transients = CLAMP(g_ascii_strtod(argv[++i], NULL), 0, 1);
+        else if (!strcmp(argv[i], "--groups") && i + 1 < argc)
+            groups = MAX(atoi(argv[++i]), 0);
+        else if (!strcmp(argv[i], "--struts") && i + 1 < argc)
+            struts = MAX(atoi(argv[++i]), 0);
+        else if (!strcmp(argv[i], "--icons"))
+            icons = TRUE;
+        else if (atoi(argv[i]) > 0) {
+            guint c = atoi(argv[i]);
+            g_array_append_val(counts, c);
+        }
+        else
+            return fail(NULL);
+    }
+    if (!counts->len) return fail(NULL);
+
+    if (!(display = XOpenDisplay(NULL)))
+        return fail("Unable to open the display");
+    root = DefaultRootWindow(display);
+
+    net_frame_extents = XInternAtom(display, "_NET_FRAME_EXTENTS", FALSE);
+    net_request_frame_extents =
+        XInternAtom(display, "_NET_REQUEST_FRAME_EXTENTS", FALSE);
+    net_client_list_stacking =
+        XInternAtom(display, "_NET_CLIENT_LIST_STACKING", FALSE);
+    net_current_desktop = XInternAtom(display, "_NET_CURRENT_DESKTOP", FALSE);
+    net_number_of_desktops =
+        XInternAtom(display, "_NET_NUMBER_OF_DESKTOPS", FALSE);
+    net_wm_name = XInternAtom(display, "_NET_WM_NAME", FALSE);
+    net_wm_icon = XInternAtom(display, "_NET_WM_ICON", FALSE);
+    net_wm_strut_partial =
+        XInternAtom(display, "_NET_WM_STRUT_PARTIAL", FALSE);
+    ob_control = XInternAtom(display, "_OB_CONTROL", FALSE);
+    utf8_string = XInternAtom(display, "UTF8_STRING", FALSE);
+
+    XSelectInput(display, root, PropertyChangeMask);
+    barrier_win = XCreateSimpleWindow(display, root, 0, 0, 1, 1, 0, 0, 0);
+    XSelectInput(display, barrier_win, PropertyChangeMask);
+
+    windows = g_array_new(FALSE, FALSE, sizeof(Window));
+    parents = g_array_new(FALSE, FALSE, sizeof(Window));
+    leaders = g_array_new(FALSE, FALSE, sizeof(Window));
+    for (j = 0; j < groups; ++j) {
+        /* group leaders are never mapped */
+        Window w = XCreateSimpleWindow(display, root, 0, 0, 1, 1, 0, 0, 0);
+        g_array_append_val(leaders, w);
+    }
+    if (icons) make_icon();
+    for (i = 0; i < 6; ++i)
+        times[i] = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+    if (!barrier() || !setup_desktops())
+        return 1;
+
+    printf("windows,measurement,samples,mean_us,median_us,p90_us,max_us\n");
+    for (j = 0; j < counts->len; ++j) {
+        guint count = g_array_index(counts, guint, j);
+
+        if (!grow(count, times[0]))
+            return 1;
+        result(count, "map", times[0]);
+
+        if (!restack(times[1], times[2]))
+            return 1;
+        result(count, "raise", times[1]);
+        result(count, "lower", times[2]);
+
+        if (!switch_desktops(times[3]))
+            return 1;
+        result(count, "desktop", times[3]);
+
+        if (!change_titles(times[4]))
+            return 1;
+        result(count, "title", times[4]);
+
+        if (!reconfigure(times[5]))
+            return 1;
+        result(count, "reconfigure", times[5]);
+    }
+
+    XCloseDisplay(display);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#!/bin/sh
+
+# Runs loadbench against a new openbox on an Xvfb server, and writes the
+# results as CSV to stdout.
+#
+# Usage: loadbench.sh [OPENBOX [OPENBOX OPTIONS]] -- [LOADBENCH OPTIONS] COUNT...
+#
+# For example:
+#   loadbench.sh ../openbox/openbox --config-file rc.xml -- --icons 10 100 1000
+#
+# The display to use can be set with LOADBENCH_DISPLAY, and is :98 by
+# default.  The screen size can be set with LOADBENCH_SCREEN.
+
+openbox=openbox
+if [ $# -gt 0 ] && [ "$1" != "--" ]; then
+    openbox="$1"
+    shift
+fi
+obargs=""
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    obargs="$obargs $1"
+    shift
+done
+[ "$1" = "--" ] && shift
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 [OPENBOX [OPENBOX OPTIONS]] -- [LOADBENCH OPTIONS] COUNT..." >&2
+    exit 1
+fi
+
+dir=$(dirname "$0")
+display="${LOADBENCH_DISPLAY:-:98}"
+screen="${LOADBENCH_SCREEN:-1920x1080}"
+
+Xvfb "$display" -screen 0 "${screen}x24" -nolisten tcp >/dev/null 2>&1 &
+xvfb=$!
+# wait for the server to be ready
+i=0
+while ! DISPLAY="$display" xprop -root >/dev/null 2>&1; do
+    i=$((i + 1))
+    if [ $i -gt 50 ]; then
+        echo "Xvfb did not start" >&2
+        kill $xvfb
+        exit 1
+    fi
+    sleep 0.1
+done
+
+DISPLAY="$display" "$openbox" --sm-disable $obargs &
+ob=$!
+# wait for openbox to be running
+i=0
+while ! DISPLAY="$display" xprop -root _NET_SUPPORTING_WM_CHECK | \
+    grep -q "window id"; do
+    i=$((i + 1))
+    if [ $i -gt 100 ]; then
+        echo "Openbox did not start" >&2
+        kill $ob $xvfb
+        exit 1
+    fi
+    sleep 0.1
+done
+
+DISPLAY="$display" "$dir/loadbench" "$@"
+result=$?
+
+DISPLAY="$display" "$openbox" --exit
+wait $ob
+kill $xvfb
+wait $xvfb 2>/dev/null
+exit $result
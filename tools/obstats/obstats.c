@@ -0,0 +1,187 @@
+#include "openbox/stats.h"
+
+#include <X11/X.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+static const gchar *event_names[LASTEvent] = {
+    "Extension events", NULL, "KeyPress", "KeyRelease", "ButtonPress",
+    "ButtonRelease", "MotionNotify", "EnterNotify", "LeaveNotify", "FocusIn",
+    "FocusOut", "KeymapNotify", "Expose", "GraphicsExpose", "NoExpose",
+    "VisibilityNotify", "CreateNotify", "DestroyNotify", "UnmapNotify",
+    "MapNotify", "MapRequest", "ReparentNotify", "ConfigureNotify",
+    "ConfigureRequest", "GravityNotify", "ResizeRequest", "CirculateNotify",
+    "CirculateRequest", "PropertyNotify", "SelectionClear",
+    "SelectionRequest", "SelectionNotify", "ColormapNotify", "ClientMessage",
+    "MappingNotify", "GenericEvent"
+};
+
+static const gchar *section_names[OB_NUM_STATS_SECTIONS] = {
+    "client_manage",
+    "client_unmanage",
+    "frame render",
+    "pipe-menu read"
+};
+
+static gint fail(const gchar *s)
+{
+    if (s)
+        fprintf(stderr, "%s\n", s);
+    else
+        fprintf
+            (stderr,
+             "Usage: obstats [OPTIONS]\n\n"
+             "Shows how long a running Openbox has taken to handle things.\n"
+             "Times are in microseconds.\n\n"
+             "Options:\n"
+             "    --help              Display this help and exit\n"
+             "    --display DISPLAY   Show the stats for the Openbox running "
+             "on this display\n"
+             "    --file FILE         Read the stats from this file\n");
+    return 1;
+}
+
+/*! The most time that the bucket holds */
+static guint64 bucket_limit(guint b)
+{
+    return G_GUINT64_CONSTANT(1) << b;
+}
+
+/*! Finds the bucket that the fraction @p of the times are in or below */
+static const gchar* percentile(const ObStatsHistogram *h, gdouble p)
+{
+    static gchar buf[3][32];
+    static guint n = 0;
+    guint64 need, sum;
+    guint b;
+    gchar *s = buf[n++ % 3];
+
+    need = (guint64)(h->count * p + 0.5);
+    if (need == 0) need = 1;
+    for (b = 0, sum = 0; b < OB_STATS_BUCKETS; ++b) {
+        sum += h->buckets[b];
+        if (sum >= need) break;
+    }
+    if (b >= OB_STATS_BUCKETS - 1)
+        g_snprintf(s, 32, ">%" G_GUINT64_FORMAT,
+                   bucket_limit(OB_STATS_BUCKETS - 2));
+    else
+        g_snprintf(s, 32, "<%" G_GUINT64_FORMAT, bucket_limit(b));
+    return s;
+}
+
+static void print_histogram(const gchar *name, const ObStatsHistogram *h)
+{
+    if (!h->count) return;
+
+    printf("  %-24s %10" G_GUINT64_FORMAT " %10" G_GUINT64_FORMAT
+           " %10" G_GUINT64_FORMAT " %9s %9s %9s\n",
+           name, h->count, h->total / h->count, h->max,
+           percentile(h, 0.5), percentile(h, 0.9), percentile(h, 0.99));
+}
+
+static void print_heading(const gchar *title)
+{
+    printf("\n%-26s %10s %10s %10s %9s %9s %9s\n",
+           title, "count", "average", "max", "50%", "90%", "99%");
+}
+
+int main(int argc, char **argv)
+{
+    gint i, fd;
+    gchar *path = NULL, *display = NULL;
+    const ObStatsFile *s;
+    gpointer map;
+    struct stat st;
+
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help"))
+            return fail(NULL);
+        else if (!strcmp(argv[i], "--display")) {
+            if (++i >= argc) return fail(NULL);
+            display = argv[i];
+        }
+        else if (!strcmp(argv[i], "--file")) {
+            if (++i >= argc) return fail(NULL);
+            path = g_strdup(argv[i]);
+        }
+        else
+            return fail(NULL);
+    }
+
+    if (!path) {
+        const gchar *cache = g_getenv("XDG_CACHE_HOME");
+        gchar *name, *c;
+
+        if (!display) display = (gchar*)g_getenv("DISPLAY");
+        if (!display) return fail("Unable to find the X display");
+
+        name = g_strconcat(OB_STATS_FILE_PREFIX, display, NULL);
+        for (c = name; *c; ++c)
+            if (*c == '/') *c = '_';
+        if (cache && cache[0] == '/')
+            path = g_build_filename(cache, "openbox", name, NULL);
+        else
+            path = g_build_filename(g_get_home_dir(), ".cache", "openbox",
+                                    name, NULL);
+        g_free(name);
+    }
+
+    if ((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "Unable to open %s, is Openbox running?\n", path);
+        return 1;
+    }
+    if ((gsize)st.st_size < sizeof(ObStatsFile))
+        return fail("The stats file is too small");
+    map = mmap(NULL, sizeof(ObStatsFile), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return fail("Unable to read the stats file");
+    s = map;
+
+    if (s->magic != OB_STATS_MAGIC || s->version != OB_STATS_VERSION)
+        return fail("The stats file is from a different version of Openbox");
+
+    printf("Openbox process %" G_GUINT64_FORMAT ", running for %"
+           G_GUINT64_FORMAT " seconds\n", s->pid,
+           (guint64)(g_get_real_time() - s->start_time) / G_USEC_PER_SEC);
+    printf("Frame renders: %" G_GUINT64_FORMAT "\n", s->renders);
+    printf("X requests:    %" G_GUINT64_FORMAT "\n", s->requests);
+    printf("Round trips:   %" G_GUINT64_FORMAT "\n", s->round_trips);
+
+    print_heading("Sections");
+    for (i = 0; i < OB_NUM_STATS_SECTIONS; ++i)
+        print_histogram(section_names[i], &s->sections[i]);
+
+    print_heading("X events");
+    for (i = 0; i < OB_STATS_EVENTS; ++i) {
+        gchar num[32];
+        const gchar *name = i < LASTEvent ? event_names[i] : NULL;
+
+        if (!name) {
+            g_snprintf(num, sizeof(num), "Event %d", i);
+            name = num;
+        }
+        print_histogram(name, &s->events[i]);
+    }
+
+    print_heading("Actions");
+    for (i = 0; i < (gint)MIN(s->num_actions, OB_STATS_ACTIONS); ++i) {
+        gchar name[OB_STATS_NAME_LENGTH + 1];
+
+        /* it may be changing while we read it */
+        memcpy(name, s->action_names[i], OB_STATS_NAME_LENGTH);
+        name[OB_STATS_NAME_LENGTH] = '\0';
+        print_histogram(name, &s->actions[i]);
+    }
+
+    munmap(map, sizeof(ObStatsFile));
+    g_free(path);
+    return 0;
+}